@@ -0,0 +1,222 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+/*
+    Measures the throughput of loot::clp::schema::parse_batch for an increasing number of
+    threads. Every command line is validated against the same schema of a few dozen
+    options, which is the typical job-submission workload.
+
+    Usage: loot-clp-bench batch [--lines n] [--max-threads n] [--repeat n]
+*/
+
+#include "bench.h"
+
+#include <clp/parser.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace loot::clp;
+
+namespace bench {
+
+namespace {
+
+/*!
+    Owns the strings of the generated command lines, the argv arrays point into it.
+*/
+struct workload
+{
+    std::vector<std::string>         storage;
+    std::vector<std::vector<char*>>  argvs;
+    std::vector<command_line>        lines;
+};
+
+void
+make_options(parser& p, unsigned int count)
+{
+    for (unsigned int c = 0; c < count; c++) {
+        std::ostringstream name;
+        name << "option-" << c;
+        p.add_option(option(
+                "",
+                name.str(),
+                0 == c ? option_type_e mandatory_option : option_type_e optional_option,
+                0 == c % 2 ? value_constraint_e exact_num_values
+                           : value_constraint_e unlimited_num_values,
+                1,
+                ""));
+    }
+}
+
+void
+make_workload(workload& w, unsigned int num_lines, unsigned int num_options)
+{
+    // Every line uses a handful of options with a few values each.
+    const unsigned int per_line = 8;
+
+    w.storage.reserve(num_lines * per_line * 4 + 1);
+    w.storage.push_back("job");
+    std::size_t first_line_arg = w.storage.size();
+
+    for (unsigned int l = 0; l < num_lines; l++) {
+        for (unsigned int o = 0; o < per_line; o++) {
+            unsigned int opt = (l * 7 + o * 13) % num_options;
+            if (0 == o) {
+                opt = 0; // The mandatory one.
+            }
+
+            std::ostringstream name;
+            name << "--option-" << opt;
+            w.storage.push_back(name.str());
+            w.storage.push_back("value-a");
+            if (0 != opt % 2) {
+                w.storage.push_back("value-b");
+                w.storage.push_back("value-c");
+            }
+        }
+        w.storage.push_back("");
+    }
+
+    // The strings don't move anymore; Build argv arrays, one per line.
+    std::vector<char*> argv(1, &w.storage[0][0]);
+    for (std::size_t c = first_line_arg; c < w.storage.size(); c++) {
+        if (w.storage[c].empty()) {
+            argv.push_back(0);
+            w.argvs.push_back(argv);
+            argv.resize(1);
+        }
+        else {
+            argv.push_back(&w.storage[c][0]);
+        }
+    }
+
+    for (std::size_t c = 0; c < w.argvs.size(); c++) {
+        command_line line = {static_cast<int>(w.argvs[c].size() - 1), &w.argvs[c][0]};
+        w.lines.push_back(line);
+    }
+}
+
+double
+run(const schema& s, const workload& w, unsigned int threads, unsigned int repeat)
+{
+    double best = 0;
+    for (unsigned int r = 0; r < repeat; r++) {
+        bench_clock::time_point start = bench_clock::now();
+        std::vector<result> results = s.parse_batch(w.lines, threads);
+        std::chrono::duration<double> elapsed = bench_clock::now() - start;
+
+        if (results.size() != w.lines.size() || !results.front().good()) {
+            std::cerr << "unexpected parse result" << std::endl;
+            std::exit(1);
+        }
+
+        best = std::max(best, w.lines.size() / elapsed.count());
+    }
+    return best;
+}
+
+} // namespace
+
+int
+run_batch(int argc, char* argv[])
+{
+    parser args = {
+            option("l",
+                   "lines",
+                   option_type_e optional_option,
+                   value_constraint_e exact_num_values,
+                   1,
+                   "Number of command lines per batch (default 200000)"),
+            option("t",
+                   "max-threads",
+                   option_type_e optional_option,
+                   value_constraint_e exact_num_values,
+                   1,
+                   "Highest number of threads to measure (default: all cores)"),
+            option("r",
+                   "repeat",
+                   option_type_e optional_option,
+                   value_constraint_e exact_num_values,
+                   1,
+                   "Repetitions per measurement, the best one counts (default 3)"),
+            option("h",
+                   "help",
+                   option_type_e help_option,
+                   value_constraint_e no_values,
+                   0,
+                   "Print this help")};
+
+    result r = args.parse(argc, argv);
+    if (!r.good() || r.has_option("help")) {
+        args.print_help(std::cout, false);
+        return r.good() ? 0 : 1;
+    }
+
+    unsigned int hardware    = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int num_lines   = numeric_value(r, "lines", 200000);
+    unsigned int max_threads = numeric_value(r, "max-threads", hardware);
+    unsigned int repeat      = numeric_value(r, "repeat", 3);
+
+    parser p;
+    make_options(p, 48);
+    std::shared_ptr<const schema> s = p.freeze();
+
+    workload w;
+    make_workload(w, num_lines, 48);
+
+    std::cout << "parse_batch: " << w.lines.size() << " command lines, "
+              << s->size() << " options, " << hardware << " hardware threads" << std::endl;
+    std::printf("%8s %16s %10s\n", "threads", "lines/s", "speedup");
+
+    double single = 0;
+    unsigned int t = 1;
+    while (t <= max_threads) {
+        double rate = run(*s, w, t, repeat);
+        if (1 == t) {
+            single = rate;
+        }
+        std::printf("%8u %16.0f %10.2f\n", t, rate, rate / single);
+
+        // Double the threads, but always measure the highest count even if it's not a
+        // power of two.
+        t = t < max_threads && t * 2 > max_threads ? max_threads : t * 2;
+    }
+
+    return 0;
+}
+
+} // namespace bench
@@ -0,0 +1,112 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+/*
+    Shared by the parts of loot-clp-bench.
+*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <clp/result.h>
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace bench {
+
+typedef std::chrono::steady_clock bench_clock;
+
+/*!
+    @return
+    Returns the number of calls to `operator new` since the program started.
+*/
+std::size_t allocations();
+
+/*!
+    @return
+    Returns the peak resident set size of the process in KiB or zero (`0`) if the
+    platform doesn't tell.
+*/
+std::size_t peak_rss_kib();
+
+/*!
+    Reads the first value of an option as a number.
+
+    @param[in] r
+    The parsed command line of the benchmark.
+
+    @param[in] name
+    Name of the option.
+
+    @param[in] fallback
+    Returned if the option has no value.
+
+    @return
+    Returns the value or `fallback`.
+*/
+unsigned long numeric_value(const loot::clp::result& r,
+                            const std::string&       name,
+                            unsigned long            fallback);
+
+/*!
+    Measures the throughput of `parse_batch` for an increasing number of threads.
+*/
+int run_batch(int argc, char* argv[]);
+
+/*!
+    Measures the latency of shell completion.
+*/
+int run_complete(int argc, char* argv[]);
+
+/*!
+    Measures the throughput of converting long lists of integers.
+*/
+int run_lists(int argc, char* argv[]);
+
+/*!
+    Measures the cost of reading snapshots while they are replaced.
+*/
+int run_snapshot(int argc, char* argv[]);
+
+/*!
+    Measures the latency of suggestions for misspelled options.
+*/
+int run_suggest(int argc, char* argv[]);
+
+/*!
+    Measures how the single-threaded operations scale with the size of the command
+    line, the number of options and the number of values.
+*/
+int run_scaling(int argc, char* argv[]);
+
+} // namespace bench
+
+#endif // BENCH_H
@@ -0,0 +1,146 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+/*
+    Measures the latency of completing a partial command line with loot::clp::completer,
+    for schemas with more and more options named like --group-17-option-42. Requests
+    complete a switch ("--group-3-o", many candidates), a nearly complete name (one
+    candidate) and the value of an enum option, after a few finished words. Building the
+    index is reported separately, a completion daemon pays it once.
+
+    Usage: loot-clp-bench complete [--options n] [--min-time ms]
+*/
+
+#include "bench.h"
+
+#include <clp/completer.h>
+#include <clp/convert.h>
+#include <clp/parser.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace loot::clp;
+
+namespace bench {
+
+int
+run_complete(int argc, char* argv[])
+{
+    parser args = {
+            option("o",
+                   "options",
+                   option_type_e optional_option,
+                   value_constraint_e exact_num_values,
+                   1,
+                   "Largest number of options (default 10000)"),
+            option("t",
+                   "min-time",
+                   option_type_e optional_option,
+                   value_constraint_e exact_num_values,
+                   1,
+                   "Milliseconds to repeat every measurement at least (default 200)"),
+            option("h",
+                   "help",
+                   option_type_e help_option,
+                   value_constraint_e no_values,
+                   0,
+                   "Print this help")};
+
+    result r = args.parse(argc, argv);
+    if (!r.good() || r.has_option("help")) {
+        args.print_help(std::cout, false);
+        return r.good() ? 0 : 1;
+    }
+
+    std::size_t max_options = numeric_value(r, "options", 10000);
+    double      min_time    = numeric_value(r, "min-time", 200) / 1000.0;
+
+    std::printf("%8s %12s %12s %12s %12s %8s\n",
+                "options", "build us", "switch us", "name us", "value us", "allocs");
+    for (std::size_t num = 100; num <= max_options; num *= 10) {
+        parser p;
+        for (std::size_t o = 0; o < num; o++) {
+            option opt("",
+                       "group-" + std::to_string(static_cast<unsigned long>(o % 100))
+                       + "-option-" + std::to_string(static_cast<unsigned long>(o / 100)),
+                       option_type_e optional_option,
+                       value_constraint_e exact_num_values,
+                       1,
+                       "Option number " + std::to_string(static_cast<unsigned long>(o)));
+            if (0 == o) {
+                opt = enum_option(opt, {{"fast", 1}, {"faster", 2}, {"fastest", 3}});
+            }
+            p.add_option(opt);
+        }
+        std::shared_ptr<const schema> frozen = p.freeze();
+
+        bench_clock::time_point start = bench_clock::now();
+        completer               c(frozen);
+        double                  build = std::chrono::duration<double, std::micro>(
+                bench_clock::now() - start).count();
+
+        std::vector<arg_view>              words = {"input.txt", "--group-1-option-0",
+                                                    "value", ""};
+        std::vector<completer::candidate>  candidates;
+        const char*                        last[] = {"--group-3-o", "--group-42-option-9",
+                                                     "fa"};
+        double                             latency[3];
+        std::size_t                        allocs = 0;
+        for (std::size_t l = 0; l < 3; l++) {
+            words[3] = last[l];
+            if (2 == l) {
+                words[2] = "--group-0-option-0";
+            }
+
+            std::size_t calls  = 0;
+            std::size_t before = allocations();
+            std::chrono::duration<double, std::micro> elapsed;
+            start = bench_clock::now();
+            do {
+                c.complete(arg_span(words.data(), words.size()), candidates);
+                calls++;
+                elapsed = bench_clock::now() - start;
+            } while (elapsed.count() < min_time * 1e6);
+
+            latency[l] = elapsed.count() / calls;
+            allocs     = std::max(allocs, (allocations() - before) / calls);
+        }
+
+        std::printf("%8lu %12.1f %12.2f %12.2f %12.2f %8lu\n",
+                    static_cast<unsigned long>(num), build, latency[0], latency[1],
+                    latency[2], static_cast<unsigned long>(allocs));
+    }
+    return 0;
+}
+
+} // namespace bench
@@ -0,0 +1,211 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+/*
+    Measures the throughput of converting one value holding a long list of integers, as
+    in --ids 17,42,99,... The list is converted by
+
+    - strtoll: splitting a copy of the value by hand, the way to do it without lists
+    - vector: loot::clp::convert_integer_list appending to a std::vector
+    - buffer: loot::clp::convert_integer_list into a buffer of the caller
+    - parse: parsing a command line with a loot::clp::list_option
+
+    Throughput is reported in GB/s of list text, together with the time per integer.
+
+    Usage: loot-clp-bench lists [--count n] [--digits n] [--min-time ms]
+*/
+
+#include "bench.h"
+
+#include <clp/convert.h>
+#include <clp/parser.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace loot::clp;
+
+namespace bench {
+
+namespace {
+
+/*!
+    Calls `op` until `min_time` seconds have passed.
+
+    @return
+    Returns the time per call in nanoseconds.
+*/
+template<typename Op>
+double
+measure(Op op, double min_time)
+{
+    std::size_t calls = 0;
+
+    bench_clock::time_point       start = bench_clock::now();
+    std::chrono::duration<double> elapsed;
+    do {
+        op();
+        calls++;
+        elapsed = bench_clock::now() - start;
+    } while (elapsed.count() < min_time);
+
+    return elapsed.count() * 1e9 / calls;
+}
+
+void
+report(const char* method, double ns, std::size_t bytes, std::size_t count, bool ok)
+{
+    std::printf("%-10s %10.2f GB/s %10.2f ns/int %s\n",
+                method, bytes / ns, ns / count, ok ? "" : "  (wrong result)");
+}
+
+} // namespace
+
+int
+run_lists(int argc, char* argv[])
+{
+    parser args = {
+            option("c",
+                   "count",
+                   option_type_e optional_option,
+                   value_constraint_e exact_num_values,
+                   1,
+                   "Number of integers in the list (default 1000000)"),
+            option("d",
+                   "digits",
+                   option_type_e optional_option,
+                   value_constraint_e exact_num_values,
+                   1,
+                   "Largest number of digits of an integer (default 9)"),
+            option("t",
+                   "min-time",
+                   option_type_e optional_option,
+                   value_constraint_e exact_num_values,
+                   1,
+                   "Milliseconds to repeat every measurement at least (default 500)"),
+            option("h",
+                   "help",
+                   option_type_e help_option,
+                   value_constraint_e no_values,
+                   0,
+                   "Print this help")};
+
+    result r = args.parse(argc, argv);
+    if (!r.good() || r.has_option("help")) {
+        args.print_help(std::cout, false);
+        return r.good() ? 0 : 1;
+    }
+
+    std::size_t   count    = numeric_value(r, "count", 1000000);
+    unsigned long digits   = numeric_value(r, "digits", 9);
+    double        min_time = numeric_value(r, "min-time", 500) / 1000.0;
+    if (0 == count || 0 == digits || digits > 18) {
+        std::cerr << "--count must be positive and --digits within 1 and 18" << std::endl;
+        return 1;
+    }
+
+    // Integers of uniformly distributed lengths, some negative.
+    std::mt19937_64                           random(42);
+    std::uniform_int_distribution<unsigned>   length(1, static_cast<unsigned>(digits));
+    std::vector<std::int64_t>                 expected;
+    std::string                               list;
+    for (std::size_t c = 0; c < count; c++) {
+        std::int64_t limit = 1;
+        for (unsigned d = length(random); d > 0; d--) {
+            limit *= 10;
+        }
+        std::int64_t value = static_cast<std::int64_t>(random() % limit);
+        value = 1 == c % 8 ? -value : value;
+        expected.push_back(value);
+        list += (0 == c ? "" : ",") + std::to_string(static_cast<long long>(value));
+    }
+
+    std::printf("%lu integers of up to %lu digits, %lu bytes\n\n",
+                static_cast<unsigned long>(count), digits,
+                static_cast<unsigned long>(list.size()));
+
+    std::vector<std::int64_t> values;
+    requirement_error         reason;
+    double ns = measure([&]() {
+        // What has to be done with a copy of the value from values_from_option.
+        std::string copy = list;
+        values.clear();
+        const char* pos = copy.c_str();
+        for (;;) {
+            char* end;
+            values.push_back(std::strtoll(pos, &end, 10));
+            if (',' != *end) {
+                break;
+            }
+            pos = end + 1;
+        }
+    }, min_time);
+    report("strtoll", ns, list.size(), count, values == expected);
+
+    ns = measure([&]() {
+        values.clear();
+        convert_integer_list(list.c_str(), ',', values, reason);
+    }, min_time);
+    report("vector", ns, list.size(), count, values == expected);
+
+    std::vector<std::int64_t> buffer(count);
+    std::size_t               converted = 0;
+    ns = measure([&]() {
+        convert_integer_list(list.c_str(), ',', buffer.data(), buffer.size(), converted,
+                             reason);
+    }, min_time);
+    report("buffer", ns, list.size(), count, converted == count && buffer == expected);
+
+    parser p;
+    option_handle ids = p.add_option(list_option(option(
+            "",
+            "ids",
+            option_type_e mandatory_option,
+            value_constraint_e exact_num_values,
+            1,
+            "")));
+    char* line[] = {const_cast<char*>("app"), const_cast<char*>("--ids"), &list[0], 0};
+    std::shared_ptr<const schema> frozen = p.freeze();
+    arena                         storage;
+    bool                          ok = true;
+    ns = measure([&]() {
+        storage.reset();
+        result parsed = frozen->parse(3, line, storage);
+        value_span<std::int64_t> span = parsed.values_as<std::int64_t>(ids);
+        ok = ok && span.size() == count && span[count - 1] == expected[count - 1];
+    }, min_time);
+    report("parse", ns, list.size(), count, ok);
+    return 0;
+}
+
+} // namespace bench
@@ -0,0 +1,162 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+/*
+    Benchmarks of loot::clp. The first argument selects what to measure:
+
+    loot-clp-bench scaling [options]   Cost of the operations of the parser depending on
+                                       argc, the number of options and values (default)
+    loot-clp-bench batch [options]     Throughput of parse_batch with more and more threads
+    loot-clp-bench lists [options]     Throughput of converting lists of integers
+    loot-clp-bench complete [options]  Latency of shell completion
+    loot-clp-bench suggest [options]   Latency of suggestions for misspelled options
+    loot-clp-bench snapshot [options]  Cost of reading snapshots while they are replaced
+
+    Each accepts --help for its options.
+*/
+
+#include "bench.h"
+
+#include <clp/arg_view.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include "../../include/config.h"
+
+#ifdef HAVE_SYS_RESOURCE_H
+    #include <sys/resource.h>
+#endif
+
+namespace {
+
+std::atomic<std::size_t> num_allocations(0);
+
+} // namespace
+
+// Count every allocation of the process, including those made by the library.
+void*
+operator new(std::size_t size)
+{
+    num_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = std::malloc(0 == size ? 1 : size);
+    if (0 == ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void*
+operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void
+operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+namespace bench {
+
+std::size_t
+allocations()
+{
+    return num_allocations.load(std::memory_order_relaxed);
+}
+
+std::size_t
+peak_rss_kib()
+{
+#ifdef HAVE_SYS_RESOURCE_H
+    struct rusage usage;
+    if (0 == getrusage(RUSAGE_SELF, &usage)) {
+        // Linux reports KiB, macOS bytes.
+    #ifdef __APPLE__
+        return usage.ru_maxrss / 1024;
+    #else
+        return usage.ru_maxrss;
+    #endif
+    }
+#endif
+    return 0;
+}
+
+unsigned long
+numeric_value(const loot::clp::result& r, const std::string& name, unsigned long fallback)
+{
+    loot::clp::arg_span values = r.view_from_option(name);
+    return values.empty() ? fallback : std::strtoul(values[0].str().c_str(), 0, 10);
+}
+
+} // namespace bench
+
+int
+main(int argc, char* argv[])
+{
+#ifndef NDEBUG
+    std::cerr << "warning: built without NDEBUG, configure with CMAKE_BUILD_TYPE=Release "
+              << "for representative numbers" << std::endl;
+#endif
+
+    // Hand the remaining arguments to the selected benchmark, with the benchmark in the
+    // place of the application name.
+    std::string mode = argc > 1 ? argv[1] : "scaling";
+    if ("batch" == mode) {
+        return bench::run_batch(argc - 1, argv + 1);
+    }
+    if ("complete" == mode) {
+        return bench::run_complete(argc - 1, argv + 1);
+    }
+    if ("lists" == mode) {
+        return bench::run_lists(argc - 1, argv + 1);
+    }
+    if ("snapshot" == mode) {
+        return bench::run_snapshot(argc - 1, argv + 1);
+    }
+    if ("suggest" == mode) {
+        return bench::run_suggest(argc - 1, argv + 1);
+    }
+    if ("scaling" == mode) {
+        return bench::run_scaling(argc > 1 ? argc - 1 : argc, argc > 1 ? argv + 1 : argv);
+    }
+
+    std::cerr << "usage: " << argv[0]
+              << " [scaling|batch|lists|complete|suggest|snapshot] [--help]" << std::endl;
+    return 1;
+}
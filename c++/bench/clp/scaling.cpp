@@ -0,0 +1,362 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+/*
+    Measures how the operations of loot::clp::parser scale. Three sweeps, each growing
+    one dimension tenfold per step while the others stay fixed:
+
+    - argc: command lines of 10 up to --max-args arguments against 16 options
+    - options: parsers of 1 up to --max-options options and a command line of 1000
+      arguments
+    - values: one option with 1 up to --max-values values
+
+    For every step the time per call (ns/op), the allocations per call and the peak
+    resident set size of the process so far are reported. Costs that grow faster than
+    the dimension show up as a growing ns/op column where it should stay flat (per
+    argument, per option) or grow linearly.
+
+    Usage: loot-clp-bench scaling [--max-args n] [--max-options n] [--max-values n]
+                                  [--min-time ms]
+*/
+
+#include "bench.h"
+
+#include <clp/parser.h>
+
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace loot::clp;
+
+namespace bench {
+
+namespace {
+
+/*!
+    Outcome of `measure`.
+*/
+struct measurement
+{
+    double ns;
+    double allocs;
+};
+
+/*!
+    Calls `op` until `min_time` seconds have passed.
+
+    @return
+    Returns the time and the number of allocations per call.
+*/
+template<typename Op>
+measurement
+measure(Op op, double min_time)
+{
+    std::size_t before = allocations();
+    std::size_t calls  = 0;
+
+    bench_clock::time_point       start = bench_clock::now();
+    std::chrono::duration<double> elapsed;
+    do {
+        op();
+        calls++;
+        elapsed = bench_clock::now() - start;
+    } while (elapsed.count() < min_time);
+
+    measurement m;
+    m.ns     = elapsed.count() * 1e9 / calls;
+    m.allocs = static_cast<double>(allocations() - before) / calls;
+    return m;
+}
+
+/*!
+    A generated command line. The argv array points into the strings.
+*/
+struct command
+{
+    std::vector<std::string> storage;
+    std::vector<char*>       argv;
+
+    void add(const std::string& arg)
+    {
+        storage.push_back(arg);
+    }
+
+    /*!
+        Builds `argv`, after this no more arguments may be added.
+    */
+    void seal()
+    {
+        argv.clear();
+        for (std::size_t c = 0; c < storage.size(); c++) {
+            argv.push_back(&storage[c][0]);
+        }
+        argv.push_back(0);
+    }
+
+    int argc() const
+    {
+        return static_cast<int>(storage.size());
+    }
+};
+
+std::string
+option_name(unsigned long ordinal)
+{
+    std::ostringstream name;
+    name << "option-" << ordinal;
+    return name.str();
+}
+
+/*!
+    Every second option expects exactly one value, the others any number of values.
+*/
+std::vector<option>
+make_options(unsigned long count)
+{
+    std::vector<option> options;
+    options.reserve(count);
+    for (unsigned long c = 0; c < count; c++) {
+        options.push_back(option(
+                "",
+                option_name(c),
+                option_type_e optional_option,
+                0 == c % 2 ? value_constraint_e exact_num_values
+                           : value_constraint_e unlimited_num_values,
+                1,
+                "An option of the benchmark"));
+    }
+    return options;
+}
+
+/*!
+    A command line of `argc` arguments made of option switches, each followed by one
+    value, cycling through `num_options` options.
+*/
+void
+make_command(command& cmd, unsigned long argc, unsigned long num_options)
+{
+    cmd.add("app");
+    for (unsigned long c = 0; cmd.storage.size() < argc; c++) {
+        cmd.add("--" + option_name(c % num_options));
+        if (cmd.storage.size() < argc) {
+            cmd.add("value");
+        }
+    }
+    cmd.seal();
+}
+
+void
+print_row(const char* label, unsigned long size, const measurement& m, double per)
+{
+    std::printf("%-20s %10lu %14.1f %14.2f %12.2f %12lu\n",
+                label, size, m.ns, m.ns / per, m.allocs,
+                static_cast<unsigned long>(peak_rss_kib()));
+}
+
+void
+print_header(const char* sweep, const char* per)
+{
+    std::printf("\n%-20s %10s %14s %14s %12s %12s\n",
+                sweep, "size", "ns/op", per, "allocs/op", "peak RSS KiB");
+}
+
+void
+sweep_argc(unsigned long max_args, double min_time)
+{
+    parser p;
+    std::vector<option> options = make_options(16);
+    for (std::size_t o = 0; o < options.size(); o++) {
+        p.add_option(options[o]);
+    }
+    std::shared_ptr<const schema> s = p.freeze();
+
+    print_header("argc", "ns/arg");
+    for (unsigned long argc = 10; argc <= max_args; argc *= 10) {
+        command cmd;
+        make_command(cmd, argc, options.size());
+
+        measurement m = measure([&]() {
+            p.parse(cmd.argc(), &cmd.argv[0]);
+        }, min_time);
+        print_row("parse", argc, m, argc);
+
+        result r = s->parse(cmd.argc(), &cmd.argv[0]);
+        m = measure([&]() {
+            r.has_option("option-7");
+        }, min_time);
+        print_row("has_option", argc, m, 1);
+
+        m = measure([&]() {
+            r.values_from_option("option-1");
+        }, min_time);
+        print_row("values_from_option", argc, m, 1);
+    }
+}
+
+void
+sweep_options(unsigned long max_options, double min_time)
+{
+    print_header("options", "ns/option");
+    for (unsigned long count = 1; count <= max_options; count *= 10) {
+        std::vector<option> options = make_options(count);
+
+        measurement m = measure([&]() {
+            parser p;
+            for (std::size_t o = 0; o < options.size(); o++) {
+                p.add_option(options[o]);
+            }
+        }, min_time);
+        print_row("add_option (all)", count, m, count);
+
+        parser p;
+        for (std::size_t o = 0; o < options.size(); o++) {
+            p.add_option(options[o]);
+        }
+        p.freeze();
+
+        command cmd;
+        make_command(cmd, 1000, count);
+        m = measure([&]() {
+            p.parse(cmd.argc(), &cmd.argv[0]);
+        }, min_time);
+        print_row("parse", count, m, count);
+
+        std::string last = option_name(count - 1);
+        m = measure([&]() {
+            p.has_option(last);
+        }, min_time);
+        print_row("has_option", count, m, count);
+
+        m = measure([&]() {
+            p.values_from_option(last);
+        }, min_time);
+        print_row("values_from_option", count, m, count);
+
+        std::ostringstream out;
+        m = measure([&]() {
+            out.str(std::string());
+            p.print_help(out, false);
+        }, min_time);
+        print_row("print_help", count, m, count);
+    }
+}
+
+void
+sweep_values(unsigned long max_values, double min_time)
+{
+    parser p;
+    p.add_option(option("v",
+                        "values",
+                        option_type_e mandatory_option,
+                        value_constraint_e unlimited_num_values,
+                        0,
+                        "Takes all values"));
+    p.freeze();
+
+    print_header("values", "ns/value");
+    for (unsigned long count = 1; count <= max_values; count *= 10) {
+        command cmd;
+        cmd.add("app");
+        cmd.add("--values");
+        for (unsigned long v = 0; v < count; v++) {
+            cmd.add("value");
+        }
+        cmd.seal();
+
+        measurement m = measure([&]() {
+            p.parse(cmd.argc(), &cmd.argv[0]);
+        }, min_time);
+        print_row("parse", count, m, count);
+
+        m = measure([&]() {
+            p.values_from_option("values");
+        }, min_time);
+        print_row("values_from_option", count, m, count);
+
+        m = measure([&]() {
+            p.view_from_option("values");
+        }, min_time);
+        print_row("view_from_option", count, m, count);
+    }
+}
+
+} // namespace
+
+int
+run_scaling(int argc, char* argv[])
+{
+    parser args = {
+            option("a",
+                   "max-args",
+                   option_type_e optional_option,
+                   value_constraint_e exact_num_values,
+                   1,
+                   "Largest command line to parse (default 1000000)"),
+            option("o",
+                   "max-options",
+                   option_type_e optional_option,
+                   value_constraint_e exact_num_values,
+                   1,
+                   "Largest number of options (default 10000)"),
+            option("v",
+                   "max-values",
+                   option_type_e optional_option,
+                   value_constraint_e exact_num_values,
+                   1,
+                   "Largest number of values of one option (default 100000)"),
+            option("t",
+                   "min-time",
+                   option_type_e optional_option,
+                   value_constraint_e exact_num_values,
+                   1,
+                   "Milliseconds to repeat every measurement at least (default 200)"),
+            option("h",
+                   "help",
+                   option_type_e help_option,
+                   value_constraint_e no_values,
+                   0,
+                   "Print this help")};
+
+    result r = args.parse(argc, argv);
+    if (!r.good() || r.has_option("help")) {
+        args.print_help(std::cout, false);
+        return r.good() ? 0 : 1;
+    }
+
+    double min_time = numeric_value(r, "min-time", 200) / 1000.0;
+    sweep_argc(numeric_value(r, "max-args", 1000000), min_time);
+    sweep_options(numeric_value(r, "max-options", 10000), min_time);
+    sweep_values(numeric_value(r, "max-values", 100000), min_time);
+    return 0;
+}
+
+} // namespace bench
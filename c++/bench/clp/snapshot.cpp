@@ -0,0 +1,188 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+/*
+    Measures the cost of reading the current configuration while it is replaced at
+    runtime. Reader threads look up an option in the current snapshot over and over, a
+    writer publishes a new snapshot every millisecond. Compared are
+
+    - publisher: loot::clp::snapshot_publisher::read()
+    - mutex: a std::shared_ptr guarded by a std::mutex, the stop-the-world way
+    - atomic_load: std::atomic_load of a std::shared_ptr
+
+    Usage: loot-clp-bench snapshot [--threads n] [--min-time ms]
+*/
+
+#include "bench.h"
+
+#include <clp/convert.h>
+#include <clp/parser.h>
+#include <clp/snapshot.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace loot::clp;
+
+namespace bench {
+
+namespace {
+
+/*!
+    Runs `read` on `num_threads` threads while `publish` is called every millisecond.
+
+    @return
+    Returns the time per read in nanoseconds, per thread.
+*/
+template<typename Read, typename Publish>
+double
+measure(unsigned int num_threads, double min_time, Read read, Publish publish)
+{
+    std::atomic<bool>        stop(false);
+    std::atomic<std::size_t> reads(0);
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < num_threads; t++) {
+        threads.push_back(std::thread([&]() {
+            std::size_t count = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                read();
+                count++;
+            }
+            reads += count;
+        }));
+    }
+
+    bench_clock::time_point       start = bench_clock::now();
+    std::chrono::duration<double> elapsed;
+    for (int n = 0; elapsed.count() < min_time; n++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        publish(n);
+        elapsed = bench_clock::now() - start;
+    }
+    stop = true;
+    for (std::size_t t = 0; t < threads.size(); t++) {
+        threads[t].join();
+    }
+
+    return elapsed.count() * 1e9 * num_threads / std::max<std::size_t>(1, reads.load());
+}
+
+} // namespace
+
+int
+run_snapshot(int argc, char* argv[])
+{
+    parser args = {
+            option("n",
+                   "threads",
+                   option_type_e optional_option,
+                   value_constraint_e exact_num_values,
+                   1,
+                   "Number of reader threads (default: all cores)"),
+            option("t",
+                   "min-time",
+                   option_type_e optional_option,
+                   value_constraint_e exact_num_values,
+                   1,
+                   "Milliseconds to run every measurement (default 500)"),
+            option("h",
+                   "help",
+                   option_type_e help_option,
+                   value_constraint_e no_values,
+                   0,
+                   "Print this help")};
+
+    result r = args.parse(argc, argv);
+    if (!r.good() || r.has_option("help")) {
+        args.print_help(std::cout, false);
+        return r.good() ? 0 : 1;
+    }
+
+    unsigned int num_threads = static_cast<unsigned int>(numeric_value(
+            r, "threads", std::max(1u, std::thread::hardware_concurrency())));
+    double       min_time    = numeric_value(r, "min-time", 500) / 1000.0;
+
+    parser p;
+    option_handle port = p.add_option(typed_option<std::int64_t>(option(
+            "p",
+            "port",
+            option_type_e mandatory_option,
+            value_constraint_e exact_num_values,
+            1,
+            "")));
+    std::shared_ptr<const schema> frozen = p.freeze();
+
+    auto make = [&frozen](int n) {
+        return snapshot::create(frozen, {"app", "--port",
+                                         std::to_string(static_cast<long long>(n))});
+    };
+    std::atomic<std::int64_t> sink(0);
+
+    snapshot_publisher publisher(make(0));
+    double ns_publisher = measure(num_threads, min_time, [&]() {
+        snapshot_publisher::guard g = publisher.read();
+        sink.store(g->parsed().values_as<std::int64_t>(port)[0], std::memory_order_relaxed);
+    }, [&](int n) {
+        publisher.publish(make(n));
+    });
+
+    std::mutex                      lock;
+    std::shared_ptr<const snapshot> locked = make(0);
+    double ns_mutex = measure(num_threads, min_time, [&]() {
+        std::lock_guard<std::mutex> hold(lock);
+        sink.store(locked->parsed().values_as<std::int64_t>(port)[0],
+                   std::memory_order_relaxed);
+    }, [&](int n) {
+        std::shared_ptr<const snapshot> next = make(n);
+        std::lock_guard<std::mutex>     hold(lock);
+        locked = next;
+    });
+
+    std::shared_ptr<const snapshot> shared = make(0);
+    double ns_atomic = measure(num_threads, min_time, [&]() {
+        std::shared_ptr<const snapshot> s = std::atomic_load(&shared);
+        sink.store(s->parsed().values_as<std::int64_t>(port)[0], std::memory_order_relaxed);
+    }, [&](int n) {
+        std::atomic_store(&shared, make(n));
+    });
+
+    std::printf("%u reader threads, ns per read and thread\n\n", num_threads);
+    std::printf("%-12s %10.1f\n", "publisher", ns_publisher);
+    std::printf("%-12s %10.1f\n", "mutex", ns_mutex);
+    std::printf("%-12s %10.1f\n", "atomic_load", ns_atomic);
+    return 0;
+}
+
+} // namespace bench
@@ -0,0 +1,187 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+/*
+    Measures the latency of "did you mean" suggestions for a misspelled option, with
+    more and more options named like --group-17-option-42 or --enable-foo-bar. Each
+    request is a name with one typo, i.e. a swapped, missing or wrong character. The
+    suggestions are compared to a plain Levenshtein pass over all names.
+
+    Usage: loot-clp-bench suggest [--options n] [--min-time ms]
+*/
+
+#include "bench.h"
+
+#include <clp/parser.h>
+#include <clp/suggest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace loot::clp;
+
+namespace bench {
+
+namespace {
+
+/*!
+    The textbook dynamic program, without any of the shortcuts.
+*/
+std::size_t
+levenshtein(const std::string& lhs, const std::string& rhs)
+{
+    std::vector<std::size_t> row(rhs.size() + 1);
+    for (std::size_t c = 0; c <= rhs.size(); c++) {
+        row[c] = c;
+    }
+    for (std::size_t l = 0; l < lhs.size(); l++) {
+        std::size_t diagonal = row[0]++;
+        for (std::size_t c = 1; c <= rhs.size(); c++) {
+            std::size_t above = row[c];
+            row[c]   = std::min(std::min(row[c], row[c - 1]) + 1,
+                                diagonal + (lhs[l] == rhs[c - 1] ? 0 : 1));
+            diagonal = above;
+        }
+    }
+    return row[rhs.size()];
+}
+
+} // namespace
+
+int
+run_suggest(int argc, char* argv[])
+{
+    parser args = {
+            option("o",
+                   "options",
+                   option_type_e optional_option,
+                   value_constraint_e exact_num_values,
+                   1,
+                   "Largest number of options (default 50000)"),
+            option("t",
+                   "min-time",
+                   option_type_e optional_option,
+                   value_constraint_e exact_num_values,
+                   1,
+                   "Milliseconds to repeat every measurement at least (default 200)"),
+            option("h",
+                   "help",
+                   option_type_e help_option,
+                   value_constraint_e no_values,
+                   0,
+                   "Print this help")};
+
+    result r = args.parse(argc, argv);
+    if (!r.good() || r.has_option("help")) {
+        args.print_help(std::cout, false);
+        return r.good() ? 0 : 1;
+    }
+
+    std::size_t max_options = numeric_value(r, "options", 50000);
+    double      min_time    = numeric_value(r, "min-time", 200) / 1000.0;
+
+    const char* words[] = {"enable", "disable", "max", "min", "cache", "thread", "log",
+                           "level", "size", "path", "check", "dump", "trace", "limit"};
+    std::size_t num_words = sizeof(words) / sizeof(words[0]);
+
+    std::printf("%8s %12s %14s %14s %8s\n",
+                "options", "build us", "suggest us", "naive us", "same");
+    for (std::size_t num = 500; num <= max_options; num *= 10) {
+        std::mt19937                         random(7);
+        std::vector<std::string>             short_names(num);
+        std::vector<std::string>             long_names(num);
+        for (std::size_t o = 0; o < num; o++) {
+            long_names[o] = o % 2
+                ? "group-" + std::to_string(static_cast<unsigned long>(o % 97)) + "-option-"
+                  + std::to_string(static_cast<unsigned long>(o / 97))
+                : std::string(words[random() % num_words]) + "-" + words[random() % num_words]
+                  + "-" + std::to_string(static_cast<unsigned long>(o));
+        }
+
+        bench_clock::time_point start = bench_clock::now();
+        detail::name_suggester  suggester;
+        suggester.build(short_names, long_names);
+        double build = std::chrono::duration<double, std::micro>(
+                bench_clock::now() - start).count();
+
+        // One typo per request.
+        std::vector<std::string> typos;
+        for (std::size_t t = 0; t < 64; t++) {
+            std::string typo = long_names[random() % num];
+            std::size_t pos  = random() % (typo.size() - 1);
+            switch (t % 3) {
+                case 0:  std::swap(typo[pos], typo[pos + 1]); break;
+                case 1:  typo.erase(pos, 1);                   break;
+                default: typo[pos] = 'q';                      break;
+            }
+            typos.push_back(typo);
+        }
+
+        std::vector<detail::name_suggester::match> matches;
+        std::size_t                                calls = 0;
+        std::chrono::duration<double, std::micro>  elapsed;
+        start = bench_clock::now();
+        do {
+            suggester.suggest(typos[calls % typos.size()], 1, matches);
+            calls++;
+            elapsed = bench_clock::now() - start;
+        } while (elapsed.count() < min_time * 1e6);
+        double fast = elapsed.count() / calls;
+
+        // The naive pass is slow, a few requests are enough.
+        bool same = true;
+        start     = bench_clock::now();
+        for (std::size_t t = 0; t < 8; t++) {
+            std::size_t best = 0;
+            for (std::size_t o = 1; o < num; o++) {
+                if (levenshtein(typos[t], long_names[o])
+                        < levenshtein(typos[t], long_names[best])) {
+                    best = o;
+                }
+            }
+
+            suggester.suggest(typos[t], 1, matches);
+            same = same && !matches.empty()
+                && matches[0].distance == levenshtein(typos[t], long_names[best]);
+        }
+        double naive = std::chrono::duration<double, std::micro>(
+                bench_clock::now() - start).count() / 8;
+
+        std::printf("%8lu %12.1f %14.2f %14.1f %8s\n",
+                    static_cast<unsigned long>(num), build, fast, naive,
+                    same ? "yes" : "no");
+    }
+    return 0;
+}
+
+} // namespace bench
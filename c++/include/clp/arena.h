@@ -0,0 +1,173 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "../config.h"
+
+#include <cstddef>
+
+namespace loot {
+namespace clp {
+
+
+/*!
+    A monotonic memory region. Memory is handed out by bumping a pointer and never freed
+    individually; `reset()` makes the whole region available again without returning it
+    to the system. If a request doesn't fit the region grows by another block, on the
+    next `reset()` all blocks are merged into one. After a few rounds of use and reset a
+    single block is large enough and no more system allocations take place.
+
+    Only trivially destructible objects may be placed in an arena, their destructors are
+    never called.
+*/
+class LOOT_LIB_EXPORT arena
+{
+public:
+    /*!
+        Create an arena. No memory is allocated until it is first needed.
+
+        @param[in] block_size
+        Size in bytes of the first block.
+    */
+    explicit arena(std::size_t block_size = 4096);
+
+    /*!
+        Move-constructor. `temp` is left without any memory.
+
+        @param[in] temp
+        Temporary instance to move the memory from.
+    */
+    arena(arena&& temp);
+
+    /*!
+        Move-assignment-operator. The memory of the current instance is returned to the
+        system, `temp` is left without any memory.
+
+        @param[in] temp
+        Temporary instance to move the memory from.
+
+        @return
+        Returns the current instance that now owns the memory of `temp`.
+    */
+    arena& operator=(arena&& temp);
+
+    arena(const arena& other) = delete;
+    arena& operator=(const arena& other) = delete;
+
+    /*!
+        Returns all memory to the system.
+    */
+    ~arena();
+
+    /*!
+        Allocate uninitialized memory.
+
+        @param[in] size
+        Number of bytes.
+
+        @param[in] alignment
+        Required alignment, must be a power of two.
+
+        @return
+        Returns a pointer to the memory. It stays valid until the next call to `reset()`
+        or the destruction of the arena. Throws `std::bad_alloc` if the system is out of
+        memory.
+    */
+    void* allocate(std::size_t size, std::size_t alignment);
+
+    /*!
+        Allocate uninitialized memory for an array.
+
+        @param[in] count
+        Number of elements.
+
+        @return
+        Returns a pointer to the first element.
+    */
+    template<typename T>
+    T* allocate_array(std::size_t count)
+    {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /*!
+        Make all memory available again. Everything allocated before becomes invalid. If
+        the arena consists of more than one block they are replaced by a single block of
+        their combined size.
+    */
+    void reset();
+
+    /*!
+        @return
+        Returns the number of bytes the arena has allocated from the system.
+    */
+    std::size_t capacity() const;
+
+    /*!
+        @return
+        Returns the number of bytes handed out since the last `reset()`, including
+        padding for alignment.
+    */
+    std::size_t used() const;
+
+private:
+    /*!
+        Header of a block; The usable memory follows right behind it.
+    */
+    struct block
+    {
+        block*      previous;
+        std::size_t size;
+    };
+
+    /*!
+        Adds a block that can hold at least `size` bytes with the given alignment.
+    */
+    void grow(std::size_t size, std::size_t alignment);
+
+    /*!
+        Frees all blocks.
+    */
+    void release();
+
+    block*      current;
+    char*       next;
+    char*       limit;
+    std::size_t block_size;
+    std::size_t total;
+    std::size_t consumed;
+};
+
+
+} // namespace clp
+} // namespace loot
+
+#endif // ARENA_H
@@ -0,0 +1,289 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ARG_VIEW_H
+#define ARG_VIEW_H
+
+#include "../config.h"
+
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace loot {
+namespace clp {
+
+
+/*!
+    A `loot::clp::arg_view` refers to a sequence of characters owned by someone else,
+    usually one entry of the `argv` array passed to `main(...)`. Nothing is copied, the
+    view stays valid as long as the referenced characters do. The characters are not
+    required to be terminated by `'\0'`.
+*/
+class arg_view
+{
+public:
+    /*!
+        Create an empty view.
+    */
+    arg_view()
+        : ptr(""), len(0)
+    {}
+
+    /*!
+        Create a view of a `'\0'` terminated string.
+
+        @param[in] str
+        The string to refer to.
+    */
+    arg_view(const char* str)
+        : ptr(str), len(std::strlen(str))
+    {}
+
+    /*!
+        Create a view of `length` characters starting at `data`.
+
+        @param[in] data
+        Pointer to the first character.
+
+        @param[in] length
+        Number of characters referred to.
+    */
+    arg_view(const char* data, std::size_t length)
+        : ptr(data), len(length)
+    {}
+
+    /*!
+        Create a view of the characters of a string. The view becomes invalid as soon as
+        `str` is modified or destroyed.
+
+        @param[in] str
+        The string to refer to.
+    */
+    arg_view(const std::string& str)
+        : ptr(str.data()), len(str.length())
+    {}
+
+    /*!
+        @return
+        Returns a pointer to the first character.
+    */
+    const char* data() const { return ptr; }
+
+    /*!
+        @return
+        Returns the number of characters referred to.
+    */
+    std::size_t size() const { return len; }
+
+    /*!
+        @return
+        Returns `true` if the view refers to no characters.
+    */
+    bool empty() const { return 0 == len; }
+
+    const char* begin() const { return ptr; }
+    const char* end() const { return ptr + len; }
+
+    char operator[](std::size_t pos) const { return ptr[pos]; }
+
+    /*!
+        Create a view of a part of this view.
+
+        @param[in] pos
+        Position of the first character of the part. Must not be greater than `size()`.
+
+        @param[in] count
+        Maximum number of characters of the part.
+
+        @return
+        Returns the part, which refers to the same characters as this view does.
+    */
+    arg_view sub(std::size_t pos, std::size_t count = std::string::npos) const
+    {
+        return arg_view(ptr + pos, count < len - pos ? count : len - pos);
+    }
+
+    /*!
+        @return
+        Returns a copy of the characters as a `std::string`.
+    */
+    std::string str() const { return std::string(ptr, len); }
+
+    bool operator==(const arg_view& other) const
+    {
+        return len == other.len && 0 == std::memcmp(ptr, other.ptr, len);
+    }
+
+    bool operator!=(const arg_view& other) const { return !(*this == other); }
+
+private:
+    const char* ptr;
+    std::size_t len;
+};
+
+inline bool operator==(const char* lhs, const arg_view& rhs) { return rhs == lhs; }
+inline bool operator!=(const char* lhs, const arg_view& rhs) { return rhs != lhs; }
+inline bool operator==(const std::string& lhs, const arg_view& rhs) { return rhs == lhs; }
+inline bool operator!=(const std::string& lhs, const arg_view& rhs) { return rhs != lhs; }
+
+inline std::ostream& operator<<(std::ostream& out, const arg_view& view)
+{
+    return out.write(view.data(), view.size());
+}
+
+
+/*!
+    A contiguous, read-only range of `loot::clp::arg_view` instances, for example all
+    values of one option. Like the views themselves the span owns nothing.
+*/
+class arg_span
+{
+public:
+    typedef const arg_view* const_iterator;
+
+    /*!
+        Create an empty span.
+    */
+    arg_span()
+        : first(0), count(0)
+    {}
+
+    /*!
+        Create a span of `size` views starting at `first`.
+
+        @param[in] first
+        Pointer to the first view.
+
+        @param[in] size
+        Number of views in the span.
+    */
+    arg_span(const arg_view* first, std::size_t size)
+        : first(first), count(size)
+    {}
+
+    const_iterator begin() const { return first; }
+    const_iterator end() const { return first + count; }
+
+    std::size_t size() const { return count; }
+    bool empty() const { return 0 == count; }
+
+    const arg_view& operator[](std::size_t pos) const { return first[pos]; }
+
+    /*!
+        Access a view with bounds checking.
+
+        @param[in] pos
+        Position of the view in the span.
+
+        @return
+        Returns the view at position `pos`. Throws `std::out_of_range` if `pos` is not
+        within the span.
+    */
+    const arg_view& at(std::size_t pos) const
+    {
+        if (pos >= count) {
+            throw std::out_of_range("loot::clp::arg_span::at");
+        }
+        return first[pos];
+    }
+
+private:
+    const arg_view* first;
+    std::size_t     count;
+};
+
+
+/*!
+    A contiguous range of entries of an `argv` array. Unlike `loot::clp::arg_span` it
+    needs no array of views, the views are created when an entry is accessed.
+*/
+class argv_span
+{
+public:
+    typedef char* const* const_iterator;
+
+    /*!
+        Create an empty span.
+    */
+    argv_span()
+        : first(0), count(0)
+    {}
+
+    /*!
+        Create a span of `size` entries starting at `first`.
+
+        @param[in] first
+        Pointer to the first entry.
+
+        @param[in] size
+        Number of entries in the span.
+    */
+    argv_span(char* const* first, std::size_t size)
+        : first(first), count(size)
+    {}
+
+    const_iterator begin() const { return first; }
+    const_iterator end() const { return first + count; }
+
+    std::size_t size() const { return count; }
+    bool empty() const { return 0 == count; }
+
+    arg_view operator[](std::size_t pos) const { return arg_view(first[pos]); }
+
+    /*!
+        Access an entry with bounds checking.
+
+        @param[in] pos
+        Position of the entry in the span.
+
+        @return
+        Returns a view of the entry at position `pos`. Throws `std::out_of_range` if
+        `pos` is not within the span.
+    */
+    arg_view at(std::size_t pos) const
+    {
+        if (pos >= count) {
+            throw std::out_of_range("loot::clp::argv_span::at");
+        }
+        return arg_view(first[pos]);
+    }
+
+private:
+    char* const* first;
+    std::size_t  count;
+};
+
+
+} // namespace clp
+} // namespace loot
+
+#endif // ARG_VIEW_H
@@ -120,17 +120,80 @@ enum requirement_error
     /*!
         Invalid `loot::clp::value_constraint` specified.
     */
-    invalid_value_constraint_error
+    invalid_value_constraint_error,
+    /*!
+        A value does not have the form required by the `loot::clp::value_type` of the
+        option.
+    */
+    value_not_convertible_error,
+    /*!
+        A numeric value is too large or too small for the `loot::clp::value_type` of the
+        option.
+    */
+    value_out_of_range_error,
+    /*!
+        A value is not one of the choices of a `loot::clp::enum_value` option.
+    */
+    value_not_a_choice_error,
+    /*!
+        An abbreviated long name is the prefix of the long names of several options. The
+        error is reported for the first of them.
+    */
+    ambiguous_option_error,
+    /*!
+        A value is attached to an option that takes no values, like `--verbose=yes`. The
+        option is regarded as found anyway.
+    */
+    unexpected_value_error
+};
+
+/*!
+    Defines constants which describe into what the values of a `loot::clp::option` are
+    converted while parsing.
+*/
+#ifdef HAS_CXX11_ENUM_CLASS
+enum class value_type
+#else
+enum value_type
+#endif
+{
+    /*!
+        Values are kept as they are found on the command line.
+    */
+    text_value = 1,
+    /*!
+        Values are converted into `std::int64_t`.
+    */
+    integer_value,
+    /*!
+        Values are converted into `double`.
+    */
+    real_value,
+    /*!
+        Values are converted into `bool`.
+    */
+    boolean_value,
+    /*!
+        Values are names that are mapped to a `std::int64_t` by the choices of the option.
+    */
+    enum_value,
+    /*!
+        Every value is a list of integers separated by the delimiter of the option. The
+        integers of all values are converted into one array of `std::int64_t`.
+    */
+    integer_list_value
 };
 
 #ifdef HAS_CXX11_ENUM_CLASS
 	#define value_constraint_e  value_constraint::
 	#define option_type_e       option_type::
 	#define requirement_error_e requirement_error::
+	#define value_type_e        value_type::
 #else
 	#define value_constraint_e 
 	#define option_type_e 
 	#define requirement_error_e 
+	#define value_type_e 
 #endif
 
 } // namespace clp
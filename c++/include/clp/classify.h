@@ -0,0 +1,202 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+/*!
+    \file
+    The classification pre-pass of the parse engine. Before the options are dispatched
+    every argument is examined once and described by a small `arg_info`: whether it is
+    an option switch, whether it is the `--` terminator and where its first `=` is. The
+    engine then only reads the descriptors instead of looking at the characters again.
+
+    The arguments of `argv` are scanned with SSE2 or AVX2 if the compiler targets them
+    (`__SSE2__`, `__AVX2__`, or MSVC for x64), otherwise with plain C++. One vector pass
+    over an argument finds its end and its `=` at the same time.
+*/
+
+#ifndef CLASSIFY_H
+#define CLASSIFY_H
+
+#include "../config.h"
+#include "arg_view.h"
+#include "engine.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace loot {
+namespace clp {
+namespace detail {
+
+
+/*!
+    Describes one argument of the command line.
+*/
+struct arg_info
+{
+    /*!
+        Position of the first `=` in the argument or `no_equals`.
+    */
+    std::uint32_t equals;
+
+    /*!
+        Number of leading dashes that make the argument an option switch: Zero (`0`) for
+        values, one (`1`) for short and two (`2`) for long options. The same as
+        `loot::clp::detail::is_option` returns.
+    */
+    std::uint8_t dashes;
+
+    /*!
+        `true` if the argument is exactly `--`.
+    */
+    bool terminator;
+};
+
+/*!
+    Value of `arg_info::equals` for arguments without `=`.
+*/
+const std::uint32_t no_equals = 0xFFFFFFFFu;
+
+/*!
+    Classifies `'\0'` terminated arguments and determines their lengths.
+
+    @param[in] argv
+    The arguments.
+
+    @param[in] count
+    The number of arguments.
+
+    @param[out] tokens
+    Receives a view of every argument, `count` entries.
+
+    @param[out] infos
+    Receives the description of every argument, `count` entries.
+*/
+LOOT_LIB_EXPORT void
+classify(char* const* argv, std::size_t count, arg_view* tokens, arg_info* infos);
+
+/*!
+    Classifies arguments of known length, e.g. read from a response file.
+
+    @param[in] tokens
+    The arguments.
+
+    @param[in] count
+    The number of arguments.
+
+    @param[out] infos
+    Receives the description of every argument, `count` entries.
+*/
+LOOT_LIB_EXPORT void
+classify(const arg_view* tokens, std::size_t count, arg_info* infos);
+
+/*!
+    The command line as seen by the parse engine after classification. Provides what the
+    engine needs of a list of tokens, see `loot::clp::detail::dispatch`.
+*/
+class classified_span
+{
+public:
+    classified_span(const arg_view* tokens, const arg_info* infos, std::size_t count)
+        : tokens(tokens), infos(infos), count(count)
+    {}
+
+    std::size_t size() const { return count; }
+    const arg_view& operator[](std::size_t pos) const { return tokens[pos]; }
+    const arg_info& info(std::size_t pos) const { return infos[pos]; }
+
+private:
+    const arg_view* tokens;
+    const arg_info* infos;
+    std::size_t     count;
+};
+
+/*!
+    Looks up whether a token is an option switch, see `is_option`. Uses the descriptor
+    instead of the characters.
+
+    @param[in] tokens
+    The classified command line.
+
+    @param[in] pos
+    Position of the token.
+
+    @return
+    Returns the number of leading dashes of an option switch or zero (`0`).
+*/
+inline int
+option_start(const classified_span& tokens, std::size_t pos)
+{
+    return tokens.info(pos).dashes;
+}
+
+/*!
+    Looks up whether a token is the terminator, see `is_terminator`. Uses the descriptor
+    instead of the characters.
+
+    @param[in] tokens
+    The classified command line.
+
+    @param[in] pos
+    Position of the token.
+
+    @return
+    Returns `true` if the token is exactly "`--`".
+*/
+inline bool
+is_terminator(const classified_span& tokens, std::size_t pos)
+{
+    return tokens.info(pos).terminator;
+}
+
+/*!
+    Looks up the `=` in a token, see `equals_at`. Uses the descriptor instead of the
+    characters.
+
+    @param[in] tokens
+    The classified command line.
+
+    @param[in] pos
+    Position of the token.
+
+    @return
+    Returns the position of the first `=` or `npos`.
+*/
+inline std::size_t
+equals_at(const classified_span& tokens, std::size_t pos)
+{
+    std::uint32_t equals = tokens.info(pos).equals;
+    return no_equals == equals ? npos : equals;
+}
+
+
+} // namespace detail
+} // namespace clp
+} // namespace loot
+
+#endif // CLASSIFY_H
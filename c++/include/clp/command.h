@@ -0,0 +1,235 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include "../config.h"
+#include "arg_view.h"
+#include "parser.h"
+#include "result.h"
+#include "schema.h"
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace loot {
+namespace clp {
+
+class command;
+
+/*!
+    One level of a command line dispatched by `loot::clp::command::dispatch`: The
+    command, its options and the result of parsing the arguments between its name and
+    the name of the next sub-command.
+*/
+struct command_level
+{
+    /*!
+        The command of the level, it belongs to the tree.
+    */
+    const command* cmd;
+
+    /*!
+        The options the command's factory created. The result refers to them.
+    */
+    std::shared_ptr<const schema> options;
+
+    /*!
+        The arguments of the level. Their application name is the name of the command,
+        for the root level the application name of the command line.
+    */
+    result parsed;
+};
+
+/*!
+    A node in a tree of sub-commands, like `git remote add`. Every command has its own
+    options and any number of sub-commands. Its options are created on demand by a
+    factory, so a command line only builds the parsers of the commands it names, no
+    matter how many commands the tree has.
+
+    The options of a command are given between its name and the name of the sub-command,
+    e.g. `app --verbose remote --dry-run add`. Values of an option that end in the name of
+    a sub-command select the sub-command. Behind "`--`" no sub-command is selected, the
+    arguments are forwarded by the level in front of it.
+*/
+class LOOT_LIB_EXPORT command
+{
+public:
+    /*!
+        Creates the parser with the options of a command.
+    */
+    typedef std::function<parser ()> factory;
+
+    /*!
+        Create a command.
+
+        @param[in] name
+        The name of the command as given on the command line. Empty for the root of the
+        tree.
+
+        @param[in] make
+        Creates the options of the command. Without a factory the command has no
+        options.
+
+        @param[in] description
+        A short description for the help text.
+    */
+    explicit command(const std::string& name        = "",
+                     factory            make        = factory(),
+                     const std::string& description = "");
+
+    command(const command& other) = delete;
+    command& operator=(const command& other) = delete;
+
+    /*!
+        Add a sub-command. A previous sub-command of the same name is replaced.
+
+        @param[in] name
+        The name of the sub-command, must not be empty.
+
+        @param[in] make
+        Creates the options of the sub-command.
+
+        @param[in] description
+        A short description for the help text.
+
+        @return
+        Returns the sub-command, to add its own sub-commands to. It stays valid as long
+        as this command exists.
+    */
+    command& add(const std::string& name,
+                 factory            make,
+                 const std::string& description = "");
+
+    /*!
+        Find a sub-command.
+
+        @param[in] name
+        The name of the sub-command.
+
+        @return
+        Returns the sub-command or a null pointer if there is none of that name.
+    */
+    const command* find(const arg_view& name) const;
+
+    /*!
+        @return
+        Returns the name of the command.
+    */
+    const std::string& name() const;
+
+    /*!
+        @return
+        Returns the description of the command.
+    */
+    const std::string& description() const;
+
+    /*!
+        Parses a command line. The arguments are split into levels at the names of
+        sub-commands, starting with this command. Names that are values of options are
+        no sub-commands. Only the options of the commands that are named are created,
+        each level is parsed once.
+
+        @param[in] argc
+        The number of arguments that can be found on the command line.
+
+        @param[in] argv
+        Pointer to the first element of an array of character string pointers
+        which contains the whole command line.
+
+        @return
+        Returns one level for this command and one for every sub-command named on the
+        command line, in that order. The last level is the command to run. The results
+        refer to `argv`, which has to outlive them.
+    */
+    std::vector<command_level> dispatch(int argc, char* argv[]) const;
+
+    /*!
+        Print the options of the command followed by its sub-commands. Builds the
+        options of this command, but not of its sub-commands.
+
+        @param[in] out
+        Output stream to write the help to.
+
+        @param[in] newline
+        Set to `true` to add a new line after each option creating more space between
+        them. Set to `false` to create a more condensed output.
+    */
+    void print_help(std::ostream& out, bool newline) const;
+
+private:
+    /*!
+        @return
+        Returns the options of the command, created by `make`.
+    */
+    std::shared_ptr<const schema> build() const;
+
+    /*!
+        Finds the position of the sub-command's name, skipping the options of this
+        command and their values. The values are found by the parse engine, so a name
+        that `parse` takes as a value, e.g. in `--level commit` or `-vo build`, is no
+        sub-command.
+
+        @param[in] options
+        The options of this command.
+
+        @param[in] argc
+        The number of arguments.
+
+        @param[in] argv
+        The arguments, starting with the name of this command.
+
+        @return
+        Returns the position of the first argument naming a sub-command or `argc`.
+    */
+    int split(const schema& options, int argc, char* argv[]) const;
+
+    std::string label;
+    std::string about;
+    factory     make;
+
+    /*!
+        The sub-commands by name. Their factories aren't called until they are named on a
+        command line.
+    */
+    std::map<std::string, std::unique_ptr<command>> children;
+
+};
+
+
+} // namespace clp
+} // namespace loot
+
+#endif // COMMAND_H
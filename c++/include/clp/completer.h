@@ -0,0 +1,190 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef COMPLETER_H
+#define COMPLETER_H
+
+#include "../config.h"
+#include "arg_view.h"
+#include "schema.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace loot {
+namespace clp {
+
+
+/*!
+    Completes partial command lines for interactive shells. Option switches are looked
+    up in a sorted index of all names, built once when the completer is created, so a
+    request takes time logarithmic in the number of options plus the number of
+    candidates. One completer can answer any number of requests, e.g. in a completion
+    daemon, concurrently if need be.
+
+    Words starting with "`-`" complete to the short names as "`-x`" and the long names as
+    "`--name`" they are a prefix of; Options already on the command line are left out.
+    Values complete to the choices of `loot::clp::enum_value` options and to "`true`" and
+    "`false`" for `loot::clp::boolean_value` options. Other values are left to the shell.
+*/
+class LOOT_LIB_EXPORT completer
+{
+public:
+    /*!
+        Returned by `complete` to read all candidates.
+    */
+    static const std::size_t npos = static_cast<std::size_t>(-1);
+
+    /*!
+        A possible completion. The views refer to the completer and its schema.
+    */
+    struct candidate
+    {
+        /*!
+            The complete word, e.g. "`--verbose`".
+        */
+        arg_view text;
+
+        /*!
+            The description of the option, empty for values.
+        */
+        arg_view description;
+
+        /*!
+            The option the candidate belongs to.
+        */
+        std::size_t ordinal;
+    };
+
+    /*!
+        Create a completer for the options of a schema and build its index.
+
+        @param[in] options
+        The schema, see `loot::clp::parser::freeze()`.
+    */
+    explicit completer(std::shared_ptr<const schema> options);
+
+    /*!
+        Completes the last word of a partial command line. Switches are understood the
+        way the parse engine does, including clusters like `-xvf` and attached values
+        like `--name=value`; In the last word the part behind `=` is completed as a value.
+        Nothing is completed behind "`--`".
+
+        @param[in] words
+        The command line without the application name. The last word is the one being
+        completed, it is empty if a new word is started.
+
+        @param[out] candidates
+        Receives the candidates, names ordered by their text and choices in the order of
+        the option. It is cleared first, its capacity is reused.
+
+        @param[in] max
+        Maximum number of candidates to read.
+
+        @return
+        Returns the number of candidates.
+    */
+    std::size_t complete(arg_span                words,
+                         std::vector<candidate>& candidates,
+                         std::size_t             max = npos) const;
+
+    /*!
+        Handles the `--complete` protocol. If the first argument is `--complete` the
+        words behind it are completed and the candidates are written to `out`, one per
+        line as `text`, or `text<TAB>description` if there is a description. Call it at
+        the start of `main` and return if it handled the command line.
+
+        @param[in] argc
+        The number of arguments that can be found on the command line.
+
+        @param[in] argv
+        The command line, including the application name.
+
+        @param[in] out
+        Receives the candidates.
+
+        @return
+        Returns `true` if the command line was a completion request.
+    */
+    bool handle(int argc, char* argv[], std::ostream& out) const;
+
+    /*!
+        Answers completion requests until `in` ends. Each request is a line with the words
+        to complete, separated by tabs. Each answer lists the candidates like `handle`
+        does and ends with an empty line; `out` is flushed after it.
+
+        @param[in] in
+        The requests.
+
+        @param[in] out
+        Receives the answers.
+    */
+    void serve(std::istream& in, std::ostream& out) const;
+
+private:
+    /*!
+        A name in `keys`, with its option switch.
+    */
+    struct key
+    {
+        std::uint32_t offset;
+        std::uint32_t length;
+        std::size_t   ordinal;
+    };
+
+    /*!
+        Writes candidates as described at `handle`.
+    */
+    static void write(const std::vector<candidate>& candidates, std::ostream& out);
+
+    /*!
+        The options.
+    */
+    std::shared_ptr<const schema> options;
+
+    /*!
+        Every name with its option switch, like "`--verbose`", one after the other.
+    */
+    std::vector<char> keys;
+
+    /*!
+        The names in `keys`, sorted by their text.
+    */
+    std::vector<key> index;
+};
+
+
+} // namespace clp
+} // namespace loot
+
+#endif // COMPLETER_H
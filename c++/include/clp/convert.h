@@ -0,0 +1,405 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+/*!
+    \file
+    Conversion of values into numbers, booleans and enumerations. Values are converted
+    once while parsing, see `loot::clp::option::conversion`, and are then available as
+    arrays of the target type through `loot::clp::result::values_as`.
+
+    The conversion routines never allocate memory and don't depend on the locale, like
+    `std::from_chars` of C++17 which isn't available in C++11.
+*/
+
+#ifndef CONVERT_H
+#define CONVERT_H
+
+#include "../config.h"
+#include "args.h"
+#include "arg_view.h"
+#include "option.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace loot {
+namespace clp {
+
+
+/*!
+    A contiguous range of converted values of one option, see
+    `loot::clp::result::values_as`.
+*/
+template<typename T>
+class value_span
+{
+public:
+    typedef const T* const_iterator;
+
+    /*!
+        Create an empty span.
+    */
+    value_span()
+        : first(0), count(0)
+    {}
+
+    /*!
+        Create a span of `size` values starting at `first`.
+
+        @param[in] first
+        Pointer to the first value.
+
+        @param[in] size
+        Number of values in the span.
+    */
+    value_span(const T* first, std::size_t size)
+        : first(first), count(size)
+    {}
+
+    const_iterator begin() const { return first; }
+    const_iterator end() const { return first + count; }
+
+    std::size_t size() const { return count; }
+    bool empty() const { return 0 == count; }
+
+    const T& operator[](std::size_t pos) const { return first[pos]; }
+
+    /*!
+        Access a value with bounds checking.
+
+        @param[in] pos
+        Position of the value in the span.
+
+        @return
+        Returns the value at position `pos`. Throws `std::out_of_range` if `pos` is not
+        within the span.
+    */
+    const T& at(std::size_t pos) const
+    {
+        if (pos >= count) {
+            throw std::out_of_range("loot::clp::value_span::at");
+        }
+        return first[pos];
+    }
+
+private:
+    const T*    first;
+    std::size_t count;
+};
+
+/*!
+    Maps the types values can be converted into to their `loot::clp::value_type`. Only
+    specialized for `std::int64_t`, `double` and `bool`.
+*/
+template<typename T>
+struct value_traits;
+
+template<>
+struct value_traits<std::int64_t>
+{
+    static value_type type() { return value_type_e integer_value; }
+
+    /*!
+        Enumerations and lists of integers are converted into numbers as well.
+    */
+    static bool accepts(value_type t)
+    {
+        return value_type_e integer_value == t
+            || value_type_e enum_value == t
+            || value_type_e integer_list_value == t;
+    }
+};
+
+template<>
+struct value_traits<double>
+{
+    static value_type type() { return value_type_e real_value; }
+    static bool accepts(value_type t) { return value_type_e real_value == t; }
+};
+
+template<>
+struct value_traits<bool>
+{
+    static value_type type() { return value_type_e boolean_value; }
+    static bool accepts(value_type t) { return value_type_e boolean_value == t; }
+};
+
+/*!
+    Makes an option convert its values into `T`.
+
+    @param[in] opt
+    The option.
+
+    @return
+    Returns a copy of `opt` whose values are converted into `T`, which is one of
+    `std::int64_t`, `double` and `bool`.
+*/
+template<typename T>
+option
+typed_option(option opt)
+{
+    opt.conversion = value_traits<T>::type();
+    return opt;
+}
+
+/*!
+    Makes an option accept only the names of `choices` as values, each converted into the
+    number it is paired with.
+
+    @param[in] opt
+    The option.
+
+    @param[in] choices
+    The accepted names and what they are converted into.
+
+    @return
+    Returns a copy of `opt` that is a `loot::clp::enum_value` option.
+*/
+inline option
+enum_option(option opt, std::vector<std::pair<std::string, std::int64_t>> choices)
+{
+    opt.conversion = value_type_e enum_value;
+    opt.choices    = std::move(choices);
+    return opt;
+}
+
+/*!
+    Makes an option convert its values into lists of integers.
+
+    @param[in] opt
+    The option.
+
+    @param[in] delimiter
+    Separates the integers within one value.
+
+    @return
+    Returns a copy of `opt` that is a `loot::clp::integer_list_value` option.
+*/
+inline option
+list_option(option opt, char delimiter = ',')
+{
+    opt.conversion = value_type_e integer_list_value;
+    opt.delimiter  = delimiter;
+    return opt;
+}
+
+/*!
+    Counts the entries of a list without converting them.
+
+    @param[in] arg
+    The list.
+
+    @param[in] delimiter
+    Separates the entries.
+
+    @return
+    Returns the number of delimiters plus one or zero (`0`) for an empty list.
+*/
+LOOT_LIB_EXPORT std::size_t
+count_list_values(const arg_view& arg, char delimiter);
+
+/*!
+    Converts a list of decimal integers, each with an optional sign, into a buffer of
+    the caller. Digits are classified with SSE2 or AVX2 and converted eight at a time if
+    the platform allows, otherwise one by one.
+
+    @param[in] arg
+    The list. An empty list has no entries, empty entries are not accepted.
+
+    @param[in] delimiter
+    Separates the integers.
+
+    @param[out] buffer
+    Receives the integers.
+
+    @param[in] capacity
+    The number of integers `buffer` can take. Throws `std::length_error` if the list has
+    more entries, see `count_list_values`.
+
+    @param[out] count
+    Receives the number of integers written to `buffer`.
+
+    @param[out] reason
+    Receives why the list can't be converted.
+
+    @return
+    Returns `true` if the list has been converted or `false` otherwise.
+*/
+LOOT_LIB_EXPORT bool
+convert_integer_list(const arg_view&    arg,
+                     char               delimiter,
+                     std::int64_t*      buffer,
+                     std::size_t        capacity,
+                     std::size_t&       count,
+                     requirement_error& reason);
+
+/*!
+    Converts a list of decimal integers and appends them to `values`, see
+    `convert_integer_list(const arg_view&, char, std::int64_t*, std::size_t,
+    std::size_t&, requirement_error&)`.
+
+    @param[in] arg
+    The list.
+
+    @param[in] delimiter
+    Separates the integers.
+
+    @param[in,out] values
+    Receives the integers. Left as it was if the list can't be converted.
+
+    @param[out] reason
+    Receives why the list can't be converted.
+
+    @return
+    Returns `true` if the list has been converted or `false` otherwise.
+*/
+LOOT_LIB_EXPORT bool
+convert_integer_list(const arg_view&            arg,
+                     char                       delimiter,
+                     std::vector<std::int64_t>& values,
+                     requirement_error&         reason);
+
+namespace detail {
+
+/*!
+    @return
+    Returns the size in bytes of one converted value of type `type`, zero (`0`) for
+    `loot::clp::text_value`.
+*/
+inline std::size_t
+value_size(value_type type)
+{
+    switch (type) {
+        case value_type_e integer_value:
+        case value_type_e enum_value:
+        case value_type_e integer_list_value:
+            return sizeof(std::int64_t);
+
+        case value_type_e real_value:
+            return sizeof(double);
+
+        case value_type_e boolean_value:
+            return sizeof(bool);
+
+        default:
+            return 0;
+    }
+}
+
+/*!
+    Converts a decimal integer with an optional sign.
+
+    @param[in] arg
+    The value to convert, all of it has to be part of the number.
+
+    @param[out] value
+    Receives the number.
+
+    @param[out] reason
+    Receives why the value can't be converted.
+
+    @return
+    Returns `true` if the value has been converted or `false` otherwise.
+*/
+LOOT_LIB_EXPORT bool
+convert_integer(const arg_view& arg, std::int64_t& value, requirement_error& reason);
+
+/*!
+    Converts a decimal floating point number with an optional sign and exponent, or one
+    of "inf", "infinity" and "nan" in any case. Values are rounded correctly. Numbers of
+    more than 127 characters aren't accepted.
+
+    @param[in] arg
+    The value to convert, all of it has to be part of the number.
+
+    @param[out] value
+    Receives the number.
+
+    @param[out] reason
+    Receives why the value can't be converted.
+
+    @return
+    Returns `true` if the value has been converted or `false` otherwise.
+*/
+LOOT_LIB_EXPORT bool
+convert_real(const arg_view& arg, double& value, requirement_error& reason);
+
+/*!
+    Converts one of "true", "yes", "on", "1" and "false", "no", "off", "0" in any case.
+
+    @param[in] arg
+    The value to convert.
+
+    @param[out] value
+    Receives the boolean.
+
+    @param[out] reason
+    Receives why the value can't be converted.
+
+    @return
+    Returns `true` if the value has been converted or `false` otherwise.
+*/
+LOOT_LIB_EXPORT bool
+convert_boolean(const arg_view& arg, bool& value, requirement_error& reason);
+
+/*!
+    Converts the name of a choice into its number.
+
+    @param[in] arg
+    The value to convert, it has to match a name exactly.
+
+    @param[in] choices
+    The choices of the option.
+
+    @param[out] value
+    Receives the number of the choice.
+
+    @param[out] reason
+    Receives why the value can't be converted.
+
+    @return
+    Returns `true` if the value has been converted or `false` otherwise.
+*/
+LOOT_LIB_EXPORT bool
+convert_choice(const arg_view&                                          arg,
+               const std::vector<std::pair<std::string, std::int64_t>>& choices,
+               std::int64_t&                                            value,
+               requirement_error&                                       reason);
+
+} // namespace detail
+
+
+} // namespace clp
+} // namespace loot
+
+#endif // CONVERT_H
@@ -0,0 +1,770 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+/*!
+    \file
+    The parse engine shared by `loot::clp::schema` and `loot::clp::static_schema`. Both
+    only differ in how they store their options and look up names, the rules of how the
+    command line is interpreted are implemented once in here.
+*/
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "../config.h"
+#include "args.h"
+#include "arg_view.h"
+
+#include <cstddef>
+#include <cstring>
+
+namespace loot {
+namespace clp {
+namespace detail {
+
+
+/*!
+    Returned by lookups that don't find a name.
+*/
+const std::size_t npos = static_cast<std::size_t>(-1);
+
+/*!
+    Set by lookups in the ordinal they return if a name is ambiguous, see
+    `find_switch`. The remaining bits are the first option the name could mean.
+*/
+const std::size_t ambiguous = ~(npos >> 1);
+
+/*!
+    Looks up the name behind an option switch. Tables that resolve abbreviated names
+    provide `find(const arg_view& name, int start)`, which is given the length of the
+    switch and may return an ordinal with `ambiguous` set.
+
+    @param[in] table
+    The options.
+
+    @param[in] name
+    The name without the option switch.
+
+    @param[in] start
+    The length of the option switch, see `is_option`.
+
+    @return
+    Returns the ordinal of the option, `npos` or an ambiguous ordinal.
+*/
+template<typename Table>
+auto
+find_switch(const Table& table, const arg_view& name, int start, int)
+        -> decltype(table.find(name, start))
+{
+    return table.find(name, start);
+}
+
+/*!
+    Looks up the name behind an option switch in tables that only know exact names.
+*/
+template<typename Table>
+std::size_t
+find_switch(const Table& table, const arg_view& name, int, long)
+{
+    return table.find(name);
+}
+
+/*!
+    Tests whether an argument is to be seen as an option.
+
+    @param[in] arg
+    The argument that shall be tested. It is interpreted as an option if it starts with
+    "`-`" or "`--`".
+
+    @return
+    If it is not an option zero (`0`) is returned. Otherwise the position at which the
+    actual name of the option starts (eluding the hyphen[s]). This value is either one
+    (`1`) or two (`2`).
+*/
+inline int
+is_option(const arg_view& arg)
+{
+    // Test for double dash first as testing for single dash first would return the wrong
+    // starting position if it were a double dash since a double dash starts with a single
+    // dash.
+    if (!arg.empty() && '-' == arg[0]) {
+        return arg.size() > 1 && '-' == arg[1] ? 2 : 1;
+    }
+
+    return 0;
+}
+
+/*!
+    Tests whether a token of the command line is to be seen as an option, see
+    `is_option`. Overloaded for command lines that know this already.
+
+    @param[in] tokens
+    The command line.
+
+    @param[in] pos
+    Position of the token.
+
+    @return
+    Returns the position at which the name of the option starts or zero (`0`).
+*/
+template<typename Tokens>
+int
+option_start(const Tokens& tokens, std::size_t pos)
+{
+    return is_option(tokens[pos]);
+}
+
+/*!
+    Tests whether a token is the terminator "`--`" that ends the options. Overloaded for
+    command lines that know this already.
+
+    @param[in] tokens
+    The command line.
+
+    @param[in] pos
+    Position of the token.
+
+    @return
+    Returns `true` if the token is exactly "`--`".
+*/
+template<typename Tokens>
+bool
+is_terminator(const Tokens& tokens, std::size_t pos)
+{
+    const arg_view& arg = tokens[pos];
+    return 2 == arg.size() && '-' == arg[0] && '-' == arg[1];
+}
+
+/*!
+    Finds the `=` that separates a long name from its value, as in `--name=value`.
+
+    @param[in] arg
+    The option switch.
+
+    @return
+    Returns the position of the first `=` in `arg` or `npos`.
+*/
+inline std::size_t
+find_equals(const arg_view& arg)
+{
+    const void* equals = arg.empty() ? 0 : std::memchr(arg.data(), '=', arg.size());
+    return 0 == equals ? npos : static_cast<const char*>(equals) - arg.data();
+}
+
+/*!
+    Finds the `=` of a token, see `find_equals`. Overloaded for command lines that know
+    this already.
+
+    @param[in] tokens
+    The command line.
+
+    @param[in] pos
+    Position of the token.
+
+    @return
+    Returns the position of the first `=` in the token or `npos`.
+*/
+template<typename Tokens>
+std::size_t
+equals_at(const Tokens& tokens, std::size_t pos)
+{
+    return find_equals(tokens[pos]);
+}
+
+/*!
+    Replaces a token by the value attached to its option switch, as in `-ofile` or
+    `--name=value`, for states that can present it, i.e. that provide
+    `attach(std::size_t pos, const arg_view& value)`. The value is a slice of the token,
+    nothing is copied.
+
+    @param[in,out] state
+    The findings of `dispatch`.
+
+    @param[in] pos
+    The position of the token.
+
+    @param[in] value
+    The part of the token that is the value.
+
+    @return
+    Returns `true` if the token has been replaced.
+*/
+template<typename State>
+auto
+attach_value(State& state, std::size_t pos, const arg_view& value, int)
+        -> decltype(state.attach(pos, value), bool())
+{
+    state.attach(pos, value);
+    return true;
+}
+
+/*!
+    Refuses attached values for states whose values can only be whole tokens.
+*/
+template<typename State>
+bool
+attach_value(State&, std::size_t, const arg_view&, long)
+{
+    return false;
+}
+
+/*!
+    Tests whether a state can present attached values, see `attach_value`.
+
+    @param[in] state
+    The findings of `dispatch`.
+
+    @return
+    Returns `true` if the state provides `attach(std::size_t pos, const arg_view& value)`.
+*/
+template<typename State>
+auto
+can_attach(State& state, int) -> decltype(state.attach(0, arg_view()), bool())
+{
+    return true;
+}
+
+/*!
+    States without `attach` only take values that are whole tokens.
+*/
+template<typename State>
+bool
+can_attach(State&, long)
+{
+    return false;
+}
+
+/*!
+    Reports an option switch that names no option to states that want to know, i.e. that
+    provide `unknown(std::size_t pos)`.
+
+    @param[in,out] state
+    The findings of `dispatch`.
+
+    @param[in] pos
+    The position of the option switch on the command line.
+*/
+template<typename State>
+auto
+report_unknown(State& state, std::size_t pos, int) -> decltype(state.unknown(pos))
+{
+    state.unknown(pos);
+}
+
+/*!
+    Ignores an unknown option switch for states that don't track them.
+*/
+template<typename State>
+void
+report_unknown(State&, std::size_t, long)
+{}
+
+/*!
+    Asks states that forward unknown options, i.e. that provide
+    `pass_through(std::size_t pos)`, whether the command line ends at an unknown option
+    switch.
+
+    @param[in,out] state
+    The findings of `dispatch`.
+
+    @param[in] pos
+    The position of the option switch on the command line.
+
+    @return
+    Returns `true` if the switch and all arguments behind it are left to the state.
+*/
+template<typename State>
+auto
+pass_through(State& state, std::size_t pos, int) -> decltype(state.pass_through(pos))
+{
+    return state.pass_through(pos);
+}
+
+/*!
+    Keeps parsing behind an unknown option switch for states that don't forward them.
+*/
+template<typename State>
+bool
+pass_through(State&, std::size_t, long)
+{
+    return false;
+}
+
+/*!
+    An option switch that names no option as a whole, taken apart by `split_switch`.
+*/
+struct switch_parts
+{
+    /*!
+        The number of options the switch names, zero (`0`) if it can't be taken apart.
+        `--name=value` names one, a cluster one per character behind its dash.
+    */
+    std::size_t count;
+
+    /*!
+        The last option named. For `--name=value` it may be `ambiguous`.
+    */
+    std::size_t last;
+
+    /*!
+        Position of the value attached to the last option in the switch or `npos`.
+    */
+    std::size_t value;
+};
+
+/*!
+    Takes apart an option switch that names no option as a whole, POSIX style:
+    `--name=value` attaches a value to a long option, `-abc` is a cluster of short
+    options. The first option of a cluster that takes values ends it, the rest of the
+    switch is its first value as in `-ofile`. A cluster is only taken apart if all its
+    names are known, so a misspelled long name like `-verbose` isn't mistaken for
+    `-v -e ...`. These rules are shared by everything that interprets command lines, so
+    they agree on what a switch means.
+
+    @param[in] table
+    The options, see `dispatch`.
+
+    @param[in] arg
+    The option switch.
+
+    @param[in] start
+    The length of the option switch, see `is_option`.
+
+    @param[in] equals
+    The position of the first `=` in `arg` or `npos`, see `equals_at`.
+
+    @return
+    Returns the options named and where the attached value is, no options if `arg`
+    can't be taken apart.
+*/
+template<typename Table>
+switch_parts
+split_switch(const Table& table, const arg_view& arg, int start, std::size_t equals)
+{
+    switch_parts parts = {0, npos, npos};
+    if (2 == start) {
+        if (npos != equals && 2 != equals) {
+            parts.last = find_switch(table, arg.sub(2, equals - 2), 2, 0);
+            if (npos != parts.last) {
+                parts.count = 1;
+                parts.value = equals + 1;
+            }
+        }
+        return parts;
+    }
+
+    std::size_t end = 1;
+    while (end < arg.size()) {
+        std::size_t ordinal = find_switch(table, arg.sub(end, 1), 1, 0);
+        if (npos == ordinal) {
+            parts.last = npos;
+            return parts;
+        }
+        parts.last = ordinal;
+        end++;
+        if (value_constraint_e no_values != table.constraint(ordinal)) {
+            break;
+        }
+    }
+
+    parts.count = end - 1;
+    parts.value = end < arg.size() ? end : npos;
+    return parts;
+}
+
+/*!
+    Takes apart an option switch, finding its `=` first, see `split_switch`.
+*/
+template<typename Table>
+switch_parts
+split_switch(const Table& table, const arg_view& arg, int start)
+{
+    return split_switch(table, arg, start, 2 == start ? find_equals(arg) : npos);
+}
+
+/*!
+    @param[in] table
+    The options.
+
+    @param[in] arg
+    An option switch taken apart by `split_switch`.
+
+    @param[in] parts
+    Its parts.
+
+    @param[in] n
+    Which of the options it names, less than `parts.count`.
+
+    @return
+    Returns the ordinal of the option.
+*/
+template<typename Table>
+std::size_t
+switch_option(const Table& table, const arg_view& arg, const switch_parts& parts,
+              std::size_t n)
+{
+    return n + 1 == parts.count ? parts.last
+                                : find_switch(table, arg.sub(1 + n, 1), 1, 0);
+}
+
+/*!
+    Read values from the command line until another option is found or the number of
+    values to read is reached.
+
+    @param[in] tokens
+    The command line. Needs `size()` and `operator[]` returning a `loot::clp::arg_view`.
+
+    @param[in] start
+    The index of the option in `tokens`. Reading starts with the argument right behind
+    it.
+
+    @param[in] count
+    The number of values that shall/can be read.
+
+    @return
+    Return the number of values that have been read. The values themselves are the
+    entries of `tokens` behind `start`.
+*/
+template<typename Tokens>
+std::size_t
+read(const Tokens& tokens, std::size_t start, std::size_t count)
+{
+    // Counter starts at zero for easily counting the number of arguments read. To start
+    // with the first value after the option we have to add start to get to the option
+    // itself and one to jump to the first value behind that option.
+    std::size_t available = tokens.size() - start - 1;
+    if (count > available) {
+        count = available;
+    }
+
+    for (std::size_t c = 0; c < count; c++) {
+        if (option_start(tokens, c + 1 + start)) {
+            return c;
+        }
+    }
+
+    // If an option interrupts the reading the number read up until the option is returned
+    // in the loop. count always states that as many values have been read as were allowed
+    // to be read. The real meaning of the return value is interpreted by the caller.
+    return count;
+}
+
+/*!
+    Records an option and reads its values, see `dispatch`.
+
+    @param[in] tokens
+    The command line.
+
+    @param[in] table
+    The options.
+
+    @param[in,out] state
+    Receives the findings.
+
+    @param[in] ordinal
+    The option, it must not have been found before.
+
+    @param[in] c
+    The position of the option switch in `tokens`.
+
+    @param[in] attached
+    `true` if the token at `c` has been replaced by the first value, see
+    `attach_value`.
+
+    @return
+    Returns the position of the next token behind the values.
+*/
+template<typename Tokens, typename Table, typename State>
+std::size_t
+take(const Tokens& tokens,
+     const Table&  table,
+     State&        state,
+     std::size_t   ordinal,
+     std::size_t   c,
+     bool          attached)
+{
+    value_constraint constraint = table.constraint(ordinal);
+    if (value_constraint_e no_values == constraint) {
+        state.occur(ordinal, c + 1, 0);
+        return c + 1; // Finding the option is enough.
+    }
+
+    // Read all values according to the configuration. Unlimited is the amount of args
+    // on the command line minus the position of the current option. An attached value
+    // is the first of them, it is followed by the rest.
+    std::size_t expected = table.num_expected_values(ordinal);
+    std::size_t count    = value_constraint_e unlimited_num_values == constraint
+            ? tokens.size() - c - 1
+            : attached && 0 != expected ? expected - 1 : expected;
+    count = read(tokens, c, count);
+    if (attached) {
+        state.occur(ordinal, c, count + 1);
+    }
+    else {
+        state.occur(ordinal, c + 1, count);
+    }
+
+    // Continue behind the values; The next argument is either an option or a value
+    // exceeding the number of values allowed.
+    return c + 1 + count;
+}
+
+/*!
+    Dispatches an option switch that names no option as a whole, see `dispatch` and
+    `split_switch`. If an attached value belongs to an option that takes values, the
+    switch is only dispatched if the state can present the value, see `can_attach`;
+    This is checked before anything is recorded.
+
+    @param[in] parts
+    The switch at `c` taken apart.
+
+    @return
+    Returns the position of the next token to look at, or `c` if the switch remains
+    unknown.
+*/
+template<typename Tokens, typename Table, typename State>
+std::size_t
+take_switch(const Tokens&       tokens,
+            const Table&        table,
+            State&              state,
+            std::size_t         c,
+            const switch_parts& parts)
+{
+    if (0 == parts.count) {
+        return c;
+    }
+    if (0 != (parts.last & ambiguous)) {
+        state.fail(parts.last & ~ambiguous, requirement_error_e ambiguous_option_error);
+        return c + 1;
+    }
+
+    bool attached = npos != parts.value
+            && value_constraint_e no_values != table.constraint(parts.last);
+    if (attached && !can_attach(state, 0)) {
+        return c;
+    }
+
+    for (std::size_t n = 0; n < parts.count; n++) {
+        std::size_t ordinal = switch_option(table, tokens[c], parts, n);
+        if (state.found(ordinal)) {
+            continue;
+        }
+        if (value_constraint_e no_values != table.constraint(ordinal)) {
+            if (attached) {
+                attach_value(state, c, tokens[c].sub(parts.value), 0);
+            }
+            return take(tokens, table, state, ordinal, c, attached);
+        }
+
+        state.occur(ordinal, c + 1, 0);
+        if (npos != parts.value && !attached) {
+            // `--name=value` of an option without values. The option counts as found,
+            // like one with wrong values, so repetitions are skipped and the error is
+            // reported once.
+            state.fail(ordinal, requirement_error_e unexpected_value_error);
+        }
+    }
+
+    return c + 1;
+}
+
+/*!
+    Walks the command line exactly once and dispatches every option switch to its
+    option. Only the first occurrence of an option is evaluated, repetitions and their
+    values are skipped, as are values that aren't claimed by any option.
+
+    Switches that name no option as a whole are taken apart POSIX style: `--name=value`
+    attaches a value to a long option, `-abc` is a cluster of short options and `-ofile`
+    attaches a value to a short one, see `split_switch`. Attached values are slices of
+    their token and only supported by states that can present them, see `attach_value`;
+    For all others such switches remain unknown.
+
+    The terminator `--` ends the options, everything behind it is left alone. So does an
+    unknown option switch if the state passes it through, see `pass_through`.
+
+    @param[in] tokens
+    The command line including the application name. Needs `size()` and `operator[]`
+    returning a `loot::clp::arg_view`.
+
+    @param[in] table
+    The options. Needs `find(const arg_view&)` returning the ordinal of the option with
+    that name or `npos`, see `find_switch`, `constraint(std::size_t)` and
+    `num_expected_values(std::size_t)`.
+
+    @param[in,out] state
+    Receives the findings. Needs `found(std::size_t)` telling whether the option has been
+    seen already, `occur(std::size_t ordinal, std::size_t first, std::size_t count)`
+    to record an option with the position of its first value and the number of values
+    and, for tables resolving abbreviations, `fail(std::size_t, requirement_error)`.
+    Unknown option switches are passed to `unknown(std::size_t)` if `state` has it.
+
+    @return
+    Returns the position of the `--` or of the unknown option switch that ended the
+    options, or the size of `tokens` if the options run to the end.
+*/
+template<typename Tokens, typename Table, typename State>
+std::size_t
+dispatch(const Tokens& tokens, const Table& table, State& state)
+{
+    // Skip the application name => c = 1
+    std::size_t c = 1;
+    while (c < tokens.size()) {
+        int start = option_start(tokens, c);
+        if (0 == start) {
+            c++;
+            continue; // A value that isn't claimed by any option.
+        }
+
+        if (is_terminator(tokens, c)) {
+            return c;
+        }
+
+        // Found an option; Do we know it?
+        arg_view    name    = tokens[c].sub(start);
+        std::size_t ordinal = find_switch(table, name, start, 0);
+        if (npos != ordinal && 0 != (ordinal & ambiguous)) {
+            state.fail(ordinal & ~ambiguous, requirement_error_e ambiguous_option_error);
+            c++;
+            continue; // Its values are left unclaimed.
+        }
+        if (npos == ordinal && !name.empty()) {
+            std::size_t next = take_switch(tokens, table, state, c, split_switch(
+                    table, tokens[c], start, 2 == start ? equals_at(tokens, c) : npos));
+            if (next != c) {
+                c = next;
+                continue;
+            }
+            if (pass_through(state, c, 0)) {
+                return c;
+            }
+            report_unknown(state, c, 0);
+        }
+        if (npos == ordinal || state.found(ordinal)) {
+            c++;
+            continue;
+        }
+
+        // ...sure we know that option!
+        c = take(tokens, table, state, ordinal, c, false);
+    }
+
+    return tokens.size();
+}
+
+/*!
+    Checks whether an option got the right number of values.
+
+    @param[in] constraint
+    The value constraint of the option.
+
+    @param[in] num_expected_values
+    The number of values the option expects, if the constraint needs one.
+
+    @param[in] count
+    The number of values found.
+
+    @param[out] reason
+    Receives the error if the values don't meet the constraint.
+
+    @return
+    Returns `true` if the values are fine or `false` otherwise.
+*/
+inline bool
+check_values(value_constraint   constraint,
+             std::size_t        num_expected_values,
+             std::size_t        count,
+             requirement_error& reason)
+{
+    switch (constraint) {
+        case value_constraint_e no_values:
+            return true;
+
+        case value_constraint_e exact_num_values:
+            reason = requirement_error_e not_enough_values_error;
+            return count == num_expected_values;
+
+        case value_constraint_e up_to_num_values:
+        case value_constraint_e unlimited_num_values:
+            reason = requirement_error_e not_enough_values_error;
+            return 0 != count;
+
+        default:
+            reason = requirement_error_e invalid_value_constraint_error;
+            return false;
+    }
+}
+
+/*!
+    Checks the requirements of all options after `dispatch`. Errors with the values are
+    reported first, then missing mandatory options, each in the order of the options.
+
+    @param[in] table
+    The options. Needs `size()`, `has_names(std::size_t)`, `type(std::size_t)`,
+    `constraint(std::size_t)` and `num_expected_values(std::size_t)`.
+
+    @param[in,out] state
+    The findings of `dispatch`. Needs `found(std::size_t)`, `count(std::size_t)`,
+    `convert(std::size_t ordinal, requirement_error& reason)` to convert the values of an
+    option that has the right number of them, returning `false` if a value can't be
+    converted, and `fail(std::size_t ordinal, requirement_error reason)` to record an
+    error.
+*/
+template<typename Table, typename State>
+void
+validate(const Table& table, State& state)
+{
+    for (std::size_t o = 0; o < table.size(); o++) {
+        if (!table.has_names(o)) {
+            state.fail(o, requirement_error_e option_has_no_names_error);
+        }
+
+        requirement_error reason;
+        if (state.found(o) && !(check_values(table.constraint(o),
+                                             table.num_expected_values(o),
+                                             state.count(o),
+                                             reason)
+                                && state.convert(o, reason))) {
+            state.fail(o, reason);
+        }
+    }
+
+    // The value requirements are checked, now the option requirements.
+    for (std::size_t o = 0; o < table.size(); o++) {
+        if (option_type_e mandatory_option == table.type(o) && !state.found(o)) {
+            state.fail(o, requirement_error_e option_not_found_error);
+        }
+    }
+}
+
+
+} // namespace detail
+} // namespace clp
+} // namespace loot
+
+#endif // ENGINE_H
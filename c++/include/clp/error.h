@@ -116,6 +116,25 @@ public:
 };
 
 
+/*!
+    Lightweight counterpart of `loot::clp::error`. Instead of holding a copy of the option
+    that failed it refers to the option inside the `loot::clp::schema` that parsed the
+    command line.
+*/
+struct error_ref
+{
+    /*!
+        The option for which the requirements are not met. Owned by the schema.
+    */
+    const option* opt;
+
+    /*!
+        Reason why the option failed the validation test.
+    */
+    requirement_error reason;
+};
+
+
 } // namespace clp
 } // namespace loot
 
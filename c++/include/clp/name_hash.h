@@ -0,0 +1,103 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+/*!
+    \file
+    FNV-1a hashing of option names, usable at compile time and at runtime with the same
+    results.
+*/
+
+#ifndef NAME_HASH_H
+#define NAME_HASH_H
+
+#include "../config.h"
+#include "arg_view.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace loot {
+namespace clp {
+namespace detail {
+
+
+const std::uint64_t fnv_offset_basis = 14695981039346656037ull;
+const std::uint64_t fnv_prime        = 1099511628211ull;
+
+/*!
+    Hashes a `'\0'` terminated name at compile time.
+
+    @param[in] name
+    The name to hash.
+
+    @param[in] hash
+    The hash of the characters before `name`, leave the default for a whole name.
+
+    @return
+    Returns the FNV-1a hash of `name`.
+*/
+#ifdef HAS_CXX11_CONSTEXPR
+constexpr
+#else
+inline
+#endif
+std::uint64_t
+hash_name(const char* name, std::uint64_t hash = fnv_offset_basis)
+{
+    return '\0' == *name
+            ? hash
+            : hash_name(name + 1, (hash ^ static_cast<unsigned char>(*name)) * fnv_prime);
+}
+
+/*!
+    Hashes a name at runtime.
+
+    @param[in] name
+    The name to hash.
+
+    @return
+    Returns the FNV-1a hash of `name`, the same value `hash_name(const char*)` returns for
+    the same characters.
+*/
+inline std::uint64_t
+hash_name(const arg_view& name)
+{
+    std::uint64_t hash = fnv_offset_basis;
+    for (std::size_t c = 0; c < name.size(); c++) {
+        hash = (hash ^ static_cast<unsigned char>(name[c])) * fnv_prime;
+    }
+    return hash;
+}
+
+
+} // namespace detail
+} // namespace clp
+} // namespace loot
+
+#endif // NAME_HASH_H
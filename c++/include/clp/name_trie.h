@@ -0,0 +1,161 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+/*!
+    \file
+    An array-encoded trie over the names of options, used to resolve unique prefixes of
+    long names like GNU `getopt_long` does.
+*/
+
+#ifndef NAME_TRIE_H
+#define NAME_TRIE_H
+
+#include "../config.h"
+#include "arg_view.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace loot {
+namespace clp {
+namespace detail {
+
+
+/*!
+    A trie over short and long names that finds an option by its exact name or by a
+    prefix of exactly one long name. Nodes and edges live in flat arrays, the edges of a
+    node are contiguous and sorted by their character, so a lookup touches one node per
+    character of the name regardless of the number of options.
+*/
+class LOOT_LIB_EXPORT name_trie
+{
+public:
+    /*!
+        Result of `find`.
+    */
+    enum match
+    {
+        no_match,
+        exact_match,
+        prefix_match,
+        ambiguous_match
+    };
+
+    /*!
+        Builds the trie.
+
+        @param[in] short_names
+        The short name of every option by its ordinal, empty for none.
+
+        @param[in] long_names
+        The long name of every option by its ordinal, empty for none. Only long names
+        can be abbreviated.
+    */
+    void build(const std::vector<std::string>& short_names,
+               const std::vector<std::string>& long_names);
+
+    /*!
+        Finds an option.
+
+        @param[in] name
+        The name without the option switch.
+
+        @param[in] abbreviate
+        Whether `name` may be a prefix of a long name.
+
+        @param[out] ordinal
+        Receives the option for an exact or prefix match, or the first of the options
+        whose long names start with `name` for an ambiguous one.
+
+        @return
+        Returns how `name` matched. Exact matches take precedence over prefixes.
+    */
+    match find(const arg_view& name, bool abbreviate, std::size_t& ordinal) const;
+
+    /*!
+        @return
+        Returns `true` if `build` hasn't been called or there were no names.
+    */
+    bool empty() const;
+
+private:
+    static const std::uint32_t none = 0xFFFFFFFFu;
+
+    /*!
+        A node of the trie, i.e. a prefix of one or more names. `first_prefixed` is the
+        lowest ordinal and `num_prefixed` the number of long names starting with it.
+    */
+    struct node
+    {
+        std::uint32_t first_edge;
+        std::uint32_t num_edges;
+        std::uint32_t exact;
+        std::uint32_t first_prefixed;
+        std::uint32_t num_prefixed;
+    };
+
+    /*!
+        A name and whether it is a long one, while building.
+    */
+    struct entry
+    {
+        const std::string* name;
+        std::uint32_t      ordinal;
+        bool               is_long;
+    };
+
+    /*!
+        Adds the node for the names in `[first, last)`, which share their first `depth`
+        characters, and below it the nodes for longer prefixes.
+    */
+    std::uint32_t add(const std::vector<entry>& sorted,
+                      std::size_t               first,
+                      std::size_t               last,
+                      std::size_t               depth);
+
+    /*!
+        The nodes, the root first.
+    */
+    std::vector<node> nodes;
+
+    /*!
+        The character and the target node of each edge.
+    */
+    std::vector<char>          labels;
+    std::vector<std::uint32_t> targets;
+};
+
+
+} // namespace detail
+} // namespace clp
+} // namespace loot
+
+#endif // NAME_TRIE_H
@@ -33,7 +33,11 @@
 #include "../config.h"
 #include "args.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace loot {
 namespace clp {
@@ -57,6 +61,7 @@ public:
         - No short and long name
         - Unlimited number of values expected
         - Option is not mandatory
+        - Values are not converted
 
         Not specifying any name afterwards will result in
         `loot::clp::option_has_no_names_error`.
@@ -218,6 +223,71 @@ public:
     */
     std::string description;
 
+    /*!
+        Defines into what the values are converted while parsing, see
+        `loot::clp::result::values_as`. A value that can't be converted fails the
+        validation.
+    */
+    value_type conversion;
+
+    /*!
+        The names a `loot::clp::enum_value` option accepts as values and the numbers they
+        are converted into. Ignored for any other `conversion`.
+    */
+    std::vector<std::pair<std::string, std::int64_t>> choices;
+
+    /*!
+        Separates the integers in the values of a `loot::clp::integer_list_value` option.
+        Ignored for any other `conversion`.
+    */
+    char delimiter;
+
+};
+
+/*!
+    Refers to an option added to a `loot::clp::parser`, see
+    `loot::clp::parser::add_option`. Querying a result by handle is a plain array access
+    instead of a lookup by name.
+*/
+class option_handle
+{
+    friend class parser;
+public:
+    /*!
+        Create a handle that refers to no option.
+    */
+    option_handle()
+        : pos(static_cast<std::size_t>(-1))
+    {}
+
+    /*!
+        @return
+        Returns `true` if the handle refers to an option or `false` if the option it was
+        created for has been rejected.
+    */
+    bool valid() const { return static_cast<std::size_t>(-1) != pos; }
+
+    /*!
+        Tests the handle like the `bool` that `loot::clp::parser::add_option` used to
+        return, e.g. `if (p.add_option(o))`.
+
+        @return
+        Returns `valid()`.
+    */
+    explicit operator bool() const { return valid(); }
+
+    /*!
+        @return
+        Returns the position at which the option was added to its parser.
+    */
+    std::size_t position() const { return pos; }
+
+private:
+    explicit option_handle(std::size_t pos)
+        : pos(pos)
+    {}
+
+    std::size_t pos;
 };
 
 } // namespace clp
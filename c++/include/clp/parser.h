@@ -31,12 +31,16 @@
 #define PARSER_H
 
 #include "../config.h"
+#include "arg_view.h"
 #include "option.h"
 #include "result.h"
+#include "schema.h"
 
-#include <map>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
-#include <utility>
 #include <ostream>
 #include <initializer_list>
 
@@ -46,11 +50,11 @@ namespace clp {
 
 /*!
     Performs the task of parsing the command line while looking for any of the options
-    specified.
+    specified. The parser collects the options; the parsing itself is done by a
+    `loot::clp::schema` created from them, see `freeze()`.
 */
 class LOOT_LIB_EXPORT parser
 {
-    typedef std::map<option, std::pair<std::vector<std::string>, bool>> opt_map;
 public:
     /*!
         Creates an new `loot::clp::parser` with no associated `loot::clp::option` instances.
@@ -78,9 +82,11 @@ public:
         is already bound to another option the new value is ignored.
 
         @return
-        Returns `true` if the option is added or `false` otherwise.
+        Returns a handle to query results for the option, see `has(option_handle)` and
+        `loot::clp::result::has(option_handle)`. It is not `valid()` if the option was
+        ignored.
     */
-    bool add_option(const option& opt);
+    option_handle add_option(const option& opt);
 
     /*!
         Add an `loot::clp::option` for validation and, in case values are expected, to have
@@ -92,9 +98,49 @@ public:
         is already bound to another option the new value is ignored.
 
         @return
-        Returns `true` if the option is added or `false` otherwise.
+        Returns a handle to query results for the option. It is not `valid()` if the
+        option was ignored.
     */
-    bool add_option(option&& temp);
+    option_handle add_option(option&& temp);
+
+    /*!
+        Replace arguments of the form `@path` by the arguments in the response file at
+        `path`, see `loot::clp::response_file`. Off by default.
+
+        @param[in] enable
+        `true` to expand response files, `false` to take `@path` literally.
+    */
+    void expand_response_files(bool enable);
+
+    /*!
+        Accept unique prefixes of long names after "`--`", like GNU `getopt_long` does,
+        see `loot::clp::schema::allows_abbreviations()`. Off by default.
+
+        @param[in] enable
+        `true` to accept abbreviations, `false` to require exact names.
+    */
+    void allow_abbreviations(bool enable);
+
+    /*!
+        End the options at the first option switch that names no option and forward it
+        with all arguments behind it, like the arguments behind "`--`", see
+        `loot::clp::schema::passes_through_unknown()`. Off by default.
+
+        @param[in] enable
+        `true` to forward unknown options, `false` to skip them.
+    */
+    void pass_through_unknown(bool enable);
+
+    /*!
+        Creates the immutable `loot::clp::schema` of the options added so far. The schema
+        is only rebuilt if options have been added or settings changed since the last
+        call.
+
+        @return
+        Returns the schema. It can be shared with other threads and used for any number
+        of parses, even concurrently, independent of what happens to the parser.
+    */
+    std::shared_ptr<const schema> freeze() const;
 
     /*!
         Parses the command line with respect to `options`.
@@ -108,10 +154,55 @@ public:
 
         @return
         Returns a `loot::clp::result` which conveys whether the parsing finished with
-        success or if an error occurred.
+        success or if an error occurred. The parser keeps a copy of the result to answer
+        `has_option` and `values_from_option`. The result refers to the schema of the
+        parser and can be queried until the parser is destroyed or options are added
+        and the parser rebuilds its schema.
     */
     result parse(int argc, char* argv[]);
 
+    /*!
+        Parses the command line with respect to `options` and fills in the options it
+        doesn't set from other sources, see `loot::clp::schema::parse`. The parser keeps
+        a copy of the result like `parse(int, char**)` does.
+
+        @param[in] argc
+        The number of arguments that can be found on the command line.
+
+        @param[in] argv
+        Pointer to the first element of an array of character string pointers
+        which contains the whole command line.
+
+        @param[in] layers
+        The sources, in the order of their precedence.
+
+        @return
+        Returns the `loot::clp::result` of all sources.
+    */
+    result parse(int                                                 argc,
+                 char*                                               argv[],
+                 const std::vector<std::shared_ptr<const settings>>& layers);
+
+    /*!
+        Parses many command lines in parallel with respect to `options`. See
+        `loot::clp::schema::parse_batch`. Unlike `parse` the results are not retained by
+        the parser, query them directly. They stay valid under the same conditions as
+        the result of `parse` does.
+
+        @param[in] lines
+        The command lines to parse.
+
+        @param[in] num_threads
+        The number of threads to use, including the calling thread. Zero (`0`) uses as
+        many threads as the hardware supports.
+
+        @return
+        Returns one result per command line, in the order of `lines`.
+    */
+    std::vector<result> parse_batch(
+            const std::vector<command_line>& lines,
+            unsigned int                     num_threads = 0) const;
+
     /*!
         Query the parser for the values to a given option.
 
@@ -123,10 +214,26 @@ public:
         Returns a list of values (if any). The values are in the order as specified on the
         command line. If the option cannot be found, has no values or
         `loot::clp::parser::parse(int &, char **)` has not been called before, an empty
-        list is returned.
+        list is returned. The values are copied from the command line, which therefore
+        must still be valid.
     */
     std::vector<std::string> values_from_option(const std::string& name) const;
 
+    /*!
+        Query the parser for the values to a given option without copying them.
+
+        @param[in] name
+        Long or short name of the option for which values are queried (excluding the
+        option switch [e.g. "--"]).
+
+        @return
+        Returns a span of views that point directly into the `argv` array passed to
+        `loot::clp::parser::parse(int, char**)`. The span is valid until the next call
+        to `parse` and the views as long as `argv` is. The span is empty under the same
+        conditions `values_from_option` returns an empty list.
+    */
+    arg_span view_from_option(const std::string& name) const;
+
     /*!
         Query the parser whether an option was found on the command line.
 
@@ -137,6 +244,30 @@ public:
         Returns `true` if the option was found or `false` otherwise.
     */
     bool has_option(const std::string& name) const;
+
+    /*!
+        Query the parser whether an option was found on the command line by the last call
+        to `parse`.
+
+        @param[in] handle
+        The handle `add_option` returned for the option.
+
+        @return
+        Returns `true` if the option was found or `false` otherwise.
+    */
+    bool has(option_handle handle) const;
+
+    /*!
+        Query the parser for the values of an option found by the last call to `parse`
+        without copying them.
+
+        @param[in] handle
+        The handle `add_option` returned for the option.
+
+        @return
+        Returns the values, see `view_from_option`.
+    */
+    arg_span values(option_handle handle) const;
     
     /*!
         Print an abstract of the options added to the parser. This method is automatically
@@ -152,78 +283,53 @@ public:
     void print_help(std::ostream& out, bool newline) const;
 
 private:
-    /*!
-        Read values from the command line until another option is found or the number of
-        values to read is reached.
-
-        @param[in] start
-        The index at which to start reading from the arguments array.
-
-        @param[in] count
-        The number of values that shall/can be read.
-
-        @param[in] argv
-        The arguments array as passed to main(...).
-
-        @param[out]
-        The values that are read are stored in this list.
+    bool is_opt_known(const std::string& short_name, const std::string& long_name) const;
 
-        @return
-        Return the number of values that have been read. This value is never
-        negative.
+    /*!
+        Adds the names of the last option in `options` to `names`.
     */
-    unsigned int read(
-    		int   start,
-    		int   count,
-    		char* argv[],
-            std::vector<std::string> &values) const;
+    void index_last();
 
     /*!
-        Tests whether an argument is to be seen as an option.
-
-        @param[in] arg
-        The argument that shall be tested. It is interpreted as an option if it starts
-        with "`-`" or "`--`".
-
-        @return
-        If it is not an option zero (`0`) is returned. Otherwise the position at which the
-        actual name of the option starts (eluding the hyphen[s]). This value is either one
-        (`1`) or two (`2`).
+        The options in the order they have been added.
     */
-    int is_option(const std::string& arg) const;
+    std::vector<option> options;
 
     /*!
-        Find an option either by its short or long name.
-
-        @param[in] name
-        The name of the option without the option switch.
+        Every short and long name of `options` and the position of its option.
+    */
+    std::unordered_map<std::string, std::size_t> names;
 
-        @return
-        If the option was found on the command line a valid iterator is returned. If not
-        then the iterator will point to the end of the `opt_map`.
+    /*!
+        See `expand_response_files(bool)`.
     */
-    opt_map::const_iterator find_option(const std::string& name) const;
+    bool response_files = false;
 
-    /**
-        Reads all the values for the options provided and evaluates, whether the
-        requirement of that option, regarding the values, is met.
+    /*!
+        See `allow_abbreviations(bool)`.
+    */
+    bool abbreviations = false;
 
-        @param[in] argc
-        The number of arguments that can be found on the command line. after parsing is
-        done, this contains the number of remaining arguments.
+    /*!
+        See `pass_through_unknown(bool)`.
+    */
+    bool forward_unknown = false;
 
-        @param[in] argv
-        Pointer to the first element of an array of character string pointers which
-        contains the whole command line.
+    /*!
+        Cache of `freeze()`. Outdated if it holds less options than `options` or
+        different settings.
+    */
+    mutable std::shared_ptr<const schema> frozen;
 
-        @return
-        Returns a list of errors that came up while reading and evaluating values.
+    /*!
+        The schema `last` was parsed with. Keeps it alive even if `frozen` is rebuilt.
     */
-    result evaluate_values(int argc, char *argv[]);
-    
-    bool is_opt_known(const std::string& short_name, const std::string& long_name) const;
+    std::shared_ptr<const schema> parsed_with;
 
-    opt_map options;
+    /*!
+        Result of the last call to `parse`.
+    */
+    result last;
 
 };
 
@@ -0,0 +1,124 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef RESPONSE_FILE_H
+#define RESPONSE_FILE_H
+
+#include "../config.h"
+#include "arg_view.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace loot {
+namespace clp {
+
+
+/*!
+    The arguments stored in a response file, as referenced by `@path` on the command line.
+    Such files allow command lines longer than the operating system permits.
+
+    The file is mapped into memory and split in place, the arguments are views into the
+    mapping. If the file contains a `'\0'` character the arguments are separated by
+    `'\0'`, like the output of `find -print0` that `xargs -0` reads. Otherwise there is
+    one argument per line; Trailing carriage returns are removed and empty lines are
+    skipped. Arguments are taken literally, there is no quoting.
+
+    Only arguments separated by `'\0'` are terminated by `'\0'`, all others have to be
+    accessed through their size.
+*/
+class LOOT_LIB_EXPORT response_file
+{
+public:
+    /*!
+        Map a response file and split it into arguments.
+
+        @param[in] path
+        Path of the file.
+    */
+    explicit response_file(const std::string& path);
+
+    response_file(const response_file& other) = delete;
+    response_file& operator=(const response_file& other) = delete;
+
+    /*!
+        Unmaps the file. All views into it become invalid.
+    */
+    ~response_file();
+
+    /*!
+        @return
+        Returns `true` if the file could be read or `false` if it does not exist or is
+        not accessible.
+    */
+    bool is_open() const;
+
+    /*!
+        @return
+        Returns the arguments in the order of the file. The views point into the mapped
+        file and are valid as long as this instance exists.
+    */
+    arg_span arguments() const;
+
+private:
+    /*!
+        Splits `data` into `tokens`.
+    */
+    void split();
+
+    /*!
+        Start of the file contents, a null pointer if the file is empty or not open.
+    */
+    const char* data;
+    std::size_t size;
+
+    /*!
+        `true` if `data` is a memory mapping, `false` if it points into `buffer`.
+    */
+    bool mapped;
+    bool opened;
+
+    /*!
+        The file contents if memory mapping is not supported.
+    */
+    std::vector<char> buffer;
+
+    /*!
+        The arguments, pointing into `data`.
+    */
+    std::vector<arg_view> tokens;
+
+};
+
+
+} // namespace clp
+} // namespace loot
+
+#endif // RESPONSE_FILE_H
@@ -31,28 +31,49 @@
 #define RESULT_H
 
 #include "../config.h"
+#include "arena.h"
+#include "arg_view.h"
+#include "classify.h"
+#include "convert.h"
 #include "error.h"
+#include "response_file.h"
+#include "settings.h"
 
+#include <cstddef>
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace loot {
 namespace clp {
 
+class schema;
 
 /*!
     `loot::clp::result` is the result to a call of `loot::clp::parser::parse(int, char**)`.
     It resembles the result of the parsing and in case of errors it contains all the
     `sd:.args::option` instances that failed the validation and why they failed, thus
     client code can easily figure out which option(s) caused the error and provide quality
-    messages to users.
+    messages to users. It also holds which options have been found and their values. The
+    values are views into the parsed command line; the result stays valid as long as the
+    command line and the `loot::clp::schema` that produced it do. Values read from
+    response files point into the mapped files, which the result keeps open, as it keeps
+    the `loot::clp::settings` it was parsed with.
+
+    All state of a parse is kept in one `loot::clp::arena`. Usually the result owns it,
+    but a parse can also be directed into an arena provided by the caller, see
+    `loot::clp::schema::parse(int, char**, arena&)`. Such a result is only valid until
+    that arena is reset and only reports errors through `error_count()` and `error_at`.
 */
 class LOOT_LIB_EXPORT result
 {
+    friend class schema;
 public:
     /*!
         Contains all the errors and associated miserable options instances that failed
         validation for inspection by client code. The options are inside an instance
-        of `loot::clp::error` which also contains a reason for the error.
+        of `loot::clp::error` which also contains a reason for the error. Empty if the
+        result lives in an arena provided by the caller.
     */
     std::vector<error> errors;
 
@@ -110,6 +131,343 @@ public:
     */
     bool good() const;
 
+    /*!
+        @return
+        Returns the number of errors. Other than `errors.size()` this works no matter
+        where the result is stored.
+    */
+    std::size_t error_count() const;
+
+    /*!
+        Access an error without copying the option that caused it.
+
+        @param[in] pos
+        Position of the error, must be less than `error_count()`. Errors are in the same
+        order as in `errors`.
+
+        @return
+        Returns the error.
+    */
+    const error_ref& error_at(std::size_t pos) const;
+
+    /*!
+        @return
+        Returns the number of option switches on the command line that name no option.
+        They are skipped like values no option claims and don't make the parse fail.
+    */
+    std::size_t unknown_count() const;
+
+    /*!
+        Access an option switch that names no option.
+
+        @param[in] pos
+        Position of the switch among the unknown ones, must be less than
+        `unknown_count()`. They are in the order of the command line.
+
+        @return
+        Returns the argument as it was given, e.g. "`--verbsoe`".
+    */
+    arg_view unknown_at(std::size_t pos) const;
+
+    /*!
+        Find the names of the options that an unknown option switch most likely meant,
+        see `loot::clp::schema::suggest`.
+
+        @param[in] pos
+        Position of the switch among the unknown ones, must be less than
+        `unknown_count()`.
+
+        @param[in] max
+        The maximum number of names to return.
+
+        @return
+        Returns the names with their option switch, e.g. "`--verbose`", in the order of
+        the options.
+    */
+    std::vector<std::string> suggestions(std::size_t pos, std::size_t max = 3) const;
+
+    /*!
+        The arguments that are not for this command line but to be handed on, e.g. to a
+        child process: All arguments behind "`--`" or, if the schema passes unknown
+        options through, the first unknown option switch and all arguments behind it, see
+        `loot::clp::schema::passes_through_unknown()`. They aren't parsed at all.
+
+        @return
+        Returns the arguments as a span of the original `argv`. It runs to the end of
+        `argv`, so the null pointer at `argv[argc]` terminates it as `execv` requires;
+        An unknown option passed through takes a "`--`" behind it along. Empty if there
+        is nothing to hand on. Arguments behind a "`--`" inside a response file are
+        dropped, see `loot::clp::schema::parse`.
+    */
+    argv_span forwarded() const;
+
+    /*!
+        Query the result whether an option was found on the command line.
+
+        @param[in] name
+        Long or short name of the option (excluding the option switch [e.g. "-"]).
+
+        @return
+        Returns `true` if the option was found or `false` otherwise.
+    */
+    bool has_option(const std::string& name) const;
+
+    /*!
+        Query the result for the values to a given option.
+
+        @param[in] name
+        Long or short name of the option for which values are queried (excluding the
+        option switch [e.g. "--"]).
+
+        @return
+        Returns a copy of the values (if any) in the order as specified on the command
+        line. If the option cannot be found or has no values an empty list is returned.
+    */
+    std::vector<std::string> values_from_option(const std::string& name) const;
+
+    /*!
+        Query the result for the values to a given option without copying them.
+
+        @param[in] name
+        Long or short name of the option for which values are queried (excluding the
+        option switch [e.g. "--"]).
+
+        @return
+        Returns a span of views that point directly into the parsed command line. The
+        span is valid as long as the result is and empty under the same conditions
+        `values_from_option` returns an empty list.
+    */
+    arg_span view_from_option(const std::string& name) const;
+
+    /*!
+        Query the result whether an option was found on the command line.
+
+        @param[in] handle
+        The handle `loot::clp::parser::add_option` returned for the option.
+
+        @return
+        Returns `true` if the option was found or `false` otherwise, also if the handle
+        refers to no option of the schema.
+    */
+    bool has(option_handle handle) const;
+
+    /*!
+        Query the result for the values of an option without copying them.
+
+        @param[in] handle
+        The handle `loot::clp::parser::add_option` returned for the option.
+
+        @return
+        Returns the values, see `view_from_option`.
+    */
+    arg_span values(option_handle handle) const;
+
+    /*!
+        Query the result for the converted values of an option, see
+        `loot::clp::option::conversion`.
+
+        @param[in] handle
+        The handle `loot::clp::parser::add_option` returned for the option.
+
+        @return
+        Returns the values converted into `T`, which is `std::int64_t` for
+        `loot::clp::integer_value` and `loot::clp::enum_value` options, `double` for
+        `loot::clp::real_value` and `bool` for `loot::clp::boolean_value` options. The span
+        is empty if the option wasn't found, if its values aren't converted into `T` or if
+        they failed to convert.
+    */
+    template<typename T>
+    value_span<T> values_as(option_handle handle) const
+    {
+        return converted<T>(find_occurrence(handle));
+    }
+
+    /*!
+        Query the result for the converted values of an option, see
+        `values_as(option_handle)`.
+
+        @param[in] name
+        Long or short name of the option (excluding the option switch [e.g. "--"]).
+
+        @return
+        Returns the values converted into `T`.
+    */
+    template<typename T>
+    value_span<T> values_as(const std::string& name) const
+    {
+        return converted<T>(find_occurrence(name));
+    }
+
+private:
+    /*!
+        Where the values of an option are located in `tokens` and whether the option has
+        been found at all. `converted` points to `num_converted` converted values if the
+        option converts its values, see `loot::clp::option::conversion`, and they were
+        converted. That is one per value unless the values are lists.
+    */
+    struct occurrence
+    {
+        std::size_t first;
+        std::size_t count;
+        bool        found;
+        const void* converted;
+        std::size_t num_converted;
+    };
+
+    /*!
+        @return
+        Returns the `loot::clp::value_type` of the option of `occ`.
+    */
+    value_type conversion(const occurrence* occ) const;
+
+    /*!
+        Presents the converted values of an option as `T`.
+
+        @param[in] occ
+        The occurrence of the option or a null pointer.
+
+        @return
+        Returns the converted values or an empty span if there are none of type `T`.
+    */
+    template<typename T>
+    value_span<T> converted(const occurrence* occ) const
+    {
+        if (0 == occ || 0 == occ->converted
+                || !value_traits<T>::accepts(conversion(occ))) {
+            return value_span<T>();
+        }
+
+        return value_span<T>(static_cast<const T*>(occ->converted), occ->num_converted);
+    }
+
+    /*!
+        Looks up the occurrence of an option.
+
+        @param[in] name
+        Long or short name of the option.
+
+        @return
+        Returns the occurrence of the option if it was found or a null pointer otherwise.
+    */
+    const occurrence* find_occurrence(const std::string& name) const;
+
+    /*!
+        Looks up the occurrence of an option by handle.
+
+        @param[in] handle
+        The handle of the option.
+
+        @return
+        Returns the occurrence of the option if it was found or a null pointer otherwise.
+    */
+    const occurrence* find_occurrence(option_handle handle) const;
+
+    /*!
+        Allocates the arrays for a parse from `storage`. If that is `own`, it is replaced
+        by a new arena of the required size first.
+
+        @param[in] num_tokens
+        Number of arguments on the command line.
+
+        @param[in] num_options
+        Number of options of the schema.
+
+        @param[in] num_errors
+        Number of errors to reserve space for. More errors can be added anyway.
+
+        @param[in] num_converted_bytes
+        Number of bytes to reserve in `own` for converted values.
+    */
+    void prepare(std::size_t num_tokens,
+                 std::size_t num_options,
+                 std::size_t num_errors,
+                 std::size_t num_converted_bytes);
+
+    /*!
+        Records an error. Grows the array of errors inside `storage` if needed.
+
+        @param[in] opt
+        The option which caused the error.
+
+        @param[in] reason
+        Why the option failed validation.
+    */
+    void add_error(const option& opt, requirement_error reason);
+
+    /*!
+        Records an option switch that names no option. Grows the array of unknown
+        switches inside `storage` if needed.
+
+        @param[in] token
+        The position of the switch in `tokens`.
+    */
+    void add_unknown(std::size_t token);
+
+    /*!
+        The schema the command line was parsed with. A null pointer if nothing has been
+        parsed.
+    */
+    const schema* source;
+
+    /*!
+        Memory of the result unless the caller provided an arena.
+    */
+    arena own;
+
+    /*!
+        The arena all arrays below are allocated from, either `own` or the caller's.
+    */
+    arena* storage;
+
+    /*!
+        Views of the parsed arguments, in the order of the command line.
+    */
+    arg_view*   tokens;
+    std::size_t num_tokens;
+
+    /*!
+        The classification of every token, `num_tokens` entries.
+    */
+    detail::arg_info* infos;
+
+    /*!
+        One occurrence per option of `source`, in the order of the schema.
+    */
+    occurrence* occurrences;
+    std::size_t num_occurrences;
+
+    /*!
+        All errors in the order they were found.
+    */
+    error_ref*  records;
+    std::size_t num_records;
+    std::size_t max_records;
+
+    /*!
+        The positions in `tokens` of all option switches naming no option.
+    */
+    std::size_t* unknowns;
+    std::size_t  num_unknowns;
+    std::size_t  max_unknowns;
+
+    /*!
+        The response files that were expanded into `tokens`, in the order of the command
+        line, together with the position of their `@path` argument in `argv`. Shared by
+        copies of the result.
+    */
+    std::vector<std::pair<std::size_t, std::shared_ptr<const response_file>>> files;
+
+    /*!
+        The sources of options besides the command line whose settings are among
+        `tokens`. Shared by copies of the result.
+    */
+    std::vector<std::shared_ptr<const settings>> layers;
+
+    /*!
+        See `forwarded()`.
+    */
+    argv_span remainder;
+
 };
 
 
@@ -0,0 +1,532 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef SCHEMA_H
+#define SCHEMA_H
+
+#include "../config.h"
+#include "arena.h"
+#include "arg_view.h"
+#include "engine.h"
+#include "name_trie.h"
+#include "suggest.h"
+#include "option.h"
+#include "result.h"
+#include "settings.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace loot {
+namespace clp {
+
+
+/*!
+    One command line as passed to `main(...)`, used to hand many of them to
+    `loot::clp::schema::parse_batch`.
+*/
+struct command_line
+{
+    /*!
+        The number of arguments in `argv`.
+    */
+    int argc;
+
+    /*!
+        The arguments, including the application name.
+    */
+    char** argv;
+};
+
+/*!
+    A `loot::clp::schema` is the frozen set of options of a `loot::clp::parser`. It never
+    changes after it has been created, all state of a parse is kept in the
+    `loot::clp::result` that is returned. Therefore one schema can be shared by any number
+    of threads parsing concurrently without any locking. Instances are created by
+    `loot::clp::parser::freeze()`.
+*/
+class LOOT_LIB_EXPORT schema
+{
+    friend class parser;
+    friend class result;
+public:
+    /*!
+        Returned by `find` if a name is unknown.
+    */
+    static const std::size_t npos = detail::npos;
+
+    /*!
+        Copy-constructor.
+
+        @param[in] other
+        Source instance to copy values from.
+    */
+    schema(const schema& other);
+
+    /*!
+        Move-constructor.
+
+        @param[in] temp
+        Temporary instance to move values from.
+    */
+    schema(schema&& temp);
+
+    /*!
+        Assignment-operator.
+
+        @param[in] other
+        Source instance to copy values from.
+
+        @return
+        Returns the current instance that is now a copy of `other`.
+    */
+    schema& operator=(const schema& other);
+
+    /*!
+        Move-assignment-operator.
+
+        @param[in] temp
+        Temporary instance to move values from.
+
+        @return
+        Returns the current instance that is now a copy of `temp`.
+    */
+    schema& operator=(schema&& temp);
+
+    /*!
+        Parses the command line with respect to the options of the schema. This method
+        may be called concurrently.
+
+        @param[in] argc
+        The number of arguments that can be found on the command line.
+
+        @param[in] argv
+        Pointer to the first element of an array of character string pointers
+        which contains the whole command line.
+
+        @return
+        Returns a `loot::clp::result` which conveys whether the parsing finished with
+        success or if an error occurred and which options and values have been found. The
+        result refers to this schema and to `argv`, both have to outlive it. If response
+        files are expanded, see `expands_response_files()`, their arguments take the
+        place of the `@path` argument naming them. The arguments behind "`--`" are not
+        looked at, see `loot::clp::result::forwarded()`. A "`--`" inside a response file
+        ends the options, too, but the arguments of the file behind it are neither parsed
+        nor forwarded; Only the arguments behind "`--`" in `argv` can be forwarded.
+    */
+    result parse(int argc, char* argv[]) const;
+
+    /*!
+        Parses the command line with respect to the options of the schema and places the
+        complete state of the parse into an arena provided by the caller. Once the arena
+        is large enough no memory is allocated from the system, see
+        `loot::clp::arena::reset()`. This method may be called concurrently, but not with
+        the same arena.
+
+        @param[in] argc
+        The number of arguments that can be found on the command line.
+
+        @param[in] argv
+        Pointer to the first element of an array of character string pointers
+        which contains the whole command line.
+
+        @param[in] storage
+        The arena that receives the state of the parse.
+
+        @return
+        Returns a `loot::clp::result` that is valid until `storage` is reset or
+        destroyed. Its `errors` member stays empty, errors are reported by
+        `loot::clp::result::error_count()` and `loot::clp::result::error_at`.
+    */
+    result parse(int argc, char* argv[], arena& storage) const;
+
+    /*!
+        Parses the command line and fills in the options it doesn't set from other
+        sources, like a `loot::clp::config_file` or the `loot::clp::environment`. Each
+        option is taken from the command line if it is there, otherwise from the first
+        source in `layers` that sets it. Within a source, like on the command line, only
+        the first setting of an option counts. Keys that name no option are reported
+        like unknown option switches, see `loot::clp::result::unknown_at`. This method may
+        be called concurrently.
+
+        @param[in] argc
+        The number of arguments that can be found on the command line.
+
+        @param[in] argv
+        Pointer to the first element of an array of character string pointers
+        which contains the whole command line.
+
+        @param[in] layers
+        The sources, in the order of their precedence; E.g. the environment before the
+        configuration file. The result keeps them alive.
+
+        @return
+        Returns a `loot::clp::result` that presents the options of all sources the same
+        way, as if they were on the command line.
+    */
+    result parse(int                                                 argc,
+                 char*                                               argv[],
+                 const std::vector<std::shared_ptr<const settings>>& layers) const;
+
+    /*!
+        Parses many command lines in parallel. The command lines are distributed over a
+        pool of worker threads, idle workers steal work from busy ones. All workers share
+        this schema.
+
+        @param[in] lines
+        The command lines to parse.
+
+        @param[in] num_threads
+        The number of threads to use, including the calling thread. Zero (`0`) uses as
+        many threads as the hardware supports.
+
+        @return
+        Returns one result per command line, in the order of `lines`. The results are
+        exactly what `parse(int, char**)` would have returned.
+    */
+    std::vector<result> parse_batch(
+            const std::vector<command_line>& lines,
+            unsigned int                     num_threads = 0) const;
+
+    /*!
+        @return
+        Returns `true` if arguments of the form `@path` are replaced by the arguments in
+        the `loot::clp::response_file` at `path`. Arguments naming files that can't be
+        read are kept as they are, as are the arguments inside response files.
+    */
+    bool expands_response_files() const;
+
+    /*!
+        @return
+        Returns `true` if long names given after "`--`" may be abbreviated to any prefix
+        that is the start of no other long name, like `--verb` for `--verbose`. A prefix
+        of several long names is reported as a
+        `loot::clp::requirement_error::ambiguous_option_error`. Exact names always take
+        precedence.
+    */
+    bool allows_abbreviations() const;
+
+    /*!
+        @return
+        Returns `true` if the first option switch that names no option ends the options.
+        It is forwarded together with all arguments behind it, see
+        `loot::clp::result::forwarded()`. Switches inside response files are never
+        forwarded.
+    */
+    bool passes_through_unknown() const;
+
+    /*!
+        @return
+        Returns the number of options in the schema.
+    */
+    std::size_t size() const;
+
+    /*!
+        Access an option by its position in the schema. Options are ordered the same way
+        `loot::clp::option::operator<` orders them.
+
+        @param[in] ordinal
+        Position of the option, must be less than `size()`.
+
+        @return
+        Returns the option at that position.
+    */
+    const option& at(std::size_t ordinal) const;
+
+    /*!
+        Find an option either by its short or long name.
+
+        @param[in] name
+        The name of the option without the option switch.
+
+        @return
+        Returns the position of the option or `npos` if no option has that name.
+    */
+    std::size_t find(const arg_view& name) const;
+
+    /*!
+        Find an option by the name given after an option switch, resolving abbreviated
+        long names if the schema allows them, see `allows_abbreviations()`.
+
+        @param[in] name
+        The name of the option without the option switch.
+
+        @param[in] start
+        The length of the option switch, i.e. one (`1`) for "`-`" and two (`2`) for
+        "`--`". Only names after "`--`" are abbreviations.
+
+        @param[out] ambiguous
+        Set to `true` if `name` is the prefix of several long names, `false` otherwise.
+
+        @return
+        Returns the position of the option, of the first one `name` could mean if it is
+        ambiguous, or `npos` if `name` matches no option.
+    */
+    std::size_t find(const arg_view& name, int start, bool& ambiguous) const;
+
+    /*!
+        Find the names closest to a name that matches no option, for "did you mean"
+        messages. Names are compared by their edit distance, all names at the smallest
+        distance found are returned. The distance may be one (`1`) for names of two or
+        three characters and grows by one for every three characters more, up to four
+        (`4`).
+
+        @param[in] name
+        The misspelled name without the option switch.
+
+        @param[in] max
+        The maximum number of names to return.
+
+        @return
+        Returns the names with their option switch, e.g. "`--verbose`", in the order of
+        the options. Empty if no name is close enough.
+    */
+    std::vector<std::string> suggest(const arg_view& name, std::size_t max) const;
+
+    /*!
+        Find an option by the handle its parser returned for it.
+
+        @param[in] handle
+        The handle of the option.
+
+        @return
+        Returns the position of the option or `npos` if the handle refers to no option of
+        this schema.
+    */
+    std::size_t ordinal(option_handle handle) const;
+
+    /*!
+        Writes the schema into a binary image that `loot::clp::schema_image` uses in place,
+        without building anything. Throws `std::invalid_argument` if an option converts its
+        values, see `loot::clp::option::conversion`.
+
+        @return
+        Returns the image. It can be written to a file or be embedded into a program, it
+        is only valid on machines with the same byte order.
+    */
+    std::vector<char> serialize() const;
+
+    /*!
+        Print an abstract of the options of the schema.
+
+        @param[in] out
+        Output stream to write the help to.
+
+        @param[in] newline
+        Set to `true` to add a new line after each option creating more space between
+        them. Set to `false` to create a more condensed output.
+    */
+    void print_help(std::ostream& out, bool newline) const;
+
+    /*!
+        Presents the options of a schema to the parse engine, see
+        `loot::clp::detail::dispatch`. Also used by everything else that interprets
+        command lines with a schema, so they agree with `parse` on what a switch means.
+    */
+    class table;
+
+private:
+    class target;
+
+    /*!
+        Entry of the name index. Links one (short or long) name in `names` to the
+        position of its option. Free slots have the ordinal `npos`.
+    */
+    struct name_entry
+    {
+        std::uint64_t hash;
+        std::uint32_t offset;
+        std::uint32_t length;
+        std::size_t   ordinal;
+    };
+
+    /*!
+        Create a schema from a list of options, which must not contain duplicate names.
+
+        @param[in] options
+        The options in any order.
+
+        @param[in] response_files
+        Whether `@path` arguments are expanded, see `expands_response_files()`.
+
+        @param[in] abbreviations
+        Whether long names may be abbreviated, see `allows_abbreviations()`.
+
+        @param[in] pass_through
+        Whether unknown options are forwarded, see `passes_through_unknown()`.
+    */
+    explicit schema(const std::vector<option>& options,
+                    bool                       response_files = false,
+                    bool                       abbreviations  = false,
+                    bool                       pass_through   = false);
+
+    /*!
+        Builds the tables below `options` from `options`.
+    */
+    void build_tables();
+
+    /*!
+        Does the actual parsing for both public variants of `parse`.
+
+        @param[in] argc
+        The number of arguments that can be found on the command line.
+
+        @param[in] argv
+        The command line.
+
+        @param[in] layers
+        The sources of options not on the command line, may be empty.
+
+        @param[in,out] r
+        Receives the state of the parse, its storage has to be set up.
+    */
+    void parse(int                                                 argc,
+               char*                                               argv[],
+               const std::vector<std::shared_ptr<const settings>>& layers,
+               result&                                             r) const;
+
+    /*!
+        Records the options of `layers` that aren't set on the command line in `r`, after
+        the command line has been dispatched. The values are appended to the tokens of
+        `r`, which must have room for them.
+
+        @param[in] layers
+        The sources of options, in the order of their precedence.
+
+        @param[in,out] r
+        The result of the command line.
+    */
+    void merge(const std::vector<std::shared_ptr<const settings>>& layers,
+               result&                                             r) const;
+
+    /*!
+        The options, ordered by `loot::clp::option::operator<`. Only needed for `at`,
+        errors and the help text; Parsing works on the tables below.
+    */
+    std::vector<option> options;
+
+    /*!
+        What parsing needs of the options, one entry per option in the order of
+        `options`. `named` is zero for options without any name.
+    */
+    std::vector<option_type>      types;
+    std::vector<value_constraint> constraints;
+    std::vector<unsigned int>     num_expected_values;
+    std::vector<unsigned char>    named;
+    std::vector<value_type>       conversions;
+
+    /*!
+        Whether any option converts its values.
+    */
+    bool converts;
+
+    /*!
+        The position in `options` of every option by the position it was added to the
+        parser, see `loot::clp::option_handle`.
+    */
+    std::vector<std::size_t> ordinals;
+
+    /*!
+        All names of all options, one after the other without separators.
+    */
+    std::vector<char> names;
+
+    /*!
+        Hash table of all names in `names`, with linear probing. Its size is a power of
+        two and at least twice the number of names, so probe sequences stay short.
+    */
+    std::vector<name_entry> index;
+
+    /*!
+        Trie of all names, only built if abbreviations are allowed. Exact names are still
+        looked up in `index`, which is faster for them.
+    */
+    detail::name_trie trie;
+
+    /*!
+        The names bucketed for `suggest`.
+    */
+    detail::name_suggester suggester;
+
+    /*!
+        See `expands_response_files()`.
+    */
+    bool response_files;
+
+    /*!
+        See `allows_abbreviations()`.
+    */
+    bool abbreviations;
+
+    /*!
+        See `passes_through_unknown()`.
+    */
+    bool pass_through;
+
+};
+
+class schema::table
+{
+public:
+    explicit table(const schema& s)
+        : s(s)
+    {}
+
+    std::size_t size() const { return s.types.size(); }
+    std::size_t find(const arg_view& name) const { return s.find(name); }
+    bool has_names(std::size_t o) const { return 0 != s.named[o]; }
+
+    std::size_t find(const arg_view& name, int start) const
+    {
+        bool        ambiguous;
+        std::size_t ordinal = s.find(name, start, ambiguous);
+        return ambiguous ? ordinal | detail::ambiguous : ordinal;
+    }
+
+    option_type type(std::size_t o) const { return s.types[o]; }
+    value_constraint constraint(std::size_t o) const { return s.constraints[o]; }
+
+    std::size_t num_expected_values(std::size_t o) const
+    {
+        return s.num_expected_values[o];
+    }
+
+private:
+    const schema& s;
+};
+
+
+} // namespace clp
+} // namespace loot
+
+#endif // SCHEMA_H
@@ -0,0 +1,376 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef SCHEMA_IMAGE_H
+#define SCHEMA_IMAGE_H
+
+#include "../config.h"
+#include "arena.h"
+#include "arg_view.h"
+#include "engine.h"
+#include "option.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace loot {
+namespace clp {
+
+namespace detail {
+
+/*!
+    Layout of a schema image, see `loot::clp::schema::serialize()`. An image starts with
+    an `image_header`, followed by `num_options` `image_option`s, `index_size`
+    `image_entry`s, `num_ordinals` ordinals of 32 bits padded to a multiple of eight bytes
+    and finally `strings_size` characters. All offsets of strings are relative to the
+    start of the characters. Numbers are stored in the byte order of the machine that
+    wrote the image.
+*/
+struct image_header
+{
+    char          magic[8];
+    std::uint32_t byte_order;
+    std::uint32_t version;
+    std::uint32_t num_options;
+    std::uint32_t index_size;
+    std::uint32_t num_ordinals;
+    std::uint32_t strings_size;
+    std::uint64_t total_size;
+};
+
+/*!
+    One option of an image, in the order of the schema. `named` is zero for options
+    without any name.
+*/
+struct image_option
+{
+    std::uint32_t short_offset;
+    std::uint32_t short_length;
+    std::uint32_t long_offset;
+    std::uint32_t long_length;
+    std::uint32_t description_offset;
+    std::uint32_t description_length;
+    std::uint32_t num_expected_values;
+    std::uint8_t  type;
+    std::uint8_t  constraint;
+    std::uint8_t  named;
+    std::uint8_t  reserved;
+};
+
+/*!
+    One slot of the name index of an image, with linear probing like the index of
+    `loot::clp::schema`. Free slots have the ordinal `image_free_slot`.
+*/
+struct image_entry
+{
+    std::uint64_t hash;
+    std::uint32_t offset;
+    std::uint32_t length;
+    std::uint32_t ordinal;
+    std::uint32_t reserved;
+};
+
+const char          image_magic[8]      = {'L', 'O', 'O', 'T', 'C', 'L', 'P', '\0'};
+const std::uint32_t image_byte_order    = 0x01020304;
+const std::uint32_t image_version       = 1;
+const std::uint32_t image_free_slot     = 0xFFFFFFFF;
+
+/*!
+    @return
+    Returns `size` rounded up to a multiple of eight.
+*/
+inline std::size_t
+image_padded(std::size_t size)
+{
+    return (size + 7) & ~std::size_t(7);
+}
+
+} // namespace detail
+
+/*!
+    A validation error found by `loot::clp::schema_image::parse`.
+*/
+struct image_error
+{
+    /*!
+        Position of the option in the schema.
+    */
+    std::size_t ordinal;
+
+    /*!
+        Reason why the option failed the validation test.
+    */
+    requirement_error reason;
+};
+
+/*!
+    A `loot::clp::schema_image` parses command lines with a schema that has been written
+    into a binary image by `loot::clp::schema::serialize()` beforehand. The image contains
+    the options together with their name index and is used in place, nothing is copied
+    or built when an image is opened. That makes it the fastest way to get a parser
+    running in short-lived tools, where building a `loot::clp::parser` from many options
+    would take a noticeable share of the runtime. An image can be embedded into the
+    program as an array or be kept in a file that is mapped into memory.
+
+    Parsing follows the rules of `loot::clp::schema::parse`, with these differences:
+
+    - Values are whole arguments. Attached values like `-ofile` and `--name=value`, and
+      clusters that end in one like `-vofile`, are unknown option switches.
+    - Long names can't be abbreviated.
+    - Unknown options aren't passed through, and the arguments behind "`--`" aren't
+      kept.
+    - Response files aren't expanded.
+
+    Images can't hold options that convert their values, see
+    `loot::clp::option::conversion`.
+*/
+class LOOT_LIB_EXPORT schema_image
+{
+public:
+    /*!
+        Returned by `find` if a name is unknown.
+    */
+    static const std::size_t npos = detail::npos;
+
+    /*!
+        The result of `loot::clp::schema_image::parse`. All of its state is kept in the
+        arena passed to `parse`, it is valid until that arena is reset and refers to the
+        image and the parsed command line.
+    */
+    class LOOT_LIB_EXPORT result
+    {
+        friend class schema_image;
+    public:
+        result();
+
+        /*!
+            @return
+            Returns `true` if no violations were found or `false` if parsing found errors.
+        */
+        bool good() const;
+
+        /*!
+            @return
+            Returns the number of errors.
+        */
+        std::size_t error_count() const;
+
+        /*!
+            Access an error.
+
+            @param[in] pos
+            Position of the error, must be less than `error_count()`.
+
+            @return
+            Returns the error. Errors are in the same order as those of
+            `loot::clp::schema::parse`.
+        */
+        const image_error& error_at(std::size_t pos) const;
+
+        /*!
+            @param[in] ordinal
+            Position of the option in the image, see `loot::clp::schema_image::find`.
+
+            @return
+            Returns `true` if the option was found on the command line.
+        */
+        bool has(std::size_t ordinal) const;
+
+        /*!
+            @param[in] ordinal
+            Position of the option in the image.
+
+            @return
+            Returns the values of the option, an empty span if it has none or wasn't found.
+        */
+        argv_span values(std::size_t ordinal) const;
+
+    private:
+        struct occurrence
+        {
+            std::size_t first;
+            std::size_t count;
+            bool        found;
+        };
+
+        char* const* argv;
+        occurrence*  occurrences;
+        std::size_t  num_occurrences;
+        image_error* errors;
+        std::size_t  num_errors;
+    };
+
+    /*!
+        Use an image in memory, for example one embedded into the program. The image is
+        validated but not copied, it has to outlive this instance. Throws
+        `std::invalid_argument` if the memory does not hold a valid image written on a
+        machine with the same byte order.
+
+        @param[in] data
+        Start of the image. Must be aligned to eight bytes.
+
+        @param[in] size
+        Size of the image in bytes.
+    */
+    schema_image(const void* data, std::size_t size);
+
+    /*!
+        Map an image file into memory. Throws `std::invalid_argument` if the file can't be
+        read or does not hold a valid image.
+
+        @param[in] path
+        Path of the file.
+    */
+    explicit schema_image(const std::string& path);
+
+    schema_image(const schema_image& other) = delete;
+    schema_image& operator=(const schema_image& other) = delete;
+
+    /*!
+        Unmaps the file of the image, if there is one.
+    */
+    ~schema_image();
+
+    /*!
+        Parses the command line with respect to the options of the image and places the
+        state of the parse into `storage`. Once the arena is large enough no memory is
+        allocated. This method may be called concurrently, but not with the same arena.
+
+        @param[in] argc
+        The number of arguments that can be found on the command line.
+
+        @param[in] argv
+        Pointer to the first element of an array of character string pointers
+        which contains the whole command line.
+
+        @param[in] storage
+        The arena that receives the state of the parse.
+
+        @return
+        Returns the result, which refers to `argv`, this image and `storage`.
+    */
+    result parse(int argc, char* argv[], arena& storage) const;
+
+    /*!
+        @return
+        Returns the number of options in the image.
+    */
+    std::size_t size() const;
+
+    /*!
+        Find an option either by its short or long name.
+
+        @param[in] name
+        The name of the option without the option switch.
+
+        @return
+        Returns the position of the option or `npos` if no option has that name.
+    */
+    std::size_t find(const arg_view& name) const;
+
+    /*!
+        Find an option by the handle its parser returned for it.
+
+        @param[in] handle
+        The handle of the option.
+
+        @return
+        Returns the position of the option or `npos` if the handle refers to no option of
+        the image.
+    */
+    std::size_t ordinal(option_handle handle) const;
+
+    /*!
+        @param[in] ordinal
+        Position of the option, must be less than `size()`.
+
+        @return
+        Returns the short name of the option.
+    */
+    arg_view short_name(std::size_t ordinal) const;
+
+    /*!
+        @param[in] ordinal
+        Position of the option, must be less than `size()`.
+
+        @return
+        Returns the long name of the option.
+    */
+    arg_view long_name(std::size_t ordinal) const;
+
+    /*!
+        @param[in] ordinal
+        Position of the option, must be less than `size()`.
+
+        @return
+        Returns the description of the option.
+    */
+    arg_view description(std::size_t ordinal) const;
+
+private:
+    class table;
+    class target;
+
+    /*!
+        Sets up the pointers into the image at `data` and validates it. Throws
+        `std::invalid_argument` if the image is invalid.
+    */
+    void open(const void* data, std::size_t size);
+
+    /*!
+        The parts of the image.
+    */
+    const detail::image_option* options;
+    std::size_t                 num_options;
+    const detail::image_entry*  index;
+    std::size_t                 index_size;
+    const std::uint32_t*        ordinals;
+    std::size_t                 num_ordinals;
+    const char*                 strings;
+
+    /*!
+        The mapped file, if the image has been read from one.
+    */
+    const void* mapping;
+    std::size_t mapping_size;
+
+    /*!
+        The file contents if memory mapping is not supported.
+    */
+    std::vector<std::uint64_t> buffer;
+
+};
+
+
+} // namespace clp
+} // namespace loot
+
+#endif // SCHEMA_IMAGE_H
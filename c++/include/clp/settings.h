@@ -0,0 +1,185 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include "../config.h"
+#include "arg_view.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace loot {
+namespace clp {
+
+
+/*!
+    One option set outside of the command line: The name of the option without option
+    switch and its value, as given by a `loot::clp::settings` source.
+*/
+struct setting
+{
+    arg_view key;
+    arg_view value;
+};
+
+/*!
+    A source of options besides the command line, see `loot::clp::schema::parse`. Keys
+    are the long names of options, keys that are short names count as unknown. How a
+    value is read depends on the option:
+
+    - Options without values are set if the value is empty or a true boolean like
+      `true`, `yes`, `on` or `1`. A false boolean like `false` or `0` leaves them unset,
+      even if a source of lower precedence sets them.
+    - Options with exactly one value take the whole value, spaces included.
+    - All other options split the value at spaces and tabs into several values.
+*/
+class LOOT_LIB_EXPORT settings
+{
+public:
+    /*!
+        @return
+        Returns the settings in the order of the source. The views are valid as long as
+        this instance exists.
+    */
+    const std::vector<setting>& entries() const;
+
+protected:
+    settings() = default;
+    ~settings() = default;
+
+    std::vector<setting> items;
+
+};
+
+/*!
+    A configuration file of `key = value` lines, e.g.
+
+        # Comments start with '#' or ';'.
+        log-level = debug
+        include   = /usr/include /usr/local/include
+        verbose
+
+    Spaces around keys and values are removed, a value may be enclosed in double quotes
+    to keep them. A line without `=` sets the option of that name without a value. The
+    file is mapped into memory, the settings are views into the mapping.
+*/
+class LOOT_LIB_EXPORT config_file : public settings
+{
+public:
+    /*!
+        Map a configuration file and split it into settings.
+
+        @param[in] path
+        Path of the file.
+    */
+    explicit config_file(const std::string& path);
+
+    config_file(const config_file& other) = delete;
+    config_file& operator=(const config_file& other) = delete;
+
+    /*!
+        Unmaps the file. All views into it become invalid.
+    */
+    ~config_file();
+
+    /*!
+        @return
+        Returns `true` if the file could be read or `false` if it does not exist or is
+        not accessible.
+    */
+    bool is_open() const;
+
+private:
+    /*!
+        Splits `data` into `items`.
+    */
+    void split();
+
+    /*!
+        Start of the file contents, a null pointer if the file is empty or not open.
+    */
+    const char* data;
+    std::size_t size;
+
+    /*!
+        `true` if `data` is a memory mapping, `false` if it points into `buffer`.
+    */
+    bool mapped;
+    bool opened;
+
+    /*!
+        The file contents if memory mapping is not supported.
+    */
+    std::vector<char> buffer;
+
+};
+
+/*!
+    The environment variables that start with a prefix, e.g. `TOOL_` for `TOOL_LOG_LEVEL`.
+    The key of a variable is the rest of its name in lower case with underscores
+    replaced by dashes, `log-level` in the example.
+
+    The environment is read once when the instance is created, in a single pass over all
+    variables. Names and values are copied, later changes of the environment don't
+    affect the instance.
+*/
+class LOOT_LIB_EXPORT environment : public settings
+{
+public:
+    /*!
+        Collect the variables that start with `prefix`.
+
+        @param[in] prefix
+        The prefix, it is case sensitive.
+
+        @param[in] env
+        The variables as `NAME=value` strings, terminated by a null pointer. If it is a
+        null pointer the environment of the process is read.
+    */
+    explicit environment(const std::string& prefix, char* const* env = 0);
+
+    environment(const environment& other) = delete;
+    environment& operator=(const environment& other) = delete;
+
+private:
+    /*!
+        The keys and values, one after the other.
+    */
+    std::vector<char> text;
+
+};
+
+
+} // namespace clp
+} // namespace loot
+
+#endif // SETTINGS_H
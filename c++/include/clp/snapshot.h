@@ -0,0 +1,279 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "../config.h"
+#include "result.h"
+#include "schema.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace loot {
+namespace clp {
+
+
+/*!
+    An immutable, parsed command line that owns everything it refers to: A copy of the
+    arguments, the `loot::clp::result` of parsing them and the `loot::clp::schema` it was
+    parsed with. It can be read from any number of threads and outlive the original
+    `argv`, which makes it the unit that `loot::clp::snapshot_publisher` swaps.
+*/
+class LOOT_LIB_EXPORT snapshot : public std::enable_shared_from_this<snapshot>
+{
+public:
+    /*!
+        Copies a command line and parses the copy.
+
+        @param[in] options
+        The schema to parse with, see `loot::clp::parser::freeze()`.
+
+        @param[in] argc
+        The number of arguments that can be found on the command line.
+
+        @param[in] argv
+        The command line, including the application name. It isn't referred to
+        afterwards.
+
+        @return
+        Returns the snapshot.
+    */
+    static std::shared_ptr<const snapshot> create(std::shared_ptr<const schema> options,
+                                                  int                           argc,
+                                                  char*                         argv[]);
+
+    /*!
+        Copies a command line and parses the copy.
+
+        @param[in] options
+        The schema to parse with, see `loot::clp::parser::freeze()`.
+
+        @param[in] args
+        The command line, including the application name.
+
+        @return
+        Returns the snapshot.
+    */
+    static std::shared_ptr<const snapshot> create(std::shared_ptr<const schema>   options,
+                                                  const std::vector<std::string>& args);
+
+    /*!
+        @return
+        Returns the result of the parse, e.g. for `loot::clp::result::values_from_option`.
+        Its views refer to the snapshot.
+    */
+    const result& parsed() const;
+
+    /*!
+        @return
+        Returns the schema the command line was parsed with.
+    */
+    const schema& options() const;
+
+    /*!
+        @return
+        Returns the copy of the command line.
+    */
+    argv_span arguments() const;
+
+private:
+    snapshot(const snapshot&) = delete;
+    snapshot& operator=(const snapshot&) = delete;
+
+    /*!
+        Copies `args` into `text`, parsing happens in `create`.
+    */
+    snapshot(std::shared_ptr<const schema> options, const std::vector<std::string>& args);
+
+    std::shared_ptr<const schema> source;
+
+    /*!
+        The arguments, each terminated by `'\0'`, and pointers to them.
+    */
+    std::vector<char>  text;
+    std::vector<char*> argv;
+
+    result r;
+};
+
+
+/*!
+    Publishes the current `loot::clp::snapshot` of a service to its threads and replaces
+    it at runtime, read-copy-update style. Readers never block and never wait: Reading
+    takes two atomic loads and two atomic increments, see `read()`. `publish` swaps in a
+    new snapshot with one atomic store and then waits until all readers that might still
+    see the old one are done, before it drops its reference.
+
+    Readers are counted in two epochs like in sleepable RCU: Each reader registers in the
+    current epoch, `publish` switches to the other one and waits for the old one to
+    drain. It does so twice, so readers that registered in an epoch just before it was
+    switched are waited for, too.
+*/
+class LOOT_LIB_EXPORT snapshot_publisher
+{
+public:
+    /*!
+        Access to the current snapshot, held until the guard is destroyed. A guard is
+        meant to be short-lived and must stay on the thread that created it; Use
+        `acquire()` to keep a snapshot for longer.
+    */
+    class guard
+    {
+        friend class snapshot_publisher;
+    public:
+        /*!
+            Move-constructor.
+
+            @param[in] temp
+            Temporary guard to take over.
+        */
+        guard(guard&& temp);
+
+        /*!
+            Leaves the epoch the guard registered in.
+        */
+        ~guard();
+
+        /*!
+            @return
+            Returns the snapshot, which may be a null pointer if nothing has been
+            published yet.
+        */
+        const snapshot* get() const { return current; }
+
+        const snapshot* operator->() const { return current; }
+        const snapshot& operator*() const { return *current; }
+
+    private:
+        guard(const guard&) = delete;
+        guard& operator=(const guard&) = delete;
+
+        guard(std::atomic<std::size_t>* readers, const snapshot* current);
+
+        std::atomic<std::size_t>* readers;
+        const snapshot*           current;
+    };
+
+    /*!
+        Create a publisher.
+
+        @param[in] initial
+        The first snapshot, may be a null pointer.
+    */
+    explicit snapshot_publisher(std::shared_ptr<const snapshot> initial
+                                        = std::shared_ptr<const snapshot>());
+
+    /*!
+        Drops the current snapshot. No guards of the publisher may exist anymore.
+    */
+    ~snapshot_publisher();
+
+    /*!
+        Read the current snapshot. Wait-free, may be called from any number of threads.
+
+        @return
+        Returns a guard that keeps the snapshot alive while it exists.
+    */
+    guard read() const;
+
+    /*!
+        Take shared ownership of the current snapshot, to keep it beyond the lifetime of a
+        guard. Costs a little more than `read()`.
+
+        @return
+        Returns the snapshot or a null pointer if nothing has been published yet.
+    */
+    std::shared_ptr<const snapshot> acquire() const;
+
+    /*!
+        Replace the current snapshot. Readers see either the old or the new one; The old
+        one is released once all readers that may use it are done. Calls are serialized,
+        may be called from any thread but not while holding a guard of this publisher.
+
+        @param[in] next
+        The new snapshot, may be a null pointer.
+    */
+    void publish(std::shared_ptr<const snapshot> next);
+
+    /*!
+        @return
+        Returns the number of snapshots published, including the initial one.
+    */
+    std::size_t generation() const;
+
+private:
+    snapshot_publisher(const snapshot_publisher&) = delete;
+    snapshot_publisher& operator=(const snapshot_publisher&) = delete;
+
+    /*!
+        Switches the epoch and waits until the readers of the old one are done.
+    */
+    void flip();
+
+    /*!
+        The number of readers in each epoch, on separate cache lines.
+    */
+    struct epoch
+    {
+        std::atomic<std::size_t> readers;
+        char                     padding[64 - sizeof(std::atomic<std::size_t>)];
+    };
+
+    mutable epoch            epochs[2];
+    std::atomic<std::size_t> current_epoch;
+
+    /*!
+        What readers load. Owned by `owner`.
+    */
+    std::atomic<const snapshot*> current;
+
+    /*!
+        Keeps the current snapshot alive; Only used by `publish`.
+    */
+    std::shared_ptr<const snapshot> owner;
+
+    std::atomic<std::size_t> published;
+
+    /*!
+        Serializes `publish`.
+    */
+    std::mutex writer;
+};
+
+
+} // namespace clp
+} // namespace loot
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,607 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+/*!
+    \file
+    A variant of `loot::clp::schema` whose options are declared at compile time. Names
+    are checked for duplicates by the compiler and looked up by hashes computed by the
+    compiler; Nothing has to be built when the program starts. Only available if the
+    compiler supports `constexpr` and variadic templates.
+
+    Options are declared as types, most easily with `LOOT_CLP_STATIC_OPTION`:
+
+        LOOT_CLP_STATIC_OPTION(verbose, "v", "verbose", optional_option, no_values, 0,
+                               "Print more details");
+        LOOT_CLP_STATIC_OPTION(input, "i", "input", mandatory_option, exact_num_values, 1,
+                               "File to read");
+
+        typedef loot::clp::static_schema<verbose, input> cli;
+
+        cli::result r = cli::parse(argc, argv);
+        if (r.good() && r.has<verbose>()) {
+            std::cout << r.values<input>()[0] << std::endl;
+        }
+*/
+
+#ifndef STATIC_SCHEMA_H
+#define STATIC_SCHEMA_H
+
+#include "../config.h"
+#include "args.h"
+#include "arg_view.h"
+#include "engine.h"
+#include "name_hash.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(HAS_CXX11_CONSTEXPR) && defined(HAS_CXX11_VARIADIC_TEMPLATES)
+
+/*!
+    Declares a type that describes an option at compile time. The parameters correspond
+    to the ones of the constructor of `loot::clp::option`; `type` and `constraint` are
+    given without their enumeration (e.g. `mandatory_option`, `exact_num_values`).
+*/
+#define LOOT_CLP_STATIC_OPTION(name, short_name_, long_name_, type_, constraint_, \
+                               num_expected_values_, description_) \
+    struct name \
+    { \
+        static constexpr const char* short_name() { return short_name_; } \
+        static constexpr const char* long_name() { return long_name_; } \
+        static constexpr loot::clp::option_type type() \
+        { \
+            return loot::clp::option_type_e type_; \
+        } \
+        static constexpr loot::clp::value_constraint constraint() \
+        { \
+            return loot::clp::value_constraint_e constraint_; \
+        } \
+        static constexpr unsigned int num_expected_values() \
+        { \
+            return num_expected_values_; \
+        } \
+        static constexpr const char* description() { return description_; } \
+    }
+
+namespace loot {
+namespace clp {
+
+
+/*!
+    A validation error found by `loot::clp::static_schema::parse`.
+*/
+struct static_error
+{
+    /*!
+        Position of the option in the schema.
+    */
+    std::size_t ordinal;
+
+    /*!
+        Reason why the option failed the validation test.
+    */
+    requirement_error reason;
+};
+
+namespace detail {
+
+template<std::size_t... I>
+struct index_list
+{};
+
+template<typename First, typename Second>
+struct concat_index_lists;
+
+template<std::size_t... I, std::size_t... J>
+struct concat_index_lists<index_list<I...>, index_list<J...>>
+{
+    typedef index_list<I..., (sizeof...(I) + J)...> type;
+};
+
+/*!
+    `index_list<0, 1, ..., N - 1>`, built with logarithmic template recursion depth.
+*/
+template<std::size_t N>
+struct make_index_list
+{
+    typedef typename concat_index_lists<
+            typename make_index_list<N / 2>::type,
+            typename make_index_list<N - N / 2>::type>::type type;
+};
+
+template<>
+struct make_index_list<0>
+{
+    typedef index_list<> type;
+};
+
+template<>
+struct make_index_list<1>
+{
+    typedef index_list<0> type;
+};
+
+template<typename T, typename... Opts>
+struct index_of
+{
+    static_assert(sizeof...(Opts) != sizeof...(Opts), "Not an option of this schema");
+};
+
+template<typename T, typename... Rest>
+struct index_of<T, T, Rest...>
+{
+    static const std::size_t value = 0;
+};
+
+template<typename T, typename First, typename... Rest>
+struct index_of<T, First, Rest...>
+{
+    static const std::size_t value = 1 + index_of<T, Rest...>::value;
+};
+
+// The following functions are evaluated by the compiler. They split their ranges in
+// halves instead of walking them to keep the recursion depth logarithmic.
+
+constexpr bool
+static_empty(const char* str)
+{
+    return '\0' == *str;
+}
+
+constexpr std::size_t
+static_length(const char* str)
+{
+    return '\0' == *str ? 0 : 1 + static_length(str + 1);
+}
+
+// Number of entries in [lo, hi) ordered before entry i; Ties are ordered by position.
+constexpr std::size_t
+static_rank(const std::uint64_t* values, std::size_t i, std::size_t lo, std::size_t hi)
+{
+    return hi <= lo
+            ? 0
+            : 1 == hi - lo
+                    ? (values[lo] < values[i] || (values[lo] == values[i] && lo < i) ? 1 : 0)
+                    : static_rank(values, i, lo, lo + (hi - lo) / 2)
+                            + static_rank(values, i, lo + (hi - lo) / 2, hi);
+}
+
+// Whether the sorted values in [lo, hi) differ from their predecessors unless zero.
+constexpr bool
+static_distinct(const std::uint64_t* sorted, std::size_t lo, std::size_t hi)
+{
+    return hi <= lo
+            ? true
+            : 1 == hi - lo
+                    ? 0 == lo || 0 == sorted[lo] || sorted[lo - 1] != sorted[lo]
+                    : static_distinct(sorted, lo, lo + (hi - lo) / 2)
+                            && static_distinct(sorted, lo + (hi - lo) / 2, hi);
+}
+
+// The position of value k in [lo, hi), which must contain it exactly once.
+constexpr std::size_t
+static_position(const std::size_t* values, std::size_t k, std::size_t lo, std::size_t hi)
+{
+    return hi <= lo
+            ? 0
+            : 1 == hi - lo
+                    ? (values[lo] == k ? lo : 0)
+                    : static_position(values, k, lo, lo + (hi - lo) / 2)
+                            + static_position(values, k, lo + (hi - lo) / 2, hi);
+}
+
+constexpr std::uint64_t
+static_hash(const char* name)
+{
+    return static_empty(name) ? 0 : hash_name(name);
+}
+
+/*!
+    The options of a `loot::clp::static_schema` as arrays. Entry `n` of the name arrays
+    belongs to option `n % size`: the short names come first, then the long ones. Empty
+    names have the hash zero.
+*/
+template<typename Indices, typename... Opts>
+struct static_table;
+
+template<std::size_t... I, typename... Opts>
+struct static_table<index_list<I...>, Opts...>
+{
+    static const std::size_t size      = sizeof...(Opts);
+    static const std::size_t num_names = 2 * sizeof...(Opts);
+
+    static constexpr const char* names[] = {Opts::short_name()..., Opts::long_name()...};
+
+    static constexpr std::size_t lengths[] = {
+            static_length(Opts::short_name())...,
+            static_length(Opts::long_name())...};
+
+    static constexpr std::uint64_t hashes[] = {
+            static_hash(Opts::short_name())...,
+            static_hash(Opts::long_name())...};
+
+    static constexpr option_type types[] = {Opts::type()...};
+
+    static constexpr value_constraint constraints[] = {Opts::constraint()...};
+
+    static constexpr unsigned int num_expected_values[] = {Opts::num_expected_values()...};
+
+    // Position of every name when the names are sorted by hash.
+    static constexpr std::size_t ranks[] = {static_rank(hashes, I, 0, num_names)...};
+
+    // The names sorted by hash: Their position in the arrays above and their hashes.
+    static constexpr std::size_t by_hash[] = {static_position(ranks, I, 0, num_names)...};
+
+    static constexpr std::uint64_t sorted_hashes[] = {
+            hashes[by_hash[I]]...};
+};
+
+template<std::size_t... I, typename... Opts>
+constexpr const char* static_table<index_list<I...>, Opts...>::names[];
+
+template<std::size_t... I, typename... Opts>
+constexpr std::size_t static_table<index_list<I...>, Opts...>::lengths[];
+
+template<std::size_t... I, typename... Opts>
+constexpr std::uint64_t static_table<index_list<I...>, Opts...>::hashes[];
+
+template<std::size_t... I, typename... Opts>
+constexpr option_type static_table<index_list<I...>, Opts...>::types[];
+
+template<std::size_t... I, typename... Opts>
+constexpr value_constraint static_table<index_list<I...>, Opts...>::constraints[];
+
+template<std::size_t... I, typename... Opts>
+constexpr unsigned int static_table<index_list<I...>, Opts...>::num_expected_values[];
+
+template<std::size_t... I, typename... Opts>
+constexpr std::size_t static_table<index_list<I...>, Opts...>::ranks[];
+
+template<std::size_t... I, typename... Opts>
+constexpr std::size_t static_table<index_list<I...>, Opts...>::by_hash[];
+
+template<std::size_t... I, typename... Opts>
+constexpr std::uint64_t static_table<index_list<I...>, Opts...>::sorted_hashes[];
+
+// Whether every option in [lo, hi) has a short or a long name.
+constexpr bool
+static_named(const char* const* names, std::size_t lo, std::size_t hi, std::size_t n)
+{
+    return hi <= lo
+            ? true
+            : 1 == hi - lo
+                    ? !static_empty(names[lo]) || !static_empty(names[lo + n])
+                    : static_named(names, lo, lo + (hi - lo) / 2, n)
+                            && static_named(names, lo + (hi - lo) / 2, hi, n);
+}
+
+} // namespace detail
+
+
+/*!
+    A schema whose options are known at compile time. See the description of this file
+    for how to declare the options. All members are static, there is nothing to create
+    at runtime. Parsing follows the rules of `loot::clp::schema`, with these differences:
+
+    - Values are whole arguments. Attached values like `-ofile` and `--name=value`, and
+      clusters that end in one like `-vofile`, are unknown option switches.
+    - Long names can't be abbreviated.
+    - Unknown options aren't passed through, and the arguments behind "`--`" aren't
+      kept.
+    - Response files aren't expanded.
+
+    The compiler rejects schemas with duplicate names or options without names. Names
+    are looked up by their FNV-1a hash, which the compiler computes for all names and
+    verifies to be collision free, followed by a binary search over the sorted hashes.
+    The compiler sorts the hashes by comparing every pair of names, so compile times grow
+    quadratically with the number of options. A schema of fifty options is fine, one of
+    several hundred options is better served by `loot::clp::schema`.
+*/
+template<typename... Opts>
+class static_schema
+{
+    typedef detail::static_table<
+            typename detail::make_index_list<2 * sizeof...(Opts)>::type,
+            Opts...> table_type;
+
+    static_assert(sizeof...(Opts) > 0, "A static_schema needs at least one option");
+    static_assert(detail::static_named(table_type::names, 0, table_type::size,
+                                       table_type::size),
+                  "Every option of the static_schema needs a name");
+    static_assert(detail::static_distinct(table_type::sorted_hashes, 0,
+                                          table_type::num_names),
+                  "Two options of the static_schema share a name (or a hash, rename one)");
+
+public:
+    /*!
+        Returned by `find` if a name is unknown.
+    */
+    static const std::size_t npos = detail::npos;
+
+    /*!
+        Outcome of `static_schema::parse`. Like the schema it's of fixed size; It holds
+        no memory besides its members and refers to the parsed `argv`, which must outlive
+        it.
+    */
+    class result
+    {
+        friend class static_schema;
+    public:
+        result()
+            : argv(0), num_errors(0)
+        {
+            found.fill(false);
+            first.fill(0);
+            count.fill(0);
+        }
+
+        /*!
+            @return
+            Returns `true` if no violations were found or `false` if parsing found errors.
+        */
+        bool good() const { return 0 == num_errors; }
+
+        /*!
+            @return
+            Returns the number of errors.
+        */
+        std::size_t error_count() const { return num_errors; }
+
+        /*!
+            Access an error.
+
+            @param[in] pos
+            Position of the error, must be less than `error_count()`.
+
+            @return
+            Returns the error. Errors with values come first, then missing options.
+        */
+        const static_error& error_at(std::size_t pos) const
+        {
+            if (pos >= num_errors) {
+                throw std::out_of_range("loot::clp::static_schema::result::error_at");
+            }
+            return errors[pos];
+        }
+
+        /*!
+            @param[in] ordinal
+            Position of the option in the schema.
+
+            @return
+            Returns `true` if the option was found on the command line.
+        */
+        bool has(std::size_t ordinal) const { return found[ordinal]; }
+
+        /*!
+            @return
+            Returns `true` if option `Opt` was found on the command line.
+        */
+        template<typename Opt>
+        bool has() const
+        {
+            return found[detail::index_of<Opt, Opts...>::value];
+        }
+
+        /*!
+            @param[in] ordinal
+            Position of the option in the schema.
+
+            @return
+            Returns the values of the option, an empty span if it has none or wasn't found.
+        */
+        argv_span values(std::size_t ordinal) const
+        {
+            return 0 == count[ordinal] ? argv_span() : argv_span(argv + first[ordinal],
+                                                                count[ordinal]);
+        }
+
+        /*!
+            @return
+            Returns the values of option `Opt`, an empty span if it has none or wasn't
+            found.
+        */
+        template<typename Opt>
+        argv_span values() const
+        {
+            return values(detail::index_of<Opt, Opts...>::value);
+        }
+
+    private:
+        char* const*                             argv;
+        std::array<bool, sizeof...(Opts)>         found;
+        std::array<std::size_t, sizeof...(Opts)>  first;
+        std::array<std::size_t, sizeof...(Opts)>  count;
+        std::array<static_error, sizeof...(Opts)> errors;
+        std::size_t                               num_errors;
+    };
+
+    /*!
+        @return
+        Returns the number of options.
+    */
+    static constexpr std::size_t size()
+    {
+        return sizeof...(Opts);
+    }
+
+    /*!
+        @return
+        Returns the position of option `Opt` in the schema.
+    */
+    template<typename Opt>
+    static constexpr std::size_t ordinal()
+    {
+        return detail::index_of<Opt, Opts...>::value;
+    }
+
+    /*!
+        Find an option either by its short or long name.
+
+        @param[in] name
+        The name of the option without the option switch.
+
+        @return
+        Returns the position of the option or `npos` if no option has that name.
+    */
+    static std::size_t find(const arg_view& name)
+    {
+        if (name.empty()) {
+            return npos;
+        }
+
+        // Binary search over the hashes, the compiler has sorted them. The hashes of all
+        // names are unique, one comparison of the characters confirms the match.
+        std::uint64_t hash = detail::hash_name(name);
+        std::size_t   lo   = 0;
+        std::size_t   hi   = table_type::num_names;
+        while (lo < hi) {
+            std::size_t mid = lo + (hi - lo) / 2;
+            if (table_type::sorted_hashes[mid] < hash) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+
+        if (lo == table_type::num_names || table_type::sorted_hashes[lo] != hash) {
+            return npos;
+        }
+
+        std::size_t n = table_type::by_hash[lo];
+        if (table_type::lengths[n] != name.size()
+                || 0 != std::memcmp(table_type::names[n], name.data(), name.size())) {
+            return npos;
+        }
+
+        return n % sizeof...(Opts);
+    }
+
+    /*!
+        Parses the command line with respect to the options of the schema. This method
+        may be called concurrently and allocates no memory.
+
+        @param[in] argc
+        The number of arguments that can be found on the command line.
+
+        @param[in] argv
+        Pointer to the first element of an array of character string pointers
+        which contains the whole command line.
+
+        @return
+        Returns the result, which refers to `argv`.
+    */
+    static result parse(int argc, char* argv[])
+    {
+        result r;
+        r.argv = argv;
+
+        table  t;
+        target s(r);
+        detail::dispatch(argv_span(argv, argc), t, s);
+        detail::validate(t, s);
+        return r;
+    }
+
+private:
+    /*!
+        Presents the options to the parse engine.
+    */
+    struct table
+    {
+        std::size_t size() const { return sizeof...(Opts); }
+        std::size_t find(const arg_view& name) const { return static_schema::find(name); }
+        bool has_names(std::size_t) const { return true; }
+        option_type type(std::size_t o) const { return table_type::types[o]; }
+
+        value_constraint constraint(std::size_t o) const
+        {
+            return table_type::constraints[o];
+        }
+
+        std::size_t num_expected_values(std::size_t o) const
+        {
+            return table_type::num_expected_values[o];
+        }
+    };
+
+    /*!
+        Records the findings of the parse engine in a result.
+    */
+    class target
+    {
+    public:
+        explicit target(result& r)
+            : r(r)
+        {}
+
+        bool found(std::size_t o) const { return r.found[o]; }
+        std::size_t count(std::size_t o) const { return r.count[o]; }
+
+        void occur(std::size_t o, std::size_t first, std::size_t count)
+        {
+            r.found[o] = true;
+            r.first[o] = first;
+            r.count[o] = count;
+        }
+
+        // Static options keep their values as they are.
+        bool convert(std::size_t, requirement_error&) const { return true; }
+
+        void fail(std::size_t o, requirement_error reason)
+        {
+            // At most one error per option: Value errors, including a value attached to
+            // an option without values, need the option to be found, the missing option
+            // error needs it not to be. Options are found only once.
+            if (r.num_errors < sizeof...(Opts)) {
+                r.errors[r.num_errors].ordinal = o;
+                r.errors[r.num_errors].reason  = reason;
+                r.num_errors++;
+            }
+        }
+
+    private:
+        result& r;
+    };
+};
+
+template<typename... Opts>
+const std::size_t static_schema<Opts...>::npos;
+
+
+} // namespace clp
+} // namespace loot
+
+#endif // HAS_CXX11_CONSTEXPR && HAS_CXX11_VARIADIC_TEMPLATES
+
+#endif // STATIC_SCHEMA_H
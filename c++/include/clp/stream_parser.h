@@ -0,0 +1,230 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef STREAM_PARSER_H
+#define STREAM_PARSER_H
+
+#include "../config.h"
+#include "arg_view.h"
+#include "error.h"
+#include "option.h"
+#include "schema.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace loot {
+namespace clp {
+
+
+/*!
+    Parses a command line that arrives one argument at a time, e.g. from a pipe. The
+    arguments are passed to `feed` as they come in, `finish` marks the end. Options are
+    recognized the same way as by `loot::clp::schema::parse`, including clusters like
+    `-xvf` and attached values like `-ofile` and `--name=value`, and "`--`" ends the
+    options: The arguments fed behind it are ignored. Response files are not expanded
+    and unknown option switches are not recorded.
+
+    Handlers registered with `on` are called as soon as the values of an option are
+    complete and valid: For options without values when the option is fed, otherwise
+    when the expected number of values has arrived or the next option or `finish`
+    interrupts them. Only the values of the option being read are kept, so the memory
+    needed doesn't depend on the number of arguments. Options with a variable number of
+    values hand their values to the handler in portions of at most `batch_size` values;
+    Their handler may be called several times.
+
+    Errors are recorded when they are detected: Wrong values when an option is
+    complete, missing options by `finish`.
+*/
+class LOOT_LIB_EXPORT stream_parser
+{
+public:
+    /*!
+        Called with the option and its values. The views are only valid during the call.
+    */
+    typedef std::function<void (const option& opt, arg_span values)> handler;
+
+    /*!
+        Create a parser for the options of a schema.
+
+        @param[in] options
+        The schema, see `loot::clp::parser::freeze()`.
+
+        @param[in] batch_size
+        The maximum number of values handed to a handler at once, only relevant for
+        options with a variable number of values. Must not be zero.
+    */
+    explicit stream_parser(std::shared_ptr<const schema> options,
+                           std::size_t batch_size = 1024);
+
+    /*!
+        Register a handler for an option. A previous handler of the option is replaced.
+
+        @param[in] name
+        Long or short name of the option (excluding the option switch [e.g. "-"]).
+
+        @param[in] h
+        The handler.
+
+        @return
+        Returns `true` if the option exists or `false` otherwise.
+    */
+    bool on(const std::string& name, handler h);
+
+    /*!
+        Process the next argument. The application name that starts `argv` must not be
+        fed.
+
+        @param[in] arg
+        The argument, it is copied if needed.
+    */
+    void feed(const arg_view& arg);
+
+    /*!
+        Ends the command line, completes the option being read and checks for missing
+        options. Afterwards `reset()` has to be called to parse another command line.
+
+        @return
+        Returns `true` if no violations were found or `false` if parsing found errors.
+    */
+    bool finish();
+
+    /*!
+        Prepare for the next command line. Handlers stay registered.
+    */
+    void reset();
+
+    /*!
+        Query whether an option has been found so far.
+
+        @param[in] name
+        Long or short name of the option (excluding the option switch [e.g. "-"]).
+
+        @return
+        Returns `true` if the option was found or `false` otherwise.
+    */
+    bool has_option(const std::string& name) const;
+
+    /*!
+        @return
+        Returns the number of errors found so far.
+    */
+    std::size_t error_count() const;
+
+    /*!
+        Access an error.
+
+        @param[in] pos
+        Position of the error, must be less than `error_count()`. Errors are in the order
+        they were detected.
+
+        @return
+        Returns the error. Its option belongs to the schema.
+    */
+    const error_ref& error_at(std::size_t pos) const;
+
+private:
+    /*!
+        Starts reading the values of an option, unless it has been found before. Options
+        without values are complete right away.
+    */
+    void begin(std::size_t ordinal);
+
+    /*!
+        Adds a value to option `current`, completing it with its last value.
+    */
+    void push(const arg_view& value);
+
+    /*!
+        Feeds a switch that names no option as a whole, like `--name=value` or a cluster
+        like `-xvf` or `-ofile`. It is taken apart by `loot::clp::detail::split_switch`,
+        like the parse engine does.
+    */
+    void split(const arg_view& arg, int start);
+
+    /*!
+        Ends reading values for option `current`, checks them and calls its handler.
+    */
+    void complete();
+
+    /*!
+        Hands the values read so far to the handler of `current` and forgets them.
+    */
+    void flush();
+
+    /*!
+        Records an error.
+    */
+    void fail(std::size_t ordinal, requirement_error reason);
+
+    std::shared_ptr<const schema> options;
+    std::size_t                   batch_size;
+
+    /*!
+        One handler and one flag per option, in the order of the schema.
+    */
+    std::vector<handler> handlers;
+    std::vector<bool>    found;
+
+    /*!
+        The option whose values are being read or `schema::npos`.
+    */
+    std::size_t current;
+
+    /*!
+        How many more values `current` accepts and how many it got in total.
+    */
+    std::size_t remaining;
+    std::size_t count;
+
+    /*!
+        `true` once "`--`" has been fed.
+    */
+    bool terminated;
+
+    /*!
+        Copies of the values that haven't been handed to the handler yet, stored one
+        after the other, and where each of them ends in `text`.
+    */
+    std::vector<char>        text;
+    std::vector<std::size_t> ends;
+    std::vector<arg_view>    views;
+
+    std::vector<error_ref> errors;
+
+};
+
+
+} // namespace clp
+} // namespace loot
+
+#endif // STREAM_PARSER_H
@@ -0,0 +1,148 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+/*!
+    \file
+    Edit distances between option names, computed bit-parallel, and the search for the
+    names closest to one that matches no option.
+*/
+
+#ifndef SUGGEST_H
+#define SUGGEST_H
+
+#include "../config.h"
+#include "arg_view.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace loot {
+namespace clp {
+namespace detail {
+
+
+/*!
+    Computes the Levenshtein distance of two names with the bit-vector algorithm of
+    Myers in the formulation of Hyyrö, one machine word per column for names of up to 64
+    characters. Longer names fall back to the textbook dynamic program.
+
+    @param[in] pattern
+    The first name.
+
+    @param[in] text
+    The second name.
+
+    @param[in] limit
+    Computing stops as soon as the distance is known to exceed this.
+
+    @return
+    Returns the distance, or a value greater than `limit` if it exceeds `limit`.
+*/
+LOOT_LIB_EXPORT std::size_t
+edit_distance(const arg_view& pattern, const arg_view& text, std::size_t limit);
+
+/*!
+    Finds the names closest to a misspelled one. The names are bucketed by length and
+    carry bit sets of the characters and of the pairs of characters they contain, so
+    most of them are ruled out without computing any distance: A name is only compared
+    if its length and these sets differ from the misspelled name by no more than the
+    distance allowed can explain.
+*/
+class LOOT_LIB_EXPORT name_suggester
+{
+public:
+    /*!
+        A name close to the misspelled one.
+    */
+    struct match
+    {
+        std::size_t ordinal;
+        bool        is_long;
+        std::size_t distance;
+    };
+
+    /*!
+        Builds the buckets.
+
+        @param[in] short_names
+        The short name of every option by its ordinal, empty for none.
+
+        @param[in] long_names
+        The long name of every option by its ordinal, empty for none.
+    */
+    void build(const std::vector<std::string>& short_names,
+               const std::vector<std::string>& long_names);
+
+    /*!
+        Finds the names closest to `name`, i.e. the names at the smallest distance to
+        it that any name has. The distance allowed grows with the length of `name`, from
+        one (`1`) for two characters to four (`4`) for ten and more, so short names don't
+        suggest unrelated ones.
+
+        @param[in] name
+        The misspelled name, without the option switch.
+
+        @param[in] max
+        The maximum number of names to find.
+
+        @param[out] matches
+        Receives the names, at most one per option, the closest first and ties in the
+        order of the options.
+    */
+    void suggest(const arg_view& name, std::size_t max, std::vector<match>& matches) const;
+
+private:
+    /*!
+        All names, one after the other, in the order of `offsets`.
+    */
+    std::vector<char> text;
+
+    /*!
+        One entry per name, ordered by the length of the names.
+    */
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint64_t> chars;
+    std::vector<std::uint64_t> pairs;
+    std::vector<std::uint32_t> ordinals;
+    std::vector<unsigned char> longs;
+
+    /*!
+        The first entry of each length, plus one past the last entry.
+    */
+    std::vector<std::uint32_t> buckets;
+};
+
+
+} // namespace detail
+} // namespace clp
+} // namespace loot
+
+#endif // SUGGEST_H
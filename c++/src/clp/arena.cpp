@@ -0,0 +1,172 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <clp/arena.h>
+
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace loot {
+namespace clp {
+
+namespace {
+
+char*
+align_up(char* ptr, std::size_t alignment)
+{
+    std::uintptr_t value = reinterpret_cast<std::uintptr_t>(ptr);
+    return reinterpret_cast<char*>((value + alignment - 1) & ~(alignment - 1));
+}
+
+} // namespace
+
+arena::arena(std::size_t block_size)
+{
+    this->current    = 0;
+    this->next       = 0;
+    this->limit      = 0;
+    this->block_size = block_size;
+    this->total      = 0;
+    this->consumed   = 0;
+}
+
+arena::arena(arena&& temp)
+{
+    this->current = 0;
+    *this = std::move(temp);
+}
+
+arena&
+arena::operator=(arena&& temp)
+{
+    release();
+
+    current    = temp.current;
+    next       = temp.next;
+    limit      = temp.limit;
+    block_size = temp.block_size;
+    total      = temp.total;
+    consumed   = temp.consumed;
+
+    temp.current  = 0;
+    temp.next     = 0;
+    temp.limit    = 0;
+    temp.total    = 0;
+    temp.consumed = 0;
+    return *this;
+}
+
+arena::~arena()
+{
+    release();
+}
+
+void*
+arena::allocate(std::size_t size, std::size_t alignment)
+{
+    char* start = align_up(next, alignment);
+    if (0 == next || start + size > limit) {
+        grow(size, alignment);
+        start = align_up(next, alignment);
+    }
+
+    consumed += (start - next) + size;
+    next      = start + size;
+    return start;
+}
+
+void
+arena::reset()
+{
+    if (0 != current && 0 != current->previous) {
+        // Merge: One block large enough for everything that was needed this round.
+        std::size_t size = total;
+        release();
+        block_size = size;
+        grow(0, 1);
+    }
+
+    if (0 != current) {
+        next  = reinterpret_cast<char*>(current + 1);
+        limit = next + current->size;
+    }
+    consumed = 0;
+}
+
+std::size_t
+arena::capacity() const
+{
+    return total;
+}
+
+std::size_t
+arena::used() const
+{
+    return consumed;
+}
+
+void
+arena::grow(std::size_t size, std::size_t alignment)
+{
+    // Double the size of the blocks so the number of blocks stays logarithmic in the
+    // total size. The first block uses the configured size.
+    std::size_t wanted = 0 == current ? block_size : current->size * 2;
+    if (wanted < size + alignment) {
+        wanted = size + alignment;
+    }
+
+    // Blocks come from operator new like all other memory of the library, so replacing
+    // it (e.g. to count allocations) covers the arena as well.
+    block* b = static_cast<block*>(::operator new(sizeof(block) + wanted));
+
+    b->previous = current;
+    b->size     = wanted;
+    current     = b;
+    next        = reinterpret_cast<char*>(b + 1);
+    limit       = next + wanted;
+    total      += wanted;
+}
+
+void
+arena::release()
+{
+    while (0 != current) {
+        block* previous = current->previous;
+        ::operator delete(current);
+        current = previous;
+    }
+
+    next  = 0;
+    limit = 0;
+    total = 0;
+}
+
+} // namespace clp
+} // namespace loot
@@ -0,0 +1,232 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <clp/schema.h>
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace loot {
+namespace clp {
+
+namespace {
+
+/*!
+    The part of a batch that is (still) assigned to one worker. The owner takes chunks
+    from the front, thieves take half of what is left from the back.
+*/
+struct work_range
+{
+    std::mutex  lock;
+    std::size_t begin;
+    std::size_t end;
+};
+
+/*!
+    Number of command lines a worker takes from its own range at once. Small enough to
+    keep the ranges stealable, large enough to keep the lock out of the way.
+*/
+const std::size_t grain = 64;
+
+bool
+take_own(work_range& range, std::size_t& begin, std::size_t& end)
+{
+    std::lock_guard<std::mutex> guard(range.lock);
+    if (range.begin == range.end) {
+        return false;
+    }
+
+    begin       = range.begin;
+    end         = std::min(range.end, range.begin + grain);
+    range.begin = end;
+    return true;
+}
+
+bool
+steal(work_range& victim, work_range& thief)
+{
+    std::size_t begin, end;
+    {
+        std::lock_guard<std::mutex> guard(victim.lock);
+        std::size_t left = victim.end - victim.begin;
+        if (0 == left) {
+            return false;
+        }
+
+        // Leave the victim the front half, it is working its way towards it anyway. A
+        // single remaining entry is stolen as a whole.
+        begin      = victim.begin + left / 2;
+        end        = victim.end;
+        victim.end = begin;
+    }
+
+    // Never hold two locks at once, two workers might be stealing from each other.
+    std::lock_guard<std::mutex> guard(thief.lock);
+    thief.begin = begin;
+    thief.end   = end;
+    return true;
+}
+
+void
+work(const schema&                    s,
+     const std::vector<command_line>& lines,
+     std::vector<result>&             results,
+     std::vector<work_range>&         ranges,
+     std::size_t                      self)
+{
+    for (;;) {
+        std::size_t begin, end;
+        while (take_own(ranges[self], begin, end)) {
+            for (std::size_t c = begin; c < end; c++) {
+                results[c] = s.parse(lines[c].argc, lines[c].argv);
+            }
+        }
+
+        // Our own range is exhausted; Look for work at the other workers. Ranges only ever
+        // shrink, so if nobody has anything left we're done.
+        bool stolen = false;
+        for (std::size_t v = 1; v < ranges.size() && !stolen; v++) {
+            stolen = steal(ranges[(self + v) % ranges.size()], ranges[self]);
+        }
+
+        if (!stolen) {
+            return;
+        }
+    }
+}
+
+/*!
+    Empties all ranges, so the workers stop once they're done with the command lines they
+    have taken.
+*/
+void
+cancel(std::vector<work_range>& ranges)
+{
+    for (auto iter = std::begin(ranges); iter != std::end(ranges); iter++) {
+        std::lock_guard<std::mutex> guard(iter->lock);
+        iter->begin = iter->end;
+    }
+}
+
+/*!
+    Joins the threads of a batch when it goes out of scope, also if an exception leaves
+    it; Destroying a thread that is still joinable terminates the program.
+*/
+class joiner
+{
+public:
+    explicit joiner(std::vector<std::thread>& threads)
+        : threads(threads)
+    {}
+
+    ~joiner()
+    {
+        for (auto iter = std::begin(threads); iter != std::end(threads); iter++) {
+            if (iter->joinable()) {
+                iter->join();
+            }
+        }
+    }
+
+private:
+    std::vector<std::thread>& threads;
+};
+
+} // namespace
+
+std::vector<result>
+schema::parse_batch(const std::vector<command_line>& lines, unsigned int num_threads) const
+{
+    std::vector<result> results(lines.size());
+
+    if (0 == num_threads) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    num_threads = static_cast<unsigned int>(
+            std::min<std::size_t>(num_threads, (lines.size() + grain - 1) / grain));
+
+    if (num_threads <= 1) {
+        for (std::size_t c = 0; c < lines.size(); c++) {
+            results[c] = parse(lines[c].argc, lines[c].argv);
+        }
+        return results;
+    }
+
+    // Every worker starts with an equal share of the batch.
+    std::vector<work_range> ranges(num_threads);
+    for (std::size_t w = 0; w < num_threads; w++) {
+        ranges[w].begin = lines.size() * w / num_threads;
+        ranges[w].end   = lines.size() * (w + 1) / num_threads;
+    }
+
+    // Results are written to distinct entries of the vector; The only thing the workers
+    // share is this schema, which is never modified.
+    std::mutex         failure_lock;
+    std::exception_ptr failure;
+    auto worker = [&](std::size_t self) {
+        try {
+            work(*this, lines, results, ranges, self);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> guard(failure_lock);
+            failure = std::current_exception();
+        }
+    };
+
+    // Room for all threads is made up front, so a thread is never left unowned.
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    joiner join(threads);
+    try {
+        for (std::size_t w = 1; w < num_threads; w++) {
+            threads.push_back(std::thread(worker, w));
+        }
+    }
+    catch (...) {
+        // Starting a thread failed; The ones running are joined by `join`.
+        cancel(ranges);
+        throw;
+    }
+    worker(0);
+
+    for (auto iter = std::begin(threads); iter != std::end(threads); iter++) {
+        iter->join();
+    }
+
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+
+    return results;
+}
+
+} // namespace clp
+} // namespace loot
@@ -0,0 +1,219 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <clp/classify.h>
+
+#include <cstring>
+
+#ifdef MSVC_COMPILER
+    #include <intrin.h>
+#endif
+
+// The vectorized scan reads past the end of arguments, which AddressSanitizer reports.
+// Instrumented builds use the plain loop instead.
+#if defined(__SANITIZE_ADDRESS__)
+    #define LOOT_CLP_SANITIZED
+#elif defined(__has_feature)
+    #if __has_feature(address_sanitizer)
+        #define LOOT_CLP_SANITIZED
+    #endif
+#endif
+
+#if defined(LOOT_CLP_SANITIZED)
+    // No vector instructions.
+#elif defined(__AVX2__)
+    #include <immintrin.h>
+    #define LOOT_CLP_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define LOOT_CLP_SSE2
+#endif
+
+namespace loot {
+namespace clp {
+namespace detail {
+
+namespace {
+
+/*!
+    Sets `dashes` and `terminator` from the first characters of an argument.
+*/
+void
+classify_start(const char* arg, std::size_t length, arg_info& info)
+{
+    info.dashes     = 0;
+    info.terminator = false;
+    if (0 != length && '-' == arg[0]) {
+        info.dashes     = length > 1 && '-' == arg[1] ? 2 : 1;
+        info.terminator = 2 == length && 2 == info.dashes;
+    }
+}
+
+std::uint32_t
+equals_position(std::size_t pos)
+{
+    return pos < no_equals ? static_cast<std::uint32_t>(pos) : no_equals;
+}
+
+#if defined(LOOT_CLP_AVX2) || defined(LOOT_CLP_SSE2)
+
+unsigned int
+lowest_bit(std::uint32_t mask)
+{
+#ifdef MSVC_COMPILER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+#endif
+
+#if defined(LOOT_CLP_AVX2)
+
+const std::size_t block_size = 32;
+
+/*!
+    Bit masks of the `'\0'` and `=` characters in the block at `block`.
+*/
+void
+scan_block(const char* block, std::uint32_t& zeros, std::uint32_t& equals)
+{
+    __m256i bytes = _mm256_load_si256(reinterpret_cast<const __m256i*>(block));
+    zeros  = _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_setzero_si256()));
+    equals = _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('=')));
+}
+
+#elif defined(LOOT_CLP_SSE2)
+
+const std::size_t block_size = 16;
+
+void
+scan_block(const char* block, std::uint32_t& zeros, std::uint32_t& equals)
+{
+    __m128i bytes = _mm_load_si128(reinterpret_cast<const __m128i*>(block));
+    zeros  = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_setzero_si128()));
+    equals = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('=')));
+}
+
+#endif
+
+#if defined(LOOT_CLP_AVX2) || defined(LOOT_CLP_SSE2)
+
+/*!
+    Finds the end and the first `=` of an argument in a single pass. Blocks are loaded
+    from aligned addresses, an aligned block never crosses a page boundary, so reading
+    past the terminating `'\0'` inside the last block is safe.
+*/
+std::size_t
+scan(const char* arg, std::size_t& equals)
+{
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(arg);
+    const char*    block   = arg - (address & (block_size - 1));
+
+    // Ignore the bytes in front of the argument in the first block.
+    std::uint32_t skip = ~std::uint32_t(0) << (arg - block);
+    equals = no_equals;
+
+    for (;;) {
+        std::uint32_t zeros;
+        std::uint32_t found;
+        scan_block(block, zeros, found);
+        zeros &= skip;
+        found &= skip;
+        skip   = ~std::uint32_t(0);
+
+        if (0 != zeros) {
+            // Only an = in front of the end counts.
+            found &= (zeros & (0u - zeros)) - 1;
+        }
+        if (no_equals == equals && 0 != found) {
+            equals = block + lowest_bit(found) - arg;
+        }
+        if (0 != zeros) {
+            return block + lowest_bit(zeros) - arg;
+        }
+
+        block += block_size;
+    }
+}
+
+#else
+
+std::size_t
+scan(const char* arg, std::size_t& equals)
+{
+    equals = no_equals;
+
+    const char* c = arg;
+    for (; '\0' != *c; c++) {
+        if ('=' == *c && no_equals == equals) {
+            equals = c - arg;
+        }
+    }
+
+    return c - arg;
+}
+
+#endif
+
+} // namespace
+
+void
+classify(char* const* argv, std::size_t count, arg_view* tokens, arg_info* infos)
+{
+    for (std::size_t c = 0; c < count; c++) {
+        std::size_t equals;
+        std::size_t length = scan(argv[c], equals);
+
+        tokens[c] = arg_view(argv[c], length);
+        classify_start(argv[c], length, infos[c]);
+        infos[c].equals = equals_position(equals);
+    }
+}
+
+void
+classify(const arg_view* tokens, std::size_t count, arg_info* infos)
+{
+    for (std::size_t c = 0; c < count; c++) {
+        const char* equals = tokens[c].empty() ? 0 : static_cast<const char*>(
+                std::memchr(tokens[c].data(), '=', tokens[c].size()));
+
+        classify_start(tokens[c].data(), tokens[c].size(), infos[c]);
+        infos[c].equals = 0 == equals
+                ? no_equals
+                : equals_position(equals - tokens[c].data());
+    }
+}
+
+} // namespace detail
+} // namespace clp
+} // namespace loot
@@ -0,0 +1,186 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <clp/command.h>
+#include <clp/engine.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace loot {
+namespace clp {
+
+namespace {
+
+/*!
+    Records which arguments the parse engine takes as values, see `command::split`.
+*/
+class claims
+{
+public:
+    claims(std::size_t num_tokens, std::size_t num_options, bool passes)
+        : values(num_tokens), seen(num_options), passes(passes)
+    {}
+
+    bool found(std::size_t o) const { return seen[o]; }
+    bool claimed(std::size_t token) const { return values[token]; }
+
+    void occur(std::size_t o, std::size_t first, std::size_t count)
+    {
+        seen[o] = true;
+        std::fill(std::begin(values) + first, std::begin(values) + first + count, true);
+    }
+
+    void fail(std::size_t, requirement_error) {}
+    void attach(std::size_t, const arg_view&) {}
+    bool pass_through(std::size_t) { return passes; }
+
+private:
+    std::vector<bool> values;
+    std::vector<bool> seen;
+    bool              passes;
+};
+
+} // namespace
+
+command::command(const std::string& name, factory make, const std::string& description)
+    : label(name), about(description), make(std::move(make))
+{}
+
+command&
+command::add(const std::string& name, factory make, const std::string& description)
+{
+    std::unique_ptr<command>& child = children[name];
+    child.reset(new command(name, std::move(make), description));
+    return *child;
+}
+
+const command*
+command::find(const arg_view& name) const
+{
+    if (children.empty()) {
+        return 0;
+    }
+
+    auto it = children.find(std::string(name.data(), name.size()));
+    return std::end(children) == it ? 0 : it->second.get();
+}
+
+const std::string&
+command::name() const
+{
+    return label;
+}
+
+const std::string&
+command::description() const
+{
+    return about;
+}
+
+std::vector<command_level>
+command::dispatch(int argc, char* argv[]) const
+{
+    std::vector<command_level> levels;
+    const command*             node = this;
+    while (true) {
+        // Every level is a command line of its own, the name of the command takes the
+        // place of the application name.
+        command_level level;
+        level.cmd     = node;
+        level.options = node->build();
+
+        int end = node->split(*level.options, argc, argv);
+        level.parsed = level.options->parse(end, argv);
+        levels.push_back(std::move(level));
+        if (end == argc) {
+            break;
+        }
+
+        node  = node->find(argv[end]);
+        argc -= end;
+        argv += end;
+    }
+
+    return levels;
+}
+
+void
+command::print_help(std::ostream& out, bool newline) const
+{
+    build()->print_help(out, newline);
+    if (children.empty()) {
+        return;
+    }
+
+    std::size_t max = 0;
+    for (auto it = std::begin(children); it != std::end(children); ++it) {
+        max = std::max(max, it->first.size());
+    }
+
+    out << "Commands" << std::endl;
+    for (auto it = std::begin(children); it != std::end(children); ++it) {
+        out << it->first << std::string(max - it->first.size() + 3, ' ')
+            << it->second->about << std::endl;
+        if (newline) {
+            out << std::endl;
+        }
+    }
+}
+
+std::shared_ptr<const schema>
+command::build() const
+{
+    return make ? make().freeze() : parser().freeze();
+}
+
+int
+command::split(const schema& options, int argc, char* argv[]) const
+{
+    if (children.empty()) {
+        return argc;
+    }
+
+    // Run the parse engine, so exactly the arguments parse takes as values are skipped.
+    argv_span tokens(argv, argc);
+    claims    state(tokens.size(), options.size(), options.passes_through_unknown());
+    std::size_t end = detail::dispatch(tokens, schema::table(options), state);
+    for (std::size_t c = 1; c < end; c++) {
+        if (!state.claimed(c) && 0 == detail::is_option(tokens[c])
+                && 0 != find(tokens[c])) {
+            return static_cast<int>(c);
+        }
+    }
+
+    // Behind "--" or an unknown option that is passed through are no sub-commands.
+    return argc;
+}
+
+} // namespace clp
+} // namespace loot
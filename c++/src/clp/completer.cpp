@@ -0,0 +1,287 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <clp/completer.h>
+#include <clp/engine.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace loot {
+namespace clp {
+
+const std::size_t completer::npos;
+
+namespace {
+
+/*!
+    Compares two texts like `std::string` does.
+*/
+int
+compare(const char* lhs, std::size_t lhs_length, const char* rhs, std::size_t rhs_length)
+{
+    int order = std::memcmp(lhs, rhs, std::min(lhs_length, rhs_length));
+    if (0 != order) {
+        return order;
+    }
+    return lhs_length < rhs_length ? -1 : (lhs_length > rhs_length ? 1 : 0);
+}
+
+bool
+starts_with(const arg_view& text, const arg_view& prefix)
+{
+    return text.size() >= prefix.size()
+        && 0 == std::memcmp(text.data(), prefix.data(), prefix.size());
+}
+
+const arg_view booleans[] = {arg_view("false"), arg_view("true")};
+
+} // namespace
+
+completer::completer(std::shared_ptr<const schema> options)
+    : options(std::move(options))
+{
+    for (std::size_t o = 0; o < this->options->size(); o++) {
+        const option&      opt         = this->options->at(o);
+        const std::string* names[]     = {&opt.short_name, &opt.long_name};
+        const char*        switches[]  = {"-", "--"};
+        for (std::size_t n = 0; n < 2; n++) {
+            if (names[n]->empty()) {
+                continue;
+            }
+
+            key k;
+            k.offset  = static_cast<std::uint32_t>(keys.size());
+            k.length  = static_cast<std::uint32_t>(n + 1 + names[n]->size());
+            k.ordinal = o;
+            keys.insert(std::end(keys), switches[n], switches[n] + n + 1);
+            keys.insert(std::end(keys), std::begin(*names[n]), std::end(*names[n]));
+            index.push_back(k);
+        }
+    }
+
+    const char* text = keys.data();
+    std::sort(std::begin(index), std::end(index), [text](const key& lhs, const key& rhs) {
+        return compare(text + lhs.offset, lhs.length, text + rhs.offset, rhs.length) < 0;
+    });
+}
+
+std::size_t
+completer::complete(arg_span                words,
+                    std::vector<candidate>& candidates,
+                    std::size_t             max) const
+{
+    candidates.clear();
+    if (words.empty()) {
+        return 0;
+    }
+
+    // Walk the finished words like the parse engine does, to know which options are
+    // given already and which one the word being completed may be a value of.
+    schema::table            t(*options);
+    std::vector<std::size_t> given;
+    std::size_t              current   = schema::npos;
+    std::size_t              remaining = 0;
+    for (std::size_t w = 0; w + 1 < words.size(); w++) {
+        int start = detail::is_option(words[w]);
+        if (0 == start) {
+            if (schema::npos != current && 0 == --remaining) {
+                current = schema::npos;
+            }
+            continue;
+        }
+
+        if (2 == start && 2 == words[w].size()) {
+            return 0; // Behind "--" there are no options.
+        }
+
+        // The options the word names, taken apart like the parse engine does.
+        arg_view             name    = words[w].sub(start);
+        std::size_t          ordinal = detail::find_switch(t, name, start, 0);
+        detail::switch_parts parts   = {1, ordinal, npos};
+        if (schema::npos == ordinal) {
+            parts = detail::split_switch(t, words[w], start);
+        }
+        if (0 != parts.count && 0 != (parts.last & detail::ambiguous)) {
+            parts.count = 0;
+        }
+
+        current = schema::npos;
+        for (std::size_t n = 0; n < parts.count; n++) {
+            std::size_t named = detail::switch_option(t, words[w], parts, n);
+            if (std::end(given) != std::find(std::begin(given), std::end(given), named)) {
+                continue; // Repetitions don't take values.
+            }
+            given.push_back(named);
+
+            const option& opt = options->at(named);
+            switch (opt.constraint) {
+                case value_constraint_e exact_num_values:
+                case value_constraint_e up_to_num_values:
+                    remaining = opt.num_expected_values;
+                    break;
+
+                case value_constraint_e unlimited_num_values:
+                    remaining = npos;
+                    break;
+
+                default:
+                    remaining = 0;
+                    break;
+            }
+
+            // An attached value is the first one.
+            if (npos != parts.value && 0 != remaining) {
+                remaining--;
+            }
+            if (0 != remaining) {
+                current = named;
+            }
+        }
+    }
+
+    // The value of `--name=value` is completed like a value of its own word.
+    arg_view word     = words[words.size() - 1];
+    bool     is_value = 0 == detail::is_option(word);
+    if (2 == detail::is_option(word) && npos != detail::find_equals(word)) {
+        detail::switch_parts parts = detail::split_switch(t, word, 2);
+        if (0 == parts.count || 0 != (parts.last & detail::ambiguous)) {
+            return 0;
+        }
+        current  = parts.last;
+        word     = word.sub(parts.value);
+        is_value = true;
+    }
+
+    if (is_value && schema::npos != current) {
+        const option& opt = options->at(current);
+        if (value_type_e enum_value == opt.conversion) {
+            for (std::size_t c = 0; c < opt.choices.size() && candidates.size() < max; c++) {
+                if (starts_with(opt.choices[c].first, word)) {
+                    candidate found = {arg_view(opt.choices[c].first), arg_view(), current};
+                    candidates.push_back(found);
+                }
+            }
+        }
+        else if (value_type_e boolean_value == opt.conversion) {
+            for (std::size_t b = 0; b < 2 && candidates.size() < max; b++) {
+                if (starts_with(booleans[b], word)) {
+                    candidate found = {booleans[b], arg_view(), current};
+                    candidates.push_back(found);
+                }
+            }
+        }
+        return candidates.size();
+    }
+
+    if (!word.empty() && 0 == detail::is_option(word)) {
+        return 0;
+    }
+
+    // All names starting with the word are next to each other in the index.
+    const char* text  = keys.data();
+    auto        first = std::lower_bound(std::begin(index), std::end(index), word,
+                                         [text](const key& k, const arg_view& prefix) {
+        return compare(text + k.offset, k.length, prefix.data(), prefix.size()) < 0;
+    });
+    for (auto k = first; k != std::end(index) && candidates.size() < max; ++k) {
+        arg_view name(text + k->offset, k->length);
+        if (!starts_with(name, word)) {
+            break;
+        }
+        if (std::end(given) != std::find(std::begin(given), std::end(given), k->ordinal)) {
+            continue;
+        }
+
+        candidate found = {name, arg_view(options->at(k->ordinal).description), k->ordinal};
+        candidates.push_back(found);
+    }
+
+    return candidates.size();
+}
+
+bool
+completer::handle(int argc, char* argv[], std::ostream& out) const
+{
+    if (argc < 2 || arg_view("--complete") != argv[1]) {
+        return false;
+    }
+
+    // Without words a new one is started.
+    std::vector<arg_view> words(argv + 2, argv + argc);
+    if (words.empty()) {
+        words.push_back(arg_view(""));
+    }
+
+    std::vector<candidate> candidates;
+    complete(arg_span(words.data(), words.size()), candidates);
+    write(candidates, out);
+    return true;
+}
+
+void
+completer::serve(std::istream& in, std::ostream& out) const
+{
+    std::string            line;
+    std::vector<arg_view>  words;
+    std::vector<candidate> candidates;
+    while (std::getline(in, line)) {
+        words.clear();
+        for (std::size_t start = 0; ; ) {
+            std::size_t tab = line.find('\t', start);
+            std::size_t end = std::string::npos == tab ? line.size() : tab;
+            words.push_back(arg_view(line.data() + start, end - start));
+            if (std::string::npos == tab) {
+                break;
+            }
+            start = tab + 1;
+        }
+
+        complete(arg_span(words.data(), words.size()), candidates);
+        write(candidates, out);
+        out << '\n';
+        out.flush();
+    }
+}
+
+void
+completer::write(const std::vector<candidate>& candidates, std::ostream& out)
+{
+    for (std::size_t c = 0; c < candidates.size(); c++) {
+        out << candidates[c].text;
+        if (!candidates[c].description.empty()) {
+            out << '\t' << candidates[c].description;
+        }
+        out << '\n';
+    }
+}
+
+} // namespace clp
+} // namespace loot
@@ -0,0 +1,328 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <clp/convert.h>
+
+#include <cerrno>
+#include <clocale>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#if defined(MSVC_COMPILER) || defined(HAVE_STRTOD_L)
+    #include <locale.h>
+    #include <stdlib.h>
+#endif
+
+namespace loot {
+namespace clp {
+namespace detail {
+
+namespace {
+
+/*!
+    Powers of ten that are exactly representable as `double`.
+*/
+const double exact_powers_of_ten[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/*!
+    Compares the characters from `first` to `last` with `word`, ignoring the case of
+    ASCII letters. `word` has to be in lower case.
+*/
+bool
+equals_folded(const char* first, const char* last, const char* word)
+{
+    for (; first != last; first++, word++) {
+        char c = *first;
+        if ('A' <= c && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+        if ('\0' == *word || c != *word) {
+            return false;
+        }
+    }
+
+    return '\0' == *word;
+}
+
+/*!
+    Converts a terminated number with the rules of the "C" locale. Calling `localeconv()`
+    for every value would race with the other threads of `loot::clp::schema::parse_batch`,
+    so the locale is looked at once.
+
+    @param[in,out] text
+    The number. Its decimal point may be replaced.
+
+    @return
+    Returns the number, `errno` is set like `std::strtod` sets it.
+*/
+double
+to_double(char* text)
+{
+#if defined(MSVC_COMPILER)
+    static const _locale_t c_locale = _create_locale(LC_ALL, "C");
+    return _strtod_l(text, 0, c_locale);
+#elif defined(HAVE_STRTOD_L)
+    static const locale_t c_locale = newlocale(LC_ALL_MASK, "C",
+                                               static_cast<locale_t>(0));
+    return strtod_l(text, 0, c_locale);
+#else
+    // The decimal point of the locale at the first conversion.
+    static const char point = std::localeconv()->decimal_point[0];
+    if ('\0' != point && '.' != point) {
+        char* dot = std::strchr(text, '.');
+        if (0 != dot) {
+            *dot = point;
+        }
+    }
+    return std::strtod(text, 0);
+#endif
+}
+
+} // namespace
+
+bool
+convert_integer(const arg_view& arg, std::int64_t& value, requirement_error& reason)
+{
+    reason = requirement_error_e value_not_convertible_error;
+
+    const char* p   = arg.data();
+    const char* end = p + arg.size();
+    bool negative = false;
+    if (p != end && ('+' == *p || '-' == *p)) {
+        negative = '-' == *p;
+        p++;
+    }
+    if (p == end) {
+        return false;
+    }
+
+    // The magnitude of the smallest number is one larger than that of the largest.
+    const std::uint64_t limit = negative
+            ? static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()) + 1
+            : static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max());
+
+    std::uint64_t magnitude = 0;
+    bool          overflow  = false;
+    for (; p != end; p++) {
+        unsigned int digit = static_cast<unsigned char>(*p) - '0';
+        if (digit > 9) {
+            return false;
+        }
+
+        // Keep checking the remaining characters, a malformed value is reported as such
+        // even if it is too large.
+        if (magnitude > (limit - digit) / 10) {
+            overflow = true;
+        }
+        else {
+            magnitude = magnitude * 10 + digit;
+        }
+    }
+
+    if (overflow) {
+        reason = requirement_error_e value_out_of_range_error;
+        return false;
+    }
+
+    if (negative && 0 != magnitude) {
+        value = -static_cast<std::int64_t>(magnitude - 1) - 1;
+    }
+    else {
+        value = static_cast<std::int64_t>(magnitude);
+    }
+    return true;
+}
+
+bool
+convert_real(const arg_view& arg, double& value, requirement_error& reason)
+{
+    reason = requirement_error_e value_not_convertible_error;
+
+    const char* p   = arg.data();
+    const char* end = p + arg.size();
+    bool negative = false;
+    if (p != end && ('+' == *p || '-' == *p)) {
+        negative = '-' == *p;
+        p++;
+    }
+
+    if (p != end && '.' != *p && static_cast<unsigned char>(*p - '0') > 9) {
+        if (equals_folded(p, end, "inf") || equals_folded(p, end, "infinity")) {
+            value = std::numeric_limits<double>::infinity();
+        }
+        else if (equals_folded(p, end, "nan")) {
+            value = std::numeric_limits<double>::quiet_NaN();
+        }
+        else {
+            return false;
+        }
+
+        value = negative ? -value : value;
+        return true;
+    }
+
+    // Collect up to 19 significant digits, which always fit into 64 bits, and the power
+    // of ten they have to be scaled by. Digits beyond that only matter for rounding.
+    std::uint64_t mantissa = 0;
+    int           digits   = 0;
+    long          exponent = 0;
+    bool          any      = false;
+    bool          exact    = true;
+    for (; p != end && static_cast<unsigned char>(*p - '0') <= 9; p++) {
+        any = true;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits  += 0 != mantissa ? 1 : 0;
+        }
+        else {
+            exponent++;
+            exact = exact && '0' == *p;
+        }
+    }
+    if (p != end && '.' == *p) {
+        for (p++; p != end && static_cast<unsigned char>(*p - '0') <= 9; p++) {
+            any = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits  += 0 != mantissa ? 1 : 0;
+                exponent--;
+            }
+            else {
+                exact = exact && '0' == *p;
+            }
+        }
+    }
+    if (!any) {
+        return false;
+    }
+
+    if (p != end && ('e' == *p || 'E' == *p)) {
+        p++;
+        bool negative_exponent = false;
+        if (p != end && ('+' == *p || '-' == *p)) {
+            negative_exponent = '-' == *p;
+            p++;
+        }
+        if (p == end) {
+            return false;
+        }
+
+        long explicit_exponent = 0;
+        for (; p != end && static_cast<unsigned char>(*p - '0') <= 9; p++) {
+            // Anything this large over- or underflows anyway.
+            if (explicit_exponent < 100000) {
+                explicit_exponent = explicit_exponent * 10 + (*p - '0');
+            }
+        }
+        exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+    if (p != end) {
+        return false;
+    }
+
+    // Both the mantissa and the power of ten are exact, so a single multiplication or
+    // division rounds correctly.
+    if (0 == mantissa) {
+        value = negative ? -0.0 : 0.0;
+        return true;
+    }
+    if (exact && mantissa <= (std::uint64_t(1) << 53)
+            && -22 <= exponent && exponent <= 22) {
+        double d = static_cast<double>(mantissa);
+        d = exponent < 0 ? d / exact_powers_of_ten[-exponent]
+                         : d * exact_powers_of_ten[exponent];
+        value = negative ? -d : d;
+        return true;
+    }
+
+    // Everything else is left to the C library, which needs a terminated copy.
+    char buffer[128];
+    if (arg.size() >= sizeof(buffer)) {
+        return false;
+    }
+    std::memcpy(buffer, arg.data(), arg.size());
+    buffer[arg.size()] = '\0';
+
+    errno = 0;
+    double d = to_double(buffer);
+    if (ERANGE == errno && std::isinf(d)) {
+        reason = requirement_error_e value_out_of_range_error;
+        return false;
+    }
+
+    value = d;
+    return true;
+}
+
+bool
+convert_boolean(const arg_view& arg, bool& value, requirement_error& reason)
+{
+    const char* first = arg.data();
+    const char* last  = first + arg.size();
+    if (equals_folded(first, last, "true") || equals_folded(first, last, "yes")
+            || equals_folded(first, last, "on") || equals_folded(first, last, "1")) {
+        value = true;
+        return true;
+    }
+    if (equals_folded(first, last, "false") || equals_folded(first, last, "no")
+            || equals_folded(first, last, "off") || equals_folded(first, last, "0")) {
+        value = false;
+        return true;
+    }
+
+    reason = requirement_error_e value_not_convertible_error;
+    return false;
+}
+
+bool
+convert_choice(const arg_view&                                          arg,
+               const std::vector<std::pair<std::string, std::int64_t>>& choices,
+               std::int64_t&                                            value,
+               requirement_error&                                       reason)
+{
+    for (auto iter = std::begin(choices); iter != std::end(choices); iter++) {
+        if (iter->first.size() == arg.size()
+                && 0 == std::memcmp(iter->first.data(), arg.data(), arg.size())) {
+            value = iter->second;
+            return true;
+        }
+    }
+
+    reason = requirement_error_e value_not_a_choice_error;
+    return false;
+}
+
+} // namespace detail
+} // namespace clp
+} // namespace loot
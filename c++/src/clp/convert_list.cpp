@@ -0,0 +1,350 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <clp/convert.h>
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#ifdef MSVC_COMPILER
+    #include <intrin.h>
+#endif
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define LOOT_CLP_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define LOOT_CLP_SSE2
+#endif
+
+// Eight digits are converted at once by treating them as the lanes of one 64 bit word,
+// which needs the first digit in the lowest byte.
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) \
+        || defined(_M_X64) || defined(_M_IX86)
+    #define LOOT_CLP_SWAR
+#endif
+
+namespace loot {
+namespace clp {
+
+namespace {
+
+#if defined(LOOT_CLP_AVX2) || defined(LOOT_CLP_SSE2)
+
+unsigned int
+lowest_bit(std::uint32_t mask)
+{
+#ifdef MSVC_COMPILER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+unsigned int
+bit_count(std::uint32_t mask)
+{
+#ifdef MSVC_COMPILER
+    return __popcnt(mask);
+#else
+    return __builtin_popcount(mask);
+#endif
+}
+
+#endif
+
+#if defined(LOOT_CLP_AVX2)
+
+const std::size_t block_size = 32;
+
+/*!
+    Bit mask of the bytes in the block at `block` that are no ASCII digits.
+*/
+std::uint32_t
+non_digits(const char* block)
+{
+    __m256i bytes  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+    __m256i digits = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, _mm256_set1_epi8('0' - 1)),
+                                      _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), bytes));
+    return ~static_cast<std::uint32_t>(_mm256_movemask_epi8(digits));
+}
+
+/*!
+    Bit mask of the bytes in the block at `block` that equal `c`.
+*/
+std::uint32_t
+matches(const char* block, char c)
+{
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(c)));
+}
+
+#elif defined(LOOT_CLP_SSE2)
+
+const std::size_t block_size = 16;
+
+std::uint32_t
+non_digits(const char* block)
+{
+    __m128i bytes  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+    __m128i digits = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8('0' - 1)),
+                                   _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), bytes));
+    return ~_mm_movemask_epi8(digits) & 0xFFFFu;
+}
+
+std::uint32_t
+matches(const char* block, char c)
+{
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(c)));
+}
+
+#endif
+
+bool
+is_digit(char c)
+{
+    return static_cast<unsigned char>(c - '0') <= 9;
+}
+
+/*!
+    @return
+    Returns the number of ASCII digits at the start of the `size` characters at `first`.
+    Only reads within these characters.
+*/
+std::size_t
+count_digits(const char* first, std::size_t size)
+{
+    std::size_t pos = 0;
+#if defined(LOOT_CLP_AVX2) || defined(LOOT_CLP_SSE2)
+    for (; pos + block_size <= size; pos += block_size) {
+        std::uint32_t mask = non_digits(first + pos);
+        if (0 != mask) {
+            return pos + lowest_bit(mask);
+        }
+    }
+#endif
+    while (pos < size && is_digit(first[pos])) {
+        pos++;
+    }
+    return pos;
+}
+
+#ifdef LOOT_CLP_SWAR
+
+/*!
+    Converts eight ASCII digits into their value. The digits are the lanes of one word,
+    adjacent lanes are combined by a multiply-accumulate in three steps: pairs,
+    quadruples and finally both halves.
+*/
+std::uint64_t
+eight_digits(std::uint64_t lanes)
+{
+    lanes = (lanes & 0x0F0F0F0F0F0F0F0Full) * 2561 >> 8;
+    lanes = (lanes & 0x00FF00FF00FF00FFull) * 6553601 >> 16;
+    return (lanes & 0x0000FFFF0000FFFFull) * 42949672960001ull >> 32;
+}
+
+/*!
+    Loads the eight characters at `first` as one word.
+*/
+std::uint64_t
+load_lanes(const char* first)
+{
+    std::uint64_t lanes;
+    std::memcpy(&lanes, first, sizeof(lanes));
+    return lanes;
+}
+
+#endif
+
+/*!
+    Converts up to 19 digits, which always fit into 64 bits. `last` is the end of the
+    readable characters, which may be beyond the digits.
+*/
+std::uint64_t
+accumulate(const char* first, std::size_t digits, const char* last)
+{
+    std::uint64_t value = 0;
+#ifdef LOOT_CLP_SWAR
+    // The common case without branches that depend on the number of digits: The last
+    // (up to) eight digits and the ones in front of them each fill the upper lanes of a
+    // word. Shifting twice by half keeps a shift by 64 defined, which yields zero.
+    if (digits <= 16 && last - first >= 8) {
+        std::size_t tail = digits < 8 ? digits : 8;
+        std::size_t lead = digits - tail;
+        std::uint64_t low  = eight_digits(load_lanes(first + lead) << (8 * (8 - tail)));
+        std::uint64_t high = eight_digits(
+                load_lanes(first) << (4 * (8 - lead)) << (4 * (8 - lead)));
+        return high * 100000000 + low;
+    }
+
+    // Leading digits that don't fill a word are moved into its upper lanes, the lower
+    // lanes then act as leading zeros. The characters behind them are shifted out.
+    std::size_t head = digits % 8;
+    if (0 != head && last - first >= 8) {
+        value  = eight_digits(load_lanes(first) << (8 * (8 - head)));
+        first += head;
+        digits -= head;
+    }
+    else {
+        for (; 0 != head; head--, digits--) {
+            value = value * 10 + (*first++ - '0');
+        }
+    }
+
+    for (; 0 != digits; digits -= 8, first += 8) {
+        value = value * 100000000 + eight_digits(load_lanes(first));
+    }
+#else
+    (void)last;
+    for (; 0 != digits; digits--) {
+        value = value * 10 + (*first++ - '0');
+    }
+#endif
+    return value;
+}
+
+} // namespace
+
+std::size_t
+count_list_values(const arg_view& arg, char delimiter)
+{
+    if (arg.empty()) {
+        return 0;
+    }
+
+    const char* first = arg.data();
+    std::size_t size  = arg.size();
+    std::size_t count = 1;
+    std::size_t pos   = 0;
+#if defined(LOOT_CLP_AVX2) || defined(LOOT_CLP_SSE2)
+    for (; pos + block_size <= size; pos += block_size) {
+        count += bit_count(matches(first + pos, delimiter));
+    }
+#endif
+    for (; pos < size; pos++) {
+        count += delimiter == first[pos] ? 1 : 0;
+    }
+    return count;
+}
+
+bool
+convert_integer_list(const arg_view&    arg,
+                     char               delimiter,
+                     std::int64_t*      buffer,
+                     std::size_t        capacity,
+                     std::size_t&       count,
+                     requirement_error& reason)
+{
+    reason = requirement_error_e value_not_convertible_error;
+    count  = 0;
+
+    const char* first = arg.data();
+    const char* last  = first + arg.size();
+    const char* pos   = first;
+    while (pos != last) {
+        const char* start    = pos;
+        bool        negative = false;
+        if ('+' == *pos || '-' == *pos) {
+            negative = '-' == *pos;
+            pos++;
+        }
+
+        std::size_t digits = count_digits(pos, last - pos);
+        if (0 == digits) {
+            return false;
+        }
+
+        std::int64_t value;
+        if (digits > 19) {
+            // Possibly with leading zeros, leave that to the careful conversion.
+            if (!detail::convert_integer(arg_view(start, pos + digits - start),
+                                         value,
+                                         reason)) {
+                return false;
+            }
+        }
+        else {
+            std::uint64_t magnitude = accumulate(pos, digits, last);
+            std::uint64_t limit     = static_cast<std::uint64_t>(
+                    std::numeric_limits<std::int64_t>::max()) + (negative ? 1 : 0);
+            if (magnitude > limit) {
+                reason = requirement_error_e value_out_of_range_error;
+                return false;
+            }
+
+            value = negative && 0 != magnitude
+                  ? -static_cast<std::int64_t>(magnitude - 1) - 1
+                  : static_cast<std::int64_t>(magnitude);
+        }
+
+        if (count == capacity) {
+            throw std::length_error("loot::clp::convert_integer_list");
+        }
+        buffer[count++] = value;
+
+        // Every integer but the last is followed by a delimiter and another integer.
+        pos += digits;
+        if (pos != last) {
+            if (delimiter != *pos || ++pos == last) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool
+convert_integer_list(const arg_view&            arg,
+                     char                       delimiter,
+                     std::vector<std::int64_t>& values,
+                     requirement_error&         reason)
+{
+    std::size_t size     = values.size();
+    std::size_t capacity = count_list_values(arg, delimiter);
+    values.resize(size + capacity);
+
+    std::size_t count;
+    if (!convert_integer_list(arg, delimiter, values.data() + size, capacity, count,
+                              reason)) {
+        values.resize(size);
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace clp
+} // namespace loot
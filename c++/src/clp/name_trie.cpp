@@ -0,0 +1,181 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <clp/name_trie.h>
+
+#include <algorithm>
+
+namespace loot {
+namespace clp {
+namespace detail {
+
+const std::uint32_t name_trie::none;
+
+void
+name_trie::build(const std::vector<std::string>& short_names,
+                 const std::vector<std::string>& long_names)
+{
+    nodes.clear();
+    labels.clear();
+    targets.clear();
+
+    std::vector<entry> sorted;
+    for (std::size_t o = 0; o < long_names.size(); o++) {
+        if (!short_names[o].empty()) {
+            entry e = {&short_names[o], static_cast<std::uint32_t>(o), false};
+            sorted.push_back(e);
+        }
+        if (!long_names[o].empty()) {
+            entry e = {&long_names[o], static_cast<std::uint32_t>(o), true};
+            sorted.push_back(e);
+        }
+    }
+    if (sorted.empty()) {
+        return;
+    }
+
+    // Names sharing a prefix become neighbours, shorter ones first. Equal names keep the
+    // order of their options, so the first of them wins like with the hash index.
+    std::stable_sort(std::begin(sorted), std::end(sorted),
+                     [](const entry& lhs, const entry& rhs) {
+        return *lhs.name < *rhs.name;
+    });
+
+    add(sorted, 0, sorted.size(), 0);
+}
+
+std::uint32_t
+name_trie::add(const std::vector<entry>& sorted,
+               std::size_t               first,
+               std::size_t               last,
+               std::size_t               depth)
+{
+    std::uint32_t index = static_cast<std::uint32_t>(nodes.size());
+    node          n     = {0, 0, none, none, 0};
+
+    std::size_t p = first;
+    for ( ; p < last && sorted[p].name->size() == depth; p++) {
+        if (none == n.exact) {
+            n.exact = sorted[p].ordinal;
+        }
+    }
+    for (std::size_t e = first; e < last; e++) {
+        if (sorted[e].is_long) {
+            n.first_prefixed = std::min(n.first_prefixed, sorted[e].ordinal);
+            n.num_prefixed++;
+        }
+    }
+
+    // The children are the groups of names with the same character at `depth`. Their
+    // edges are reserved before descending, so they end up next to each other.
+    n.first_edge = static_cast<std::uint32_t>(labels.size());
+    for (std::size_t e = p; e < last; e++) {
+        if (e == p || (*sorted[e].name)[depth] != (*sorted[e - 1].name)[depth]) {
+            labels.push_back((*sorted[e].name)[depth]);
+            targets.push_back(none);
+            n.num_edges++;
+        }
+    }
+    nodes.push_back(n);
+
+    std::uint32_t edge = n.first_edge;
+    for (std::size_t group = p; group < last; edge++) {
+        std::size_t end = group;
+        while (end < last && (*sorted[end].name)[depth] == (*sorted[group].name)[depth]) {
+            end++;
+        }
+
+        // Adding the child grows the arrays, take no reference into them before.
+        std::uint32_t child = add(sorted, group, end, depth + 1);
+        targets[edge]       = child;
+        group               = end;
+    }
+
+    return index;
+}
+
+name_trie::match
+name_trie::find(const arg_view& name, bool abbreviate, std::size_t& ordinal) const
+{
+    if (nodes.empty() || name.empty()) {
+        return no_match;
+    }
+
+    std::uint32_t current = 0;
+    for (std::size_t c = 0; c < name.size(); c++) {
+        const node&   n     = nodes[current];
+        const char*   first = &labels[0] + n.first_edge;
+        const char*   last  = first + n.num_edges;
+        unsigned char label = static_cast<unsigned char>(name[c]);
+
+        // Edges are sorted like std::string sorts, i.e. by unsigned characters. Most
+        // nodes have few of them, which are faster to scan than to bisect.
+        const char* edge = first;
+        if (n.num_edges <= 8) {
+            while (edge != last && static_cast<unsigned char>(*edge) != label) {
+                edge++;
+            }
+        }
+        else {
+            edge = std::lower_bound(first, last, name[c], [](char lhs, char rhs) {
+                return static_cast<unsigned char>(lhs) < static_cast<unsigned char>(rhs);
+            });
+            if (edge != last && static_cast<unsigned char>(*edge) != label) {
+                edge = last;
+            }
+        }
+        if (edge == last) {
+            return no_match;
+        }
+
+        current = targets[n.first_edge + (edge - first)];
+    }
+
+    const node& n = nodes[current];
+    if (none != n.exact) {
+        ordinal = n.exact;
+        return exact_match;
+    }
+    if (!abbreviate || 0 == n.num_prefixed) {
+        return no_match;
+    }
+
+    ordinal = n.first_prefixed;
+    return 1 == n.num_prefixed ? prefix_match : ambiguous_match;
+}
+
+bool
+name_trie::empty() const
+{
+    return nodes.empty();
+}
+
+} // namespace detail
+} // namespace clp
+} // namespace loot
@@ -30,9 +30,60 @@
 #include <clp/option.h>
 #include <clp/args.h>
 
+#include <algorithm>
+#include <string>
+
 namespace loot {
 namespace clp {
 
+namespace {
+
+/*!
+    Compares `lhs_first + lhs_second` with `rhs_first + rhs_second` like `std::string`
+    would, without building the concatenations.
+
+    @return
+    Returns a negative value if the left side is lesser, zero if both are equal and a
+    positive value otherwise.
+*/
+int
+compare_joined(const std::string& lhs_first, const std::string& lhs_second,
+               const std::string& rhs_first, const std::string& rhs_second)
+{
+    const std::string* lhs[] = {&lhs_first, &lhs_second};
+    const std::string* rhs[] = {&rhs_first, &rhs_second};
+
+    // Walk both sides in chunks that don't cross the end of a part on either side.
+    std::size_t l = 0, l_pos = 0;
+    std::size_t r = 0, r_pos = 0;
+    for (;;) {
+        while (l < 2 && l_pos == lhs[l]->size()) {
+            l++;
+            l_pos = 0;
+        }
+        while (r < 2 && r_pos == rhs[r]->size()) {
+            r++;
+            r_pos = 0;
+        }
+        if (2 == l || 2 == r) {
+            return (2 == l ? 0 : 1) - (2 == r ? 0 : 1);
+        }
+
+        std::size_t count = std::min(lhs[l]->size() - l_pos, rhs[r]->size() - r_pos);
+        int cmp = std::char_traits<char>::compare(lhs[l]->data() + l_pos,
+                                                  rhs[r]->data() + r_pos,
+                                                  count);
+        if (0 != cmp) {
+            return cmp;
+        }
+
+        l_pos += count;
+        r_pos += count;
+    }
+}
+
+} // namespace
+
 // The only exception to the require-delegating_constructors rule. The default 
 // constructor is too important to be left out
 option::option()
@@ -40,6 +91,8 @@ option::option()
     this->type                = option_type_e optional_option;
     this->constraint          = value_constraint_e unlimited_num_values;
     this->num_expected_values = 0;
+    this->conversion          = value_type_e text_value;
+    this->delimiter           = ',';
 }
 
 #ifdef HAS_CXX11_DELEG_CONSTRUCTOR
@@ -68,6 +121,8 @@ option::option(
     this->constraint          = constraint;
     this->num_expected_values = num_expected_values;
     this->description         = description;
+    this->conversion          = value_type_e text_value;
+    this->delimiter           = ',';
 }
 
 option::option(const option& other)
@@ -89,6 +144,9 @@ option::operator=(const option& other)
     constraint          = other.constraint;
     num_expected_values = other.num_expected_values;
     description         = other.description;
+    conversion          = other.conversion;
+    choices             = other.choices;
+    delimiter           = other.delimiter;
     return *this;
 }
 
@@ -101,6 +159,9 @@ option::operator=(option&& temp)
     constraint          = temp.constraint;
     num_expected_values = temp.num_expected_values;
     description         = std::move(temp.description);
+    conversion          = temp.conversion;
+    choices             = std::move(temp.choices);
+    delimiter           = temp.delimiter;
     return *this;
 }
 
@@ -113,7 +174,7 @@ option::operator==(const option& other) const
 bool
 option::operator<(const option& other) const
 {
-    return (short_name + long_name) < (other.short_name + other.long_name);
+    return compare_joined(short_name, long_name, other.short_name, other.long_name) < 0;
 }
 
 bool
@@ -0,0 +1,162 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <clp/response_file.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#ifdef HAVE_SYS_MMAN_H
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace loot {
+namespace clp {
+
+response_file::response_file(const std::string& path)
+{
+    this->data   = 0;
+    this->size   = 0;
+    this->mapped = false;
+    this->opened = false;
+
+#ifdef HAVE_SYS_MMAN_H
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (-1 == fd) {
+        return;
+    }
+
+    struct stat info;
+    if (0 == ::fstat(fd, &info) && S_ISREG(info.st_mode)) {
+        opened = true;
+        size = static_cast<std::size_t>(info.st_size);
+
+        // Mapping zero bytes fails, an empty file simply has no arguments.
+        if (0 != size) {
+            void* addr = ::mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (MAP_FAILED == addr) {
+                opened = false;
+                size = 0;
+            }
+            else {
+                ::madvise(addr, size, MADV_SEQUENTIAL);
+                data   = static_cast<const char*>(addr);
+                mapped = true;
+            }
+        }
+    }
+
+    // The mapping stays valid after the descriptor is closed.
+    ::close(fd);
+#else
+    std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+    if (!in) {
+        return;
+    }
+
+    buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    opened = true;
+    size = buffer.size();
+    data = buffer.empty() ? 0 : &buffer[0];
+#endif
+
+    split();
+}
+
+response_file::~response_file()
+{
+#ifdef HAVE_SYS_MMAN_H
+    if (mapped) {
+        ::munmap(const_cast<char*>(data), size);
+    }
+#endif
+}
+
+bool
+response_file::is_open() const
+{
+    return opened;
+}
+
+arg_span
+response_file::arguments() const
+{
+    return tokens.empty() ? arg_span() : arg_span(&tokens[0], tokens.size());
+}
+
+void
+response_file::split()
+{
+    if (0 == size) {
+        return;
+    }
+
+    const char* end = data + size;
+    if (0 != std::memchr(data, '\0', size)) {
+        // Like xargs -0: Every '\0' terminates an argument, empty ones included. Only
+        // the last argument may lack its terminator.
+        const char* begin = data;
+        while (begin < end) {
+            const char* stop = static_cast<const char*>(
+                    std::memchr(begin, '\0', end - begin));
+            if (0 == stop) {
+                stop = end;
+            }
+
+            tokens.push_back(arg_view(begin, stop - begin));
+            begin = stop + 1;
+        }
+        return;
+    }
+
+    const char* begin = data;
+    while (begin < end) {
+        const char* stop = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+        if (0 == stop) {
+            stop = end;
+        }
+
+        const char* last = stop;
+        if (last > begin && '\r' == *(last - 1)) {
+            last--;
+        }
+        if (last > begin) {
+            tokens.push_back(arg_view(begin, last - begin));
+        }
+
+        begin = stop + 1;
+    }
+}
+
+} // namespace clp
+} // namespace loot
@@ -28,20 +28,41 @@
 */
 
 #include <clp/result.h>
+#include <clp/schema.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
 
 namespace loot {
 namespace clp {
 
 result::result()
 {
+    source          = 0;
+    storage         = &own;
+    tokens          = 0;
+    num_tokens      = 0;
+    infos           = 0;
+    occurrences     = 0;
+    num_occurrences = 0;
+    records         = 0;
+    num_records     = 0;
+    max_records     = 0;
+    unknowns        = 0;
+    num_unknowns    = 0;
+    max_unknowns    = 0;
 }
 
 result::result(const result& other)
+    : result()
 {
     *this = other;
 }
 
 result::result(result&& temp)
+    : result()
 {
     *this = std::move(temp);
 }
@@ -49,21 +70,289 @@ result::result(result&& temp)
 result&
 result::operator =(const result& other)
 {
-    errors = other.errors;
+    if (this == &other) {
+        return *this;
+    }
+
+    // A copy always gets its own memory, even if other lives in somebody else's arena.
+    errors    = other.errors;
+    source    = other.source;
+    files     = other.files;
+    layers    = other.layers;
+    remainder = other.remainder;
+    storage   = &own;
+
+    std::size_t num_converted_bytes = 0;
+    for (std::size_t o = 0; o < other.num_occurrences; o++) {
+        const occurrence& occ = other.occurrences[o];
+        if (0 != occ.converted) {
+            num_converted_bytes += occ.num_converted
+                                 * detail::value_size(other.conversion(&occ))
+                                 + alignof(std::int64_t);
+        }
+    }
+    prepare(other.num_tokens, other.num_occurrences, other.num_records,
+            num_converted_bytes);
+
+    std::copy(other.tokens, other.tokens + other.num_tokens, tokens);
+    std::copy(other.infos, other.infos + other.num_tokens, infos);
+    std::copy(other.occurrences, other.occurrences + other.num_occurrences, occurrences);
+    std::copy(other.records, other.records + other.num_records, records);
+    num_records = other.num_records;
+
+    if (0 != other.num_unknowns) {
+        unknowns     = storage->allocate_array<std::size_t>(other.num_unknowns);
+        max_unknowns = other.num_unknowns;
+        std::copy(other.unknowns, other.unknowns + other.num_unknowns, unknowns);
+    }
+    num_unknowns = other.num_unknowns;
+
+    // The converted values live in the arena of other, too.
+    for (std::size_t o = 0; o < num_occurrences; o++) {
+        occurrence& occ = occurrences[o];
+        if (0 != occ.converted) {
+            std::size_t size = occ.num_converted * detail::value_size(conversion(&occ));
+            void* values = storage->allocate(size, alignof(std::int64_t));
+            std::memcpy(values, occ.converted, size);
+            occ.converted = values;
+        }
+    }
     return *this;
 }
 
 result&
 result::operator =(result&& temp)
 {
-    errors = std::move(temp.errors);
+    errors          = std::move(temp.errors);
+    source          = temp.source;
+    own             = std::move(temp.own);
+    storage         = temp.storage == &temp.own ? &own : temp.storage;
+    tokens          = temp.tokens;
+    num_tokens      = temp.num_tokens;
+    infos           = temp.infos;
+    occurrences     = temp.occurrences;
+    num_occurrences = temp.num_occurrences;
+    records         = temp.records;
+    num_records     = temp.num_records;
+    max_records     = temp.max_records;
+    unknowns        = temp.unknowns;
+    num_unknowns    = temp.num_unknowns;
+    max_unknowns    = temp.max_unknowns;
+    files           = std::move(temp.files);
+    layers          = std::move(temp.layers);
+    remainder       = temp.remainder;
+
+    temp.storage         = &temp.own;
+    temp.tokens          = 0;
+    temp.num_tokens      = 0;
+    temp.infos           = 0;
+    temp.occurrences     = 0;
+    temp.num_occurrences = 0;
+    temp.records         = 0;
+    temp.num_records     = 0;
+    temp.max_records     = 0;
+    temp.unknowns        = 0;
+    temp.num_unknowns    = 0;
+    temp.max_unknowns    = 0;
     return *this;
 }
 
 bool
 result::good() const
 {
-    return errors.empty();
+    return errors.empty() && 0 == num_records;
+}
+
+std::size_t
+result::error_count() const
+{
+    return num_records;
+}
+
+const error_ref&
+result::error_at(std::size_t pos) const
+{
+    if (pos >= num_records) {
+        throw std::out_of_range("loot::clp::result::error_at");
+    }
+    return records[pos];
+}
+
+std::size_t
+result::unknown_count() const
+{
+    return num_unknowns;
+}
+
+arg_view
+result::unknown_at(std::size_t pos) const
+{
+    if (pos >= num_unknowns) {
+        throw std::out_of_range("loot::clp::result::unknown_at");
+    }
+    return tokens[unknowns[pos]];
+}
+
+std::vector<std::string>
+result::suggestions(std::size_t pos, std::size_t max) const
+{
+    arg_view arg = unknown_at(pos);
+    return source->suggest(arg.sub(infos[unknowns[pos]].dashes), max);
+}
+
+argv_span
+result::forwarded() const
+{
+    return remainder;
+}
+
+bool
+result::has_option(const std::string& name) const
+{
+    return 0 != find_occurrence(name);
+}
+
+std::vector<std::string>
+result::values_from_option(const std::string& name) const
+{
+    arg_span views = view_from_option(name);
+
+    std::vector<std::string> values;
+    values.reserve(views.size());
+    for (auto iter = std::begin(views); iter != std::end(views); iter++) {
+        values.push_back(iter->str());
+    }
+
+    return values;
+}
+
+arg_span
+result::view_from_option(const std::string& name) const
+{
+    const occurrence* occ = find_occurrence(name);
+    if (0 != occ && 0 != occ->count) {
+        return arg_span(&tokens[occ->first], occ->count);
+    }
+
+    return arg_span();
+}
+
+bool
+result::has(option_handle handle) const
+{
+    return 0 != find_occurrence(handle);
+}
+
+arg_span
+result::values(option_handle handle) const
+{
+    const occurrence* occ = find_occurrence(handle);
+    if (0 != occ && 0 != occ->count) {
+        return arg_span(&tokens[occ->first], occ->count);
+    }
+
+    return arg_span();
+}
+
+value_type
+result::conversion(const occurrence* occ) const
+{
+    return source->conversions[occ - occurrences];
+}
+
+const result::occurrence*
+result::find_occurrence(option_handle handle) const
+{
+    if (0 == source) {
+        return 0;
+    }
+
+    std::size_t ordinal = source->ordinal(handle);
+    if (schema::npos == ordinal || !occurrences[ordinal].found) {
+        return 0;
+    }
+
+    return &occurrences[ordinal];
+}
+
+const result::occurrence*
+result::find_occurrence(const std::string& name) const
+{
+    if (0 == source) {
+        return 0;
+    }
+
+    std::size_t ordinal = source->find(name);
+    if (schema::npos == ordinal || !occurrences[ordinal].found) {
+        return 0;
+    }
+
+    return &occurrences[ordinal];
+}
+
+void
+result::prepare(std::size_t num_tokens,
+                std::size_t num_options,
+                std::size_t num_errors,
+                std::size_t num_converted_bytes)
+{
+    // Own memory is sized to fit everything into a single block right away.
+    if (storage == &own) {
+        own = arena(num_tokens * sizeof(arg_view)
+                  + num_tokens * sizeof(detail::arg_info)
+                  + num_options * sizeof(occurrence)
+                  + num_errors * sizeof(error_ref)
+                  + num_converted_bytes
+                  + 4 * alignof(std::size_t));
+    }
+
+    this->tokens          = storage->allocate_array<arg_view>(num_tokens);
+    this->num_tokens      = num_tokens;
+    this->infos           = storage->allocate_array<detail::arg_info>(num_tokens);
+    this->occurrences     = storage->allocate_array<occurrence>(num_options);
+    this->num_occurrences = num_options;
+    this->records         = storage->allocate_array<error_ref>(num_errors);
+    this->num_records     = 0;
+    this->max_records     = num_errors;
+    this->unknowns        = 0;
+    this->num_unknowns    = 0;
+    this->max_unknowns    = 0;
+
+    const occurrence none = {0, 0, false, 0, 0};
+    std::fill(occurrences, occurrences + num_options, none);
+}
+
+void
+result::add_error(const option& opt, requirement_error reason)
+{
+    if (num_records == max_records) {
+        // The old array stays behind in the arena until it is reset.
+        std::size_t grown = 0 == max_records ? 8 : max_records * 2;
+        error_ref* larger = storage->allocate_array<error_ref>(grown);
+        std::copy(records, records + num_records, larger);
+        records     = larger;
+        max_records = grown;
+    }
+
+    records[num_records].opt    = &opt;
+    records[num_records].reason = reason;
+    num_records++;
+}
+
+void
+result::add_unknown(std::size_t token)
+{
+    if (num_unknowns == max_unknowns) {
+        // Like errors, the old array stays behind in the arena until it is reset.
+        std::size_t   grown  = 0 == max_unknowns ? 4 : max_unknowns * 2;
+        std::size_t*  larger = storage->allocate_array<std::size_t>(grown);
+        std::copy(unknowns, unknowns + num_unknowns, larger);
+        unknowns     = larger;
+        max_unknowns = grown;
+    }
+
+    unknowns[num_unknowns] = token;
+    num_unknowns++;
 }
 
 } // namespace clp
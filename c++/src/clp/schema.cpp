@@ -0,0 +1,828 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <clp/schema.h>
+#include <clp/classify.h>
+#include <clp/convert.h>
+#include <clp/engine.h>
+#include <clp/name_hash.h>
+#include <clp/schema_image.h>
+#include <algorithm/algorithm.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace loot {
+namespace clp {
+
+const std::size_t schema::npos;
+
+/*!
+    Records the findings of the parse engine in a result.
+*/
+class schema::target
+{
+public:
+    explicit target(result& r, char** argv = 0, int argc = 0)
+        : r(r), argv(argv), argc(argc)
+    {}
+
+    bool found(std::size_t o) const { return r.occurrences[o].found; }
+    std::size_t count(std::size_t o) const { return r.occurrences[o].count; }
+
+    void occur(std::size_t o, std::size_t first, std::size_t count)
+    {
+        r.occurrences[o].found = true;
+        r.occurrences[o].first = first;
+        r.occurrences[o].count = count;
+    }
+
+    bool convert(std::size_t o, requirement_error& reason)
+    {
+        const option& opt = r.source->options[o];
+        switch (r.source->conversions[o]) {
+            case value_type_e integer_value:
+                return convert_all<std::int64_t>(o, reason, detail::convert_integer);
+
+            case value_type_e real_value:
+                return convert_all<double>(o, reason, detail::convert_real);
+
+            case value_type_e boolean_value:
+                return convert_all<bool>(o, reason, detail::convert_boolean);
+
+            case value_type_e enum_value:
+                return convert_all<std::int64_t>(o, reason,
+                        [&opt](const arg_view& arg, std::int64_t& value,
+                               requirement_error& reason) {
+                    return detail::convert_choice(arg, opt.choices, value, reason);
+                });
+
+            case value_type_e integer_list_value:
+                return convert_lists(o, reason);
+
+            default:
+                return true;
+        }
+    }
+
+    void fail(std::size_t o, requirement_error reason)
+    {
+        r.add_error(r.source->options[o], reason);
+    }
+
+    void unknown(std::size_t token)
+    {
+        r.add_unknown(token);
+    }
+
+    void attach(std::size_t token, const arg_view& value)
+    {
+        r.tokens[token] = value;
+    }
+
+    bool pass_through(std::size_t token)
+    {
+        if (!r.source->pass_through || 0 == argv) {
+            return false;
+        }
+
+        // The arguments of response files take the place of their @path argument, the
+        // difference is how far the tokens are shifted against argv.
+        std::ptrdiff_t shift = 0;
+        for (std::size_t f = 0; f < r.files.size(); f++) {
+            std::size_t first = r.files[f].first + shift;
+            std::size_t count = r.files[f].second->arguments().size();
+            if (token < first) {
+                break;
+            }
+            if (token < first + count) {
+                return false; // Not an entry of argv.
+            }
+            shift += static_cast<std::ptrdiff_t>(count) - 1;
+        }
+
+        std::size_t pos = token - shift;
+        r.remainder = argv_span(argv + pos, argc - pos);
+        return true;
+    }
+
+private:
+    /*!
+        Converts all values of an option into an array of `T` in the arena of the result.
+        Nothing is recorded if a value fails to convert.
+    */
+    template<typename T, typename Convert>
+    bool convert_all(std::size_t o, requirement_error& reason, Convert convert)
+    {
+        result::occurrence& occ = r.occurrences[o];
+        if (0 == occ.count) {
+            return true;
+        }
+
+        T* values = r.storage->allocate_array<T>(occ.count);
+        for (std::size_t v = 0; v < occ.count; v++) {
+            if (!convert(r.tokens[occ.first + v], values[v], reason)) {
+                return false;
+            }
+        }
+
+        occ.converted     = values;
+        occ.num_converted = occ.count;
+        return true;
+    }
+
+    /*!
+        Converts the lists of integers in all values of an option into one array in the
+        arena of the result. The lists are counted first to allocate the exact size.
+    */
+    bool convert_lists(std::size_t o, requirement_error& reason)
+    {
+        result::occurrence& occ       = r.occurrences[o];
+        char                delimiter = r.source->options[o].delimiter;
+
+        std::size_t capacity = 0;
+        for (std::size_t v = 0; v < occ.count; v++) {
+            capacity += count_list_values(r.tokens[occ.first + v], delimiter);
+        }
+        if (0 == capacity) {
+            return true;
+        }
+
+        std::int64_t* values = r.storage->allocate_array<std::int64_t>(capacity);
+        std::size_t   total  = 0;
+        for (std::size_t v = 0; v < occ.count; v++) {
+            std::size_t count;
+            if (!convert_integer_list(r.tokens[occ.first + v], delimiter,
+                                      values + total, capacity - total, count, reason)) {
+                return false;
+            }
+            total += count;
+        }
+
+        occ.converted     = values;
+        occ.num_converted = total;
+        return true;
+    }
+
+    result& r;
+    char**  argv;
+    int     argc;
+};
+
+schema::schema(const std::vector<option>& options,
+               bool                       response_files,
+               bool                       abbreviations,
+               bool                       pass_through)
+    : response_files(response_files),
+      abbreviations(abbreviations),
+      pass_through(pass_through)
+{
+    // The order of the options determines the order of errors and of the help text. Sort
+    // their positions to remember where each option came from.
+    std::vector<std::size_t> order(options.size());
+    for (std::size_t o = 0; o < order.size(); o++) {
+        order[o] = o;
+    }
+    std::stable_sort(std::begin(order), std::end(order),
+                     [&options](std::size_t lhs, std::size_t rhs) {
+        return options[lhs] < options[rhs];
+    });
+
+    this->options.reserve(options.size());
+    ordinals.resize(options.size());
+    for (std::size_t o = 0; o < order.size(); o++) {
+        this->options.push_back(options[order[o]]);
+        ordinals[order[o]] = o;
+    }
+
+    build_tables();
+}
+
+schema::schema(const schema& other)
+{
+    *this = other;
+}
+
+schema::schema(schema&& temp)
+{
+    *this = std::move(temp);
+}
+
+schema&
+schema::operator=(const schema& other)
+{
+    options             = other.options;
+    types               = other.types;
+    constraints         = other.constraints;
+    num_expected_values = other.num_expected_values;
+    named               = other.named;
+    conversions         = other.conversions;
+    converts            = other.converts;
+    ordinals            = other.ordinals;
+    names               = other.names;
+    index               = other.index;
+    trie                = other.trie;
+    suggester           = other.suggester;
+    response_files      = other.response_files;
+    abbreviations       = other.abbreviations;
+    pass_through        = other.pass_through;
+    return *this;
+}
+
+schema&
+schema::operator=(schema&& temp)
+{
+    options             = std::move(temp.options);
+    types               = std::move(temp.types);
+    constraints         = std::move(temp.constraints);
+    num_expected_values = std::move(temp.num_expected_values);
+    named               = std::move(temp.named);
+    conversions         = std::move(temp.conversions);
+    converts            = temp.converts;
+    ordinals            = std::move(temp.ordinals);
+    names               = std::move(temp.names);
+    index               = std::move(temp.index);
+    trie                = std::move(temp.trie);
+    suggester           = std::move(temp.suggester);
+    response_files      = temp.response_files;
+    abbreviations       = temp.abbreviations;
+    pass_through        = temp.pass_through;
+    return *this;
+}
+
+namespace {
+
+/*!
+    Passed by the variants of `parse` that only read the command line.
+*/
+const std::vector<std::shared_ptr<const settings>> no_layers;
+
+/*!
+    Counts the words of a value, which are separated by spaces and tabs.
+*/
+std::size_t
+count_words(const arg_view& value)
+{
+    std::size_t count = 0;
+    bool        blank = true;
+    for (std::size_t c = 0; c < value.size(); c++) {
+        bool is_blank = ' ' == value[c] || '\t' == value[c];
+        if (blank && !is_blank) {
+            count++;
+        }
+        blank = is_blank;
+    }
+    return count;
+}
+
+} // namespace
+
+result
+schema::parse(int argc, char* argv[]) const
+{
+    return parse(argc, argv, no_layers);
+}
+
+result
+schema::parse(int                                                 argc,
+              char*                                               argv[],
+              const std::vector<std::shared_ptr<const settings>>& layers) const
+{
+    result r;
+    parse(argc, argv, layers, r);
+
+    // Results in their own memory also provide the errors with copies of the options.
+    r.errors.reserve(r.num_records);
+    for (std::size_t e = 0; e < r.num_records; e++) {
+        r.errors.push_back(error(*r.records[e].opt, r.records[e].reason));
+    }
+
+    return r;
+}
+
+result
+schema::parse(int argc, char* argv[], arena& storage) const
+{
+    result r;
+    r.storage = &storage;
+    parse(argc, argv, no_layers, r);
+    return r;
+}
+
+void
+schema::parse(int                                                 argc,
+              char*                                               argv[],
+              const std::vector<std::shared_ptr<const settings>>& layers,
+              result&                                             r) const
+{
+    // Nothing behind "--" is looked at, not even classified. It is forwarded as it is.
+    // Options passed through in front of it are forwarded up to the end of argv, too.
+    int num_args = argc;
+    r.remainder  = argv_span();
+    for (int c = 1; c < argc; c++) {
+        if ('-' == argv[c][0] && '-' == argv[c][1] && '\0' == argv[c][2]) {
+            r.remainder = argv_span(argv + c + 1, argc - c - 1);
+            argc = c;
+            break;
+        }
+    }
+
+    // Response files are mapped first, their arguments extend the command line.
+    std::size_t num_tokens = argc;
+    r.files.clear();
+    if (response_files) {
+        for (int c = 1; c < argc; c++) {
+            if ('@' != argv[c][0] || '\0' == argv[c][1]) {
+                continue;
+            }
+
+            std::shared_ptr<const response_file> file(new response_file(argv[c] + 1));
+            if (file->is_open()) {
+                num_tokens += file->arguments().size() - 1;
+                r.files.push_back(std::make_pair(static_cast<std::size_t>(c), file));
+            }
+        }
+    }
+
+    // Settings of other sources are appended to the command line, each takes one token
+    // per word of its value or one for its key if that names no option.
+    std::size_t num_settings = 0;
+    for (std::size_t l = 0; l < layers.size(); l++) {
+        const std::vector<setting>& entries = layers[l]->entries();
+        for (std::size_t e = 0; e < entries.size(); e++) {
+            num_settings += std::max<std::size_t>(1, count_words(entries[e].value));
+        }
+    }
+    r.layers = layers;
+
+    // Two errors per option at most, unless there are errors with the options themselves.
+    // Converted values take up to eight bytes per argument, plus alignment per option.
+    // Lists of integers may need more, the arena grows for them.
+    r.source = this;
+    r.prepare(num_tokens + num_settings, options.size(), 2 * options.size(),
+              converts ? (num_tokens + num_settings) * sizeof(std::int64_t)
+                       + options.size() * alignof(std::int64_t) : 0);
+    r.num_tokens = num_tokens;
+
+    // Take the command line apart and classify every argument once. The views point into
+    // argv or into the mapped response files, nothing is copied.
+    if (r.files.empty()) {
+        detail::classify(argv, argc, r.tokens, r.infos);
+    }
+    else {
+        std::size_t token = 0;
+        std::size_t f     = 0;
+        for (int c = 0; c < argc; c++) {
+            if (f < r.files.size() && r.files[f].first == static_cast<std::size_t>(c)) {
+                arg_span args = r.files[f].second->arguments();
+                std::copy(std::begin(args), std::end(args), r.tokens + token);
+                detail::classify(r.tokens + token, args.size(), r.infos + token);
+                token += args.size();
+                f++;
+            }
+            else {
+                detail::classify(argv + c, 1, r.tokens + token, r.infos + token);
+                token++;
+            }
+        }
+    }
+
+    table  t(*this);
+    target s(r, argv, num_args);
+    detail::dispatch(detail::classified_span(r.tokens, r.infos, r.num_tokens), t, s);
+    if (!layers.empty()) {
+        merge(layers, r);
+    }
+    detail::validate(t, s);
+}
+
+void
+schema::merge(const std::vector<std::shared_ptr<const settings>>& layers, result& r) const
+{
+    const detail::arg_info value = {detail::no_equals, 0, false};
+
+    // An option is decided by the command line or by the first source that sets it, even
+    // if that source turns it off.
+    std::vector<bool> decided(options.size());
+    for (std::size_t o = 0; o < options.size(); o++) {
+        decided[o] = r.occurrences[o].found;
+    }
+
+    target s(r);
+    for (std::size_t l = 0; l < layers.size(); l++) {
+        const std::vector<setting>& entries = layers[l]->entries();
+        for (std::size_t e = 0; e < entries.size(); e++) {
+            const setting& item    = entries[e];
+            std::size_t    ordinal = find(item.key);
+            if (npos != ordinal && options[ordinal].long_name != item.key) {
+                ordinal = npos; // Short names are too terse for keys.
+            }
+            if (npos == ordinal) {
+                r.tokens[r.num_tokens] = item.key;
+                r.infos[r.num_tokens]  = value;
+                s.unknown(r.num_tokens++);
+                continue;
+            }
+            if (decided[ordinal]) {
+                continue;
+            }
+            decided[ordinal] = true;
+
+            if (value_constraint_e no_values == constraints[ordinal]) {
+                bool              on = true;
+                requirement_error reason;
+                if (!item.value.empty()
+                        && !detail::convert_boolean(item.value, on, reason)) {
+                    s.fail(ordinal, reason);
+                }
+                else if (on) {
+                    s.occur(ordinal, r.num_tokens, 0);
+                }
+                continue;
+            }
+
+            // A single value is taken as it is, others are split into words.
+            std::size_t first = r.num_tokens;
+            if (value_constraint_e exact_num_values == constraints[ordinal]
+                    && 1 == num_expected_values[ordinal]) {
+                if (!item.value.empty()) {
+                    r.tokens[r.num_tokens] = item.value;
+                    r.infos[r.num_tokens++] = value;
+                }
+            }
+            else {
+                const arg_view& text = item.value;
+                for (std::size_t c = 0; c < text.size(); ) {
+                    while (c < text.size() && (' ' == text[c] || '\t' == text[c])) {
+                        c++;
+                    }
+                    std::size_t start = c;
+                    while (c < text.size() && ' ' != text[c] && '\t' != text[c]) {
+                        c++;
+                    }
+                    if (c > start) {
+                        r.tokens[r.num_tokens] = text.sub(start, c - start);
+                        r.infos[r.num_tokens++] = value;
+                    }
+                }
+            }
+            s.occur(ordinal, first, r.num_tokens - first);
+        }
+    }
+}
+
+bool
+schema::expands_response_files() const
+{
+    return response_files;
+}
+
+bool
+schema::allows_abbreviations() const
+{
+    return abbreviations;
+}
+
+bool
+schema::passes_through_unknown() const
+{
+    return pass_through;
+}
+
+std::size_t
+schema::size() const
+{
+    return options.size();
+}
+
+const option&
+schema::at(std::size_t ordinal) const
+{
+    return options.at(ordinal);
+}
+
+std::size_t
+schema::find(const arg_view& name) const
+{
+    if (index.empty()) {
+        return npos;
+    }
+
+    std::uint64_t hash = detail::hash_name(name);
+    std::size_t   mask = index.size() - 1;
+    for (std::size_t slot = hash & mask; ; slot = (slot + 1) & mask) {
+        const name_entry& entry = index[slot];
+        if (npos == entry.ordinal) {
+            break; // A free slot ends the probe sequence.
+        }
+        if (entry.hash == hash
+                && entry.length == name.size()
+                && 0 == std::memcmp(&names[entry.offset], name.data(), name.size())) {
+            return entry.ordinal;
+        }
+    }
+
+    return npos;
+}
+
+std::size_t
+schema::find(const arg_view& name, int start, bool& ambiguous) const
+{
+    ambiguous = false;
+    if (!abbreviations || 2 != start) {
+        return find(name);
+    }
+
+    std::size_t ordinal;
+    switch (trie.find(name, true, ordinal)) {
+        case detail::name_trie::exact_match:
+        case detail::name_trie::prefix_match:
+            return ordinal;
+
+        case detail::name_trie::ambiguous_match:
+            ambiguous = true;
+            return ordinal;
+
+        default:
+            return npos;
+    }
+}
+
+std::vector<std::string>
+schema::suggest(const arg_view& name, std::size_t max) const
+{
+    std::vector<detail::name_suggester::match> matches;
+    suggester.suggest(name, max, matches);
+
+    std::vector<std::string> names;
+    for (std::size_t m = 0; m < matches.size(); m++) {
+        const option& opt = options[matches[m].ordinal];
+        names.push_back(matches[m].is_long ? "--" + opt.long_name : "-" + opt.short_name);
+    }
+    return names;
+}
+
+std::size_t
+schema::ordinal(option_handle handle) const
+{
+    return handle.position() < ordinals.size() ? ordinals[handle.position()] : npos;
+}
+
+std::vector<char>
+schema::serialize() const
+{
+    // The names are stored like in `names`, so the offsets of the index stay the same.
+    // The descriptions follow them.
+    std::vector<detail::image_option> records(options.size());
+    std::vector<char>                 strings(names);
+    std::uint32_t                     offset = 0;
+    for (std::size_t o = 0; o < options.size(); o++) {
+        const option& opt = options[o];
+        if (value_type_e text_value != opt.conversion) {
+            throw std::invalid_argument("loot::clp::schema::serialize");
+        }
+
+        detail::image_option& record = records[o];
+        std::memset(&record, 0, sizeof(record));
+        record.short_offset        = offset;
+        record.short_length        = static_cast<std::uint32_t>(opt.short_name.size());
+        offset                    += record.short_length;
+        record.long_offset         = offset;
+        record.long_length         = static_cast<std::uint32_t>(opt.long_name.size());
+        offset                    += record.long_length;
+        record.description_offset  = static_cast<std::uint32_t>(strings.size());
+        record.description_length  = static_cast<std::uint32_t>(opt.description.size());
+        record.num_expected_values = num_expected_values[o];
+        record.type                = static_cast<std::uint8_t>(types[o]);
+        record.constraint          = static_cast<std::uint8_t>(constraints[o]);
+        record.named               = named[o];
+        strings.insert(std::end(strings), std::begin(opt.description),
+                       std::end(opt.description));
+    }
+
+    std::size_t strings_at = sizeof(detail::image_header)
+                           + records.size() * sizeof(detail::image_option)
+                           + index.size() * sizeof(detail::image_entry)
+                           + detail::image_padded(ordinals.size() * sizeof(std::uint32_t));
+    if (strings.size() > 0xFFFFFFFFu) {
+        throw std::length_error("loot::clp::schema::serialize");
+    }
+
+    std::vector<char> image(strings_at + strings.size(), '\0');
+    char*             pos = image.data();
+
+    detail::image_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, detail::image_magic, sizeof(header.magic));
+    header.byte_order   = detail::image_byte_order;
+    header.version      = detail::image_version;
+    header.num_options  = static_cast<std::uint32_t>(options.size());
+    header.index_size   = static_cast<std::uint32_t>(index.size());
+    header.num_ordinals = static_cast<std::uint32_t>(ordinals.size());
+    header.strings_size = static_cast<std::uint32_t>(strings.size());
+    header.total_size   = image.size();
+    std::memcpy(pos, &header, sizeof(header));
+    pos += sizeof(header);
+
+    if (!records.empty()) {
+        std::memcpy(pos, records.data(), records.size() * sizeof(detail::image_option));
+        pos += records.size() * sizeof(detail::image_option);
+    }
+
+    for (std::size_t slot = 0; slot < index.size(); slot++) {
+        detail::image_entry entry;
+        std::memset(&entry, 0, sizeof(entry));
+        entry.hash    = index[slot].hash;
+        entry.offset  = index[slot].offset;
+        entry.length  = index[slot].length;
+        entry.ordinal = npos == index[slot].ordinal
+                      ? detail::image_free_slot
+                      : static_cast<std::uint32_t>(index[slot].ordinal);
+        std::memcpy(pos, &entry, sizeof(entry));
+        pos += sizeof(entry);
+    }
+
+    for (std::size_t o = 0; o < ordinals.size(); o++) {
+        std::uint32_t ordinal = static_cast<std::uint32_t>(ordinals[o]);
+        std::memcpy(pos, &ordinal, sizeof(ordinal));
+        pos += sizeof(ordinal);
+    }
+
+    if (!strings.empty()) {
+        std::memcpy(image.data() + strings_at, strings.data(), strings.size());
+    }
+    return image;
+}
+
+void
+schema::print_help(std::ostream& out, bool newline) const
+{
+    // We have to loop through the options twice. The first loop is to find the longest
+    // option so we can calculate the required whitespace. The second loop then prints
+    // the options.
+    int max = 0;
+    loot::algorithm::for_each(options, [&max](const option& item) {
+        int optlen = item.short_name.length() + item.long_name.length();
+        max = optlen > max ? optlen : max;
+    });
+    
+    if (!options.empty()) {
+        out << "Options" << std::endl;
+    }
+    
+    loot::algorithm::for_each(options, 
+                              [max, &out, newline](const option& item) {
+        int posfix = 0;
+        if (!item.short_name.empty()) {
+            out << "-" << item.short_name;
+            posfix += 1;
+        }
+        
+        if (!item.long_name.empty()) {
+            if (!item.short_name.empty()) {
+                out << " / ";
+                posfix += 3;
+            }
+            out << "--" << item.long_name;
+            posfix += 2;
+        }
+                
+        // The "6" comes from the hyphens, the "/" and the spaces between. The "3" is
+        // from the additional space after the options.
+       int descstart = max + 6 + 3;
+        
+        // Print whitespace until we have max + three additional spaces chars
+        int loops = descstart
+                - item.short_name.length()
+                - item.long_name.length()
+                - posfix;
+        for (int c = 0; c < loops; c++) {
+            out << " ";
+        }
+        
+        // Now some details about the option
+        if (!item.description.empty()) {
+            out << item.description << std::endl;
+            // Move the cursor to the start of the description.
+            for (int c = 0; c < descstart; c++) {
+                out << " ";
+            }
+        }
+        
+        switch (item.constraint) {
+            case value_constraint_e exact_num_values:
+                out << "(" << item.num_expected_values << " value(s) expected)";
+                break;
+                
+            case value_constraint_e up_to_num_values:
+                out << "(between 1 and " << item.num_expected_values << " values)";
+                break;
+
+            case value_constraint_e unlimited_num_values:
+                out << "(unlimited number of values)";
+                break;
+                
+            case value_constraint_e no_values:
+                out << "(no value expected)";
+                break;
+        }
+        
+        out << std::endl;
+        if (newline) {
+            out << std::endl;
+        }
+    });
+}
+
+void
+schema::build_tables()
+{
+    types.clear();
+    constraints.clear();
+    num_expected_values.clear();
+    named.clear();
+    conversions.clear();
+    names.clear();
+    converts = false;
+
+    std::size_t size = 4;
+    while (size < 4 * options.size()) {
+        size *= 2;
+    }
+
+    const name_entry free_slot = {0, 0, 0, npos};
+    index.assign(size, free_slot);
+
+    for (std::size_t o = 0; o < options.size(); o++) {
+        const option& opt = options[o];
+        types.push_back(opt.type);
+        constraints.push_back(opt.constraint);
+        num_expected_values.push_back(opt.num_expected_values);
+        named.push_back(opt.short_name.empty() && opt.long_name.empty() ? 0 : 1);
+        conversions.push_back(opt.conversion);
+        converts = converts || value_type_e text_value != opt.conversion;
+
+        const std::string* option_names[] = {&opt.short_name, &opt.long_name};
+        for (std::size_t n = 0; n < 2; n++) {
+            const std::string& name = *option_names[n];
+            if (name.empty()) {
+                continue;
+            }
+
+            name_entry entry;
+            entry.hash    = detail::hash_name(name);
+            entry.offset  = static_cast<std::uint32_t>(names.size());
+            entry.length  = static_cast<std::uint32_t>(name.length());
+            entry.ordinal = o;
+            names.insert(std::end(names), std::begin(name), std::end(name));
+
+            std::size_t slot = entry.hash & (size - 1);
+            while (npos != index[slot].ordinal) {
+                slot = (slot + 1) & (size - 1);
+            }
+            index[slot] = entry;
+        }
+    }
+
+    std::vector<std::string> short_names;
+    std::vector<std::string> long_names;
+    for (std::size_t o = 0; o < options.size(); o++) {
+        short_names.push_back(options[o].short_name);
+        long_names.push_back(options[o].long_name);
+    }
+    suggester.build(short_names, long_names);
+    if (abbreviations) {
+        trie.build(short_names, long_names);
+    }
+}
+
+} // namespace clp
+} // namespace loot
@@ -0,0 +1,388 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <clp/schema_image.h>
+#include <clp/name_hash.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef HAVE_SYS_MMAN_H
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace loot {
+namespace clp {
+
+const std::size_t schema_image::npos;
+
+/*!
+    Presents the options of an image to the parse engine.
+*/
+class schema_image::table
+{
+public:
+    explicit table(const schema_image& s)
+        : s(s)
+    {}
+
+    std::size_t size() const { return s.num_options; }
+    std::size_t find(const arg_view& name) const { return s.find(name); }
+    bool has_names(std::size_t o) const { return 0 != s.options[o].named; }
+
+    option_type type(std::size_t o) const
+    {
+        return static_cast<option_type>(s.options[o].type);
+    }
+
+    value_constraint constraint(std::size_t o) const
+    {
+        return static_cast<value_constraint>(s.options[o].constraint);
+    }
+
+    std::size_t num_expected_values(std::size_t o) const
+    {
+        return s.options[o].num_expected_values;
+    }
+
+private:
+    const schema_image& s;
+};
+
+/*!
+    Records the findings of the parse engine in a result.
+*/
+class schema_image::target
+{
+public:
+    explicit target(result& r)
+        : r(r)
+    {}
+
+    bool found(std::size_t o) const { return r.occurrences[o].found; }
+    std::size_t count(std::size_t o) const { return r.occurrences[o].count; }
+
+    void occur(std::size_t o, std::size_t first, std::size_t count)
+    {
+        r.occurrences[o].found = true;
+        r.occurrences[o].first = first;
+        r.occurrences[o].count = count;
+    }
+
+    // Images have no options that convert their values.
+    bool convert(std::size_t, requirement_error&) const { return true; }
+
+    void fail(std::size_t o, requirement_error reason)
+    {
+        // Two errors per option at most, see schema::parse.
+        if (r.num_errors < 2 * r.num_occurrences) {
+            r.errors[r.num_errors].ordinal = o;
+            r.errors[r.num_errors].reason  = reason;
+            r.num_errors++;
+        }
+    }
+
+private:
+    result& r;
+};
+
+schema_image::result::result()
+{
+    argv            = 0;
+    occurrences     = 0;
+    num_occurrences = 0;
+    errors          = 0;
+    num_errors      = 0;
+}
+
+bool
+schema_image::result::good() const
+{
+    return 0 == num_errors;
+}
+
+std::size_t
+schema_image::result::error_count() const
+{
+    return num_errors;
+}
+
+const image_error&
+schema_image::result::error_at(std::size_t pos) const
+{
+    if (pos >= num_errors) {
+        throw std::out_of_range("loot::clp::schema_image::result::error_at");
+    }
+    return errors[pos];
+}
+
+bool
+schema_image::result::has(std::size_t ordinal) const
+{
+    return ordinal < num_occurrences && occurrences[ordinal].found;
+}
+
+argv_span
+schema_image::result::values(std::size_t ordinal) const
+{
+    if (!has(ordinal) || 0 == occurrences[ordinal].count) {
+        return argv_span();
+    }
+
+    return argv_span(argv + occurrences[ordinal].first, occurrences[ordinal].count);
+}
+
+schema_image::schema_image(const void* data, std::size_t size)
+{
+    mapping      = 0;
+    mapping_size = 0;
+    open(data, size);
+}
+
+schema_image::schema_image(const std::string& path)
+{
+    mapping      = 0;
+    mapping_size = 0;
+
+#ifdef HAVE_SYS_MMAN_H
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (-1 == fd) {
+        throw std::invalid_argument("loot::clp::schema_image: can't open " + path);
+    }
+
+    struct stat info;
+    if (0 == ::fstat(fd, &info) && S_ISREG(info.st_mode) && 0 != info.st_size) {
+        void* addr = ::mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (MAP_FAILED != addr) {
+            mapping      = addr;
+            mapping_size = static_cast<std::size_t>(info.st_size);
+        }
+    }
+
+    // The mapping stays valid after the descriptor is closed.
+    ::close(fd);
+    if (0 == mapping) {
+        throw std::invalid_argument("loot::clp::schema_image: can't map " + path);
+    }
+
+    try {
+        open(mapping, mapping_size);
+    }
+    catch (...) {
+        ::munmap(const_cast<void*>(mapping), mapping_size);
+        throw;
+    }
+#else
+    std::ifstream in(path.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+    if (!in) {
+        throw std::invalid_argument("loot::clp::schema_image: can't open " + path);
+    }
+
+    // Read into words to get the alignment the image needs.
+    std::size_t size = static_cast<std::size_t>(in.tellg());
+    buffer.resize(detail::image_padded(size) / sizeof(std::uint64_t));
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(buffer.data()), size);
+    open(buffer.data(), size);
+#endif
+}
+
+schema_image::~schema_image()
+{
+#ifdef HAVE_SYS_MMAN_H
+    if (0 != mapping) {
+        ::munmap(const_cast<void*>(mapping), mapping_size);
+    }
+#endif
+}
+
+schema_image::result
+schema_image::parse(int argc, char* argv[], arena& storage) const
+{
+    result r;
+    r.argv            = argv;
+    r.occurrences     = storage.allocate_array<result::occurrence>(num_options);
+    r.num_occurrences = num_options;
+    r.errors          = storage.allocate_array<image_error>(2 * num_options);
+
+    const result::occurrence none = {0, 0, false};
+    std::fill(r.occurrences, r.occurrences + num_options, none);
+
+    table  t(*this);
+    target s(r);
+    detail::dispatch(argv_span(argv, argc), t, s);
+    detail::validate(t, s);
+    return r;
+}
+
+std::size_t
+schema_image::size() const
+{
+    return num_options;
+}
+
+std::size_t
+schema_image::find(const arg_view& name) const
+{
+    if (0 == index_size) {
+        return npos;
+    }
+
+    std::uint64_t hash = detail::hash_name(name);
+    std::size_t   mask = index_size - 1;
+    for (std::size_t slot = hash & mask; ; slot = (slot + 1) & mask) {
+        const detail::image_entry& entry = index[slot];
+        if (detail::image_free_slot == entry.ordinal) {
+            break; // A free slot ends the probe sequence.
+        }
+        if (entry.hash == hash
+                && entry.length == name.size()
+                && 0 == std::memcmp(strings + entry.offset, name.data(), name.size())) {
+            return entry.ordinal;
+        }
+    }
+
+    return npos;
+}
+
+std::size_t
+schema_image::ordinal(option_handle handle) const
+{
+    return handle.position() < num_ordinals ? ordinals[handle.position()] : npos;
+}
+
+arg_view
+schema_image::short_name(std::size_t ordinal) const
+{
+    return arg_view(strings + options[ordinal].short_offset,
+                    options[ordinal].short_length);
+}
+
+arg_view
+schema_image::long_name(std::size_t ordinal) const
+{
+    return arg_view(strings + options[ordinal].long_offset,
+                    options[ordinal].long_length);
+}
+
+arg_view
+schema_image::description(std::size_t ordinal) const
+{
+    return arg_view(strings + options[ordinal].description_offset,
+                    options[ordinal].description_length);
+}
+
+void
+schema_image::open(const void* data, std::size_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+    if (0 != (reinterpret_cast<std::uintptr_t>(bytes) & 7)
+            || size < sizeof(detail::image_header)) {
+        throw std::invalid_argument("loot::clp::schema_image: not an image");
+    }
+
+    const detail::image_header* header
+            = reinterpret_cast<const detail::image_header*>(bytes);
+    if (0 != std::memcmp(header->magic, detail::image_magic, sizeof(header->magic))
+            || detail::image_byte_order != header->byte_order) {
+        throw std::invalid_argument("loot::clp::schema_image: not an image");
+    }
+    if (detail::image_version != header->version) {
+        throw std::invalid_argument("loot::clp::schema_image: unsupported version");
+    }
+
+    // All counts are 32 bit, so none of the sums can overflow.
+    std::uint64_t records     = header->num_options;
+    std::uint64_t slots       = header->index_size;
+    std::uint64_t options_at  = sizeof(detail::image_header);
+    std::uint64_t index_at    = options_at + records * sizeof(detail::image_option);
+    std::uint64_t ordinals_at = index_at + slots * sizeof(detail::image_entry);
+    std::uint64_t strings_at  = ordinals_at
+                              + detail::image_padded(std::uint64_t(header->num_ordinals) * 4);
+    if (header->total_size != size || strings_at + header->strings_size != size) {
+        throw std::invalid_argument("loot::clp::schema_image: truncated image");
+    }
+
+    options      = reinterpret_cast<const detail::image_option*>(bytes + options_at);
+    num_options  = header->num_options;
+    index        = reinterpret_cast<const detail::image_entry*>(bytes + index_at);
+    index_size   = header->index_size;
+    ordinals     = reinterpret_cast<const std::uint32_t*>(bytes + ordinals_at);
+    num_ordinals = header->num_ordinals;
+    strings      = bytes + strings_at;
+
+    // Everything the parser relies on is checked once here, so a damaged image can't
+    // make it read outside of the image or probe forever.
+    std::uint64_t strings_size = header->strings_size;
+    for (std::size_t o = 0; o < num_options; o++) {
+        const detail::image_option& opt = options[o];
+        if (std::uint64_t(opt.short_offset) + opt.short_length > strings_size
+                || std::uint64_t(opt.long_offset) + opt.long_length > strings_size
+                || std::uint64_t(opt.description_offset) + opt.description_length
+                        > strings_size
+                || opt.type < static_cast<int>(option_type_e mandatory_option)
+                || opt.type > static_cast<int>(option_type_e help_option)
+                || opt.constraint < static_cast<int>(value_constraint_e exact_num_values)
+                || opt.constraint > static_cast<int>(value_constraint_e no_values)) {
+            throw std::invalid_argument("loot::clp::schema_image: invalid option");
+        }
+    }
+
+    bool has_free_slot = false;
+    if (0 != (index_size & (index_size - 1))) {
+        throw std::invalid_argument("loot::clp::schema_image: invalid index");
+    }
+    for (std::size_t slot = 0; slot < index_size; slot++) {
+        const detail::image_entry& entry = index[slot];
+        if (detail::image_free_slot == entry.ordinal) {
+            has_free_slot = true;
+        }
+        else if (entry.ordinal >= num_options
+                || std::uint64_t(entry.offset) + entry.length > strings_size) {
+            throw std::invalid_argument("loot::clp::schema_image: invalid index");
+        }
+    }
+    if (0 != index_size && !has_free_slot) {
+        throw std::invalid_argument("loot::clp::schema_image: invalid index");
+    }
+
+    for (std::size_t o = 0; o < num_ordinals; o++) {
+        if (ordinals[o] >= num_options) {
+            throw std::invalid_argument("loot::clp::schema_image: invalid ordinals");
+        }
+    }
+}
+
+} // namespace clp
+} // namespace loot
@@ -0,0 +1,239 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <clp/settings.h>
+
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#ifdef HAVE_SYS_MMAN_H
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#ifdef MSVC_COMPILER
+    #include <stdlib.h>
+    #define environ _environ
+#else
+    extern char** environ;
+#endif
+
+namespace loot {
+namespace clp {
+
+namespace {
+
+/*!
+    @return
+    Returns `true` for the spaces that surround keys and values.
+*/
+inline bool
+is_blank(char c)
+{
+    return ' ' == c || '\t' == c || '\r' == c;
+}
+
+/*!
+    @return
+    Returns the view of `[begin, end)` without surrounding spaces.
+*/
+arg_view
+trim(const char* begin, const char* end)
+{
+    while (begin < end && is_blank(*begin)) {
+        begin++;
+    }
+    while (end > begin && is_blank(*(end - 1))) {
+        end--;
+    }
+    return arg_view(begin, end - begin);
+}
+
+} // namespace
+
+const std::vector<setting>&
+settings::entries() const
+{
+    return items;
+}
+
+config_file::config_file(const std::string& path)
+{
+    this->data   = 0;
+    this->size   = 0;
+    this->mapped = false;
+    this->opened = false;
+
+#ifdef HAVE_SYS_MMAN_H
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (-1 == fd) {
+        return;
+    }
+
+    struct stat info;
+    if (0 == ::fstat(fd, &info) && S_ISREG(info.st_mode)) {
+        opened = true;
+        size = static_cast<std::size_t>(info.st_size);
+
+        // Mapping zero bytes fails, an empty file simply has no settings.
+        if (0 != size) {
+            void* addr = ::mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (MAP_FAILED == addr) {
+                opened = false;
+                size = 0;
+            }
+            else {
+                ::madvise(addr, size, MADV_SEQUENTIAL);
+                data   = static_cast<const char*>(addr);
+                mapped = true;
+            }
+        }
+    }
+
+    // The mapping stays valid after the descriptor is closed.
+    ::close(fd);
+#else
+    std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+    if (!in) {
+        return;
+    }
+
+    buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    opened = true;
+    size = buffer.size();
+    data = buffer.empty() ? 0 : &buffer[0];
+#endif
+
+    split();
+}
+
+config_file::~config_file()
+{
+#ifdef HAVE_SYS_MMAN_H
+    if (mapped) {
+        ::munmap(const_cast<char*>(data), size);
+    }
+#endif
+}
+
+bool
+config_file::is_open() const
+{
+    return opened;
+}
+
+void
+config_file::split()
+{
+    const char* end   = data + size;
+    const char* begin = data;
+    while (begin < end) {
+        const char* stop = static_cast<const char*>(
+                std::memchr(begin, '\n', end - begin));
+        if (0 == stop) {
+            stop = end;
+        }
+
+        arg_view line = trim(begin, stop);
+        begin = stop + 1;
+        if (line.empty() || '#' == line[0] || ';' == line[0]) {
+            continue;
+        }
+
+        const char* first  = line.data();
+        const char* last   = first + line.size();
+        const char* equals = static_cast<const char*>(
+                std::memchr(first, '=', line.size()));
+
+        setting item;
+        if (0 == equals) {
+            item.key   = line;
+            item.value = arg_view(last, 0);
+        }
+        else {
+            item.key   = trim(first, equals);
+            item.value = trim(equals + 1, last);
+            if (item.value.size() > 1 && '"' == item.value[0]
+                    && '"' == item.value[item.value.size() - 1]) {
+                item.value = item.value.sub(1, item.value.size() - 2);
+            }
+        }
+
+        if (!item.key.empty()) {
+            items.push_back(item);
+        }
+    }
+}
+
+environment::environment(const std::string& prefix, char* const* env)
+{
+    if (0 == env) {
+        env = environ;
+    }
+
+    // The views can only be created once text doesn't grow anymore, until then the
+    // settings point to offsets.
+    std::vector<std::size_t> bounds;
+    for (char* const* var = env; 0 != *var; var++) {
+        const char* name = *var;
+        if (0 != std::strncmp(name, prefix.c_str(), prefix.size())) {
+            continue;
+        }
+
+        const char* key    = name + prefix.size();
+        const char* equals = std::strchr(key, '=');
+        if (0 == equals || key == equals) {
+            continue;
+        }
+
+        bounds.push_back(text.size());
+        for (const char* c = key; c < equals; c++) {
+            text.push_back('_' == *c ? '-' : static_cast<char>(std::tolower(
+                    static_cast<unsigned char>(*c))));
+        }
+        bounds.push_back(text.size());
+        text.insert(std::end(text), equals + 1, equals + 1 + std::strlen(equals + 1));
+        bounds.push_back(text.size());
+    }
+
+    items.resize(bounds.size() / 3);
+    for (std::size_t i = 0; i < items.size(); i++) {
+        const char* base = text.empty() ? 0 : &text[0];
+        const std::size_t* b = &bounds[3 * i];
+        items[i].key   = arg_view(base + b[0], b[1] - b[0]);
+        items[i].value = arg_view(base + b[1], b[2] - b[1]);
+    }
+}
+
+} // namespace clp
+} // namespace loot
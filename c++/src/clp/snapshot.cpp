@@ -0,0 +1,173 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <clp/snapshot.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace loot {
+namespace clp {
+
+snapshot::snapshot(std::shared_ptr<const schema>   options,
+                   const std::vector<std::string>& args)
+    : source(std::move(options))
+{
+    std::size_t size = 0;
+    for (std::size_t a = 0; a < args.size(); a++) {
+        size += args[a].size() + 1;
+    }
+
+    // One block for all arguments; It never grows, so the pointers stay valid.
+    text.reserve(size);
+    for (std::size_t a = 0; a < args.size(); a++) {
+        argv.push_back(text.data() + text.size());
+        text.insert(std::end(text), std::begin(args[a]), std::end(args[a]));
+        text.push_back('\0');
+    }
+}
+
+std::shared_ptr<const snapshot>
+snapshot::create(std::shared_ptr<const schema> options, int argc, char* argv[])
+{
+    return create(std::move(options), std::vector<std::string>(argv, argv + argc));
+}
+
+std::shared_ptr<const snapshot>
+snapshot::create(std::shared_ptr<const schema>   options,
+                 const std::vector<std::string>& args)
+{
+    std::shared_ptr<snapshot> s(new snapshot(std::move(options), args));
+    s->r = s->source->parse(static_cast<int>(s->argv.size()), s->argv.data());
+    return s;
+}
+
+const result&
+snapshot::parsed() const
+{
+    return r;
+}
+
+const schema&
+snapshot::options() const
+{
+    return *source;
+}
+
+argv_span
+snapshot::arguments() const
+{
+    return argv_span(argv.data(), argv.size());
+}
+
+snapshot_publisher::guard::guard(std::atomic<std::size_t>* readers,
+                                 const snapshot*           current)
+    : readers(readers), current(current)
+{}
+
+snapshot_publisher::guard::guard(guard&& temp)
+    : readers(temp.readers), current(temp.current)
+{
+    temp.readers = 0;
+    temp.current = 0;
+}
+
+snapshot_publisher::guard::~guard()
+{
+    if (0 != readers) {
+        readers->fetch_sub(1);
+    }
+}
+
+snapshot_publisher::snapshot_publisher(std::shared_ptr<const snapshot> initial)
+    : current_epoch(0),
+      current(initial.get()),
+      owner(std::move(initial)),
+      published(owner ? 1 : 0)
+{
+    epochs[0].readers = 0;
+    epochs[1].readers = 0;
+}
+
+snapshot_publisher::~snapshot_publisher()
+{}
+
+snapshot_publisher::guard
+snapshot_publisher::read() const
+{
+    // Register first, then load: A publisher that swaps the snapshot after the load
+    // finds the reader registered when it waits for the epoch.
+    std::size_t e = current_epoch.load();
+    epochs[e].readers.fetch_add(1);
+    return guard(&epochs[e].readers, current.load());
+}
+
+std::shared_ptr<const snapshot>
+snapshot_publisher::acquire() const
+{
+    guard g = read();
+    return 0 == g.get() ? std::shared_ptr<const snapshot>() : g->shared_from_this();
+}
+
+void
+snapshot_publisher::publish(std::shared_ptr<const snapshot> next)
+{
+    std::lock_guard<std::mutex> lock(writer);
+
+    std::shared_ptr<const snapshot> old = std::move(owner);
+    owner = std::move(next);
+    current.store(owner.get());
+
+    // A reader may have read the epoch just before the previous flip and registered
+    // in it only now, so both epochs are drained once.
+    flip();
+    flip();
+    published.fetch_add(1);
+
+    // Nobody can see the old snapshot anymore, `old` drops the reference on return.
+}
+
+std::size_t
+snapshot_publisher::generation() const
+{
+    return published.load();
+}
+
+void
+snapshot_publisher::flip()
+{
+    std::size_t e = current_epoch.load();
+    current_epoch.store(1 - e);
+    while (0 != epochs[e].readers.load()) {
+        std::this_thread::yield();
+    }
+}
+
+} // namespace clp
+} // namespace loot
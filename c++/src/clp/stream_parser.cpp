@@ -0,0 +1,287 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <clp/stream_parser.h>
+#include <clp/engine.h>
+
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace loot {
+namespace clp {
+
+stream_parser::stream_parser(std::shared_ptr<const schema> options,
+                             std::size_t                   batch_size)
+    : options(std::move(options)), batch_size(batch_size)
+{
+    handlers.resize(this->options->size());
+    reset();
+}
+
+bool
+stream_parser::on(const std::string& name, handler h)
+{
+    std::size_t ordinal = options->find(name);
+    if (schema::npos == ordinal) {
+        return false;
+    }
+
+    handlers[ordinal] = std::move(h);
+    return true;
+}
+
+void
+stream_parser::feed(const arg_view& arg)
+{
+    if (terminated) {
+        return; // Behind "--" nothing is parsed.
+    }
+
+    int start = detail::is_option(arg);
+    if (2 == start && 2 == arg.size()) {
+        if (schema::npos != current) {
+            complete();
+        }
+        terminated = true;
+        return;
+    }
+
+    if (schema::npos != current) {
+        if (0 == start && 0 != remaining) {
+            push(arg);
+            return;
+        }
+
+        // Another option or a value too many ends the values of the current option.
+        complete();
+    }
+
+    if (0 == start) {
+        return; // A value that isn't claimed by any option.
+    }
+
+    bool        ambiguous;
+    std::size_t ordinal = options->find(arg.sub(start), start, ambiguous);
+    if (ambiguous) {
+        fail(ordinal, requirement_error_e ambiguous_option_error);
+        return; // Its values are left unclaimed.
+    }
+    if (schema::npos != ordinal) {
+        begin(ordinal);
+    }
+    else {
+        split(arg, start);
+    }
+}
+
+bool
+stream_parser::finish()
+{
+    if (schema::npos != current) {
+        complete();
+    }
+
+    for (std::size_t o = 0; o < options->size(); o++) {
+        const option& opt = options->at(o);
+        if (opt.short_name.empty() && opt.long_name.empty()) {
+            fail(o, requirement_error_e option_has_no_names_error);
+        }
+        if (option_type_e mandatory_option == opt.type && !found[o]) {
+            fail(o, requirement_error_e option_not_found_error);
+        }
+    }
+
+    return errors.empty();
+}
+
+void
+stream_parser::reset()
+{
+    found.assign(options->size(), false);
+    current    = schema::npos;
+    remaining  = 0;
+    count      = 0;
+    terminated = false;
+    text.clear();
+    ends.clear();
+    errors.clear();
+}
+
+bool
+stream_parser::has_option(const std::string& name) const
+{
+    std::size_t ordinal = options->find(name);
+    return schema::npos != ordinal && found[ordinal];
+}
+
+std::size_t
+stream_parser::error_count() const
+{
+    return errors.size();
+}
+
+const error_ref&
+stream_parser::error_at(std::size_t pos) const
+{
+    return errors.at(pos);
+}
+
+void
+stream_parser::begin(std::size_t ordinal)
+{
+    if (found[ordinal]) {
+        return;
+    }
+
+    found[ordinal] = true;
+    current        = ordinal;
+    count          = 0;
+
+    const option& opt = options->at(ordinal);
+    switch (opt.constraint) {
+        case value_constraint_e no_values:
+            remaining = 0;
+            break;
+
+        case value_constraint_e unlimited_num_values:
+            remaining = std::numeric_limits<std::size_t>::max();
+            break;
+
+        default:
+            remaining = opt.num_expected_values;
+            break;
+    }
+
+    if (0 == remaining) {
+        complete();
+    }
+}
+
+void
+stream_parser::push(const arg_view& value)
+{
+    text.insert(std::end(text), std::begin(value), std::end(value));
+    ends.push_back(text.size());
+    remaining--;
+    count++;
+
+    if (0 == remaining) {
+        complete();
+    }
+    else if (ends.size() == batch_size && value_constraint_e exact_num_values
+            != options->at(current).constraint) {
+        // Options with a variable number of values are valid with their first value
+        // already.
+        flush();
+    }
+}
+
+void
+stream_parser::split(const arg_view& arg, int start)
+{
+    schema::table        t(*options);
+    detail::switch_parts parts = detail::split_switch(t, arg, start);
+    if (0 != parts.count && 0 != (parts.last & detail::ambiguous)) {
+        fail(parts.last & ~detail::ambiguous, requirement_error_e ambiguous_option_error);
+        return;
+    }
+
+    // Only the last option may have a value attached.
+    bool attached = detail::npos != parts.value
+            && value_constraint_e no_values != t.constraint(parts.last);
+    for (std::size_t n = 0; n < parts.count; n++) {
+        std::size_t ordinal = detail::switch_option(t, arg, parts, n);
+        if (found[ordinal]) {
+            continue;
+        }
+        if (detail::npos != parts.value && !attached && n + 1 == parts.count) {
+            found[ordinal] = true;
+            fail(ordinal, requirement_error_e unexpected_value_error);
+            return;
+        }
+
+        begin(ordinal);
+        if (attached && schema::npos != current) {
+            push(arg.sub(parts.value));
+        }
+    }
+}
+
+void
+stream_parser::complete()
+{
+    const option&     opt = options->at(current);
+    requirement_error reason;
+    if (detail::check_values(opt.constraint, opt.num_expected_values, count, reason)) {
+        // Values that ended on a batch boundary have all been handed over already.
+        if (!ends.empty() || 0 == count) {
+            flush();
+        }
+    }
+    else {
+        fail(current, reason);
+        text.clear();
+        ends.clear();
+    }
+
+    current = schema::npos;
+}
+
+void
+stream_parser::flush()
+{
+    // The views are created only now, text may have been reallocated while reading.
+    views.clear();
+    std::size_t begin = 0;
+    for (auto iter = std::begin(ends); iter != std::end(ends); iter++) {
+        views.push_back(arg_view(text.data() + begin, *iter - begin));
+        begin = *iter;
+    }
+
+    if (handlers[current]) {
+        handlers[current](options->at(current),
+                          views.empty() ? arg_span() : arg_span(&views[0], views.size()));
+    }
+
+    text.clear();
+    ends.clear();
+}
+
+void
+stream_parser::fail(std::size_t ordinal, requirement_error reason)
+{
+    error_ref e;
+    e.opt    = &options->at(ordinal);
+    e.reason = reason;
+    errors.push_back(e);
+}
+
+} // namespace clp
+} // namespace loot
@@ -0,0 +1,307 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <clp/suggest.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace loot {
+namespace clp {
+namespace detail {
+
+namespace {
+
+/*!
+    The pattern of the bit-vector algorithm: For every character the positions at which
+    it occurs in the pattern.
+*/
+struct pattern_bits
+{
+    std::uint64_t peq[256];
+    std::size_t   length;
+};
+
+void
+prepare(const arg_view& pattern, pattern_bits& bits)
+{
+    std::memset(bits.peq, 0, sizeof(bits.peq));
+    bits.length = pattern.size();
+    for (std::size_t c = 0; c < pattern.size() && c < 64; c++) {
+        bits.peq[static_cast<unsigned char>(pattern[c])] |= std::uint64_t(1) << c;
+    }
+}
+
+/*!
+    The distance of a pattern of 1 to 64 characters to a text. Each column of the
+    dynamic program is kept as vertical deltas in two words, the score is tracked in the
+    last row.
+*/
+std::size_t
+myers(const pattern_bits& bits, const char* text, std::size_t length, std::size_t limit)
+{
+    std::uint64_t last  = std::uint64_t(1) << (bits.length - 1);
+    std::uint64_t pv    = ~std::uint64_t(0);
+    std::uint64_t mv    = 0;
+    std::size_t   score = bits.length;
+    for (std::size_t c = 0; c < length; c++) {
+        std::uint64_t eq = bits.peq[static_cast<unsigned char>(text[c])];
+        std::uint64_t xv = eq | mv;
+        std::uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        std::uint64_t ph = mv | ~(xh | pv);
+        std::uint64_t mh = pv & xh;
+        if (ph & last) {
+            score++;
+        }
+        else if (mh & last) {
+            score--;
+        }
+
+        // The first row grows by one per character of the text.
+        ph = (ph << 1) | 1;
+        mh = mh << 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        // Every remaining character lowers the score by one at most.
+        if (score > limit + (length - c - 1)) {
+            return limit + 1;
+        }
+    }
+    return score;
+}
+
+/*!
+    The distance of names of any length, one row of the dynamic program at a time.
+*/
+std::size_t
+textbook(const arg_view& pattern, const arg_view& text, std::size_t limit)
+{
+    std::vector<std::size_t> row(pattern.size() + 1);
+    for (std::size_t p = 0; p <= pattern.size(); p++) {
+        row[p] = p;
+    }
+
+    for (std::size_t t = 0; t < text.size(); t++) {
+        std::size_t diagonal = row[0];
+        std::size_t lowest   = ++row[0];
+        for (std::size_t p = 1; p <= pattern.size(); p++) {
+            std::size_t above = row[p];
+            row[p]   = std::min(std::min(row[p] + 1, row[p - 1] + 1),
+                                diagonal + (pattern[p - 1] == text[t] ? 0 : 1));
+            diagonal = above;
+            lowest   = std::min(lowest, row[p]);
+        }
+        if (lowest > limit) {
+            return limit + 1;
+        }
+    }
+    return row[pattern.size()];
+}
+
+std::size_t
+distance(const pattern_bits&  bits,
+         const arg_view&      pattern,
+         const arg_view&      text,
+         std::size_t          limit)
+{
+    if (pattern.empty() || text.empty()) {
+        return std::max(pattern.size(), text.size());
+    }
+    return pattern.size() <= 64 ? myers(bits, text.data(), text.size(), limit)
+                                : textbook(pattern, text, limit);
+}
+
+/*!
+    The set of characters of a name, folded into 64 bits. One edit adds or removes at
+    most two characters from the set, so names whose sets differ in more than twice the
+    allowed distance can't be close enough.
+*/
+std::uint64_t
+char_signature(const char* name, std::size_t length)
+{
+    std::uint64_t bits = 0;
+    for (std::size_t c = 0; c < length; c++) {
+        bits |= std::uint64_t(1) << (static_cast<unsigned char>(name[c]) & 63);
+    }
+    return bits;
+}
+
+/*!
+    The set of pairs of neighbouring characters of a name, hashed into 64 bits. One edit
+    destroys at most two pairs and creates at most two, so names whose sets differ in
+    more than four times the allowed distance can't be close enough. This tells apart
+    names made of the same characters, like numbered ones.
+*/
+std::uint64_t
+pair_signature(const char* name, std::size_t length)
+{
+    std::uint64_t bits = 0;
+    for (std::size_t c = 1; c < length; c++) {
+        unsigned int pair = static_cast<unsigned char>(name[c - 1]) * 31u
+                          + static_cast<unsigned char>(name[c]);
+        bits |= std::uint64_t(1) << ((pair ^ (pair >> 6)) & 63);
+    }
+    return bits;
+}
+
+unsigned int
+count_bits(std::uint64_t bits)
+{
+    bits = bits - ((bits >> 1) & 0x5555555555555555ull);
+    bits = (bits & 0x3333333333333333ull) + ((bits >> 2) & 0x3333333333333333ull);
+    bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return static_cast<unsigned int>((bits * 0x0101010101010101ull) >> 56);
+}
+
+} // namespace
+
+std::size_t
+edit_distance(const arg_view& pattern, const arg_view& text, std::size_t limit)
+{
+    pattern_bits bits;
+    prepare(pattern, bits);
+    return distance(bits, pattern, text, limit);
+}
+
+void
+name_suggester::build(const std::vector<std::string>& short_names,
+                      const std::vector<std::string>& long_names)
+{
+    text.clear();
+    offsets.clear();
+    chars.clear();
+    pairs.clear();
+    ordinals.clear();
+    longs.clear();
+    buckets.clear();
+
+    // Order the names by length; Names of the same length keep the order of their
+    // options, so ties are resolved like everywhere else.
+    std::vector<std::pair<const std::string*, std::size_t>> names;
+    for (std::size_t o = 0; o < long_names.size(); o++) {
+        if (!short_names[o].empty()) {
+            names.push_back(std::make_pair(&short_names[o], 2 * o));
+        }
+        if (!long_names[o].empty()) {
+            names.push_back(std::make_pair(&long_names[o], 2 * o + 1));
+        }
+    }
+    std::stable_sort(std::begin(names), std::end(names),
+                     [](const std::pair<const std::string*, std::size_t>& lhs,
+                        const std::pair<const std::string*, std::size_t>& rhs) {
+        return lhs.first->size() < rhs.first->size();
+    });
+
+    for (std::size_t n = 0; n < names.size(); n++) {
+        const std::string& name = *names[n].first;
+        while (buckets.size() <= name.size()) {
+            buckets.push_back(static_cast<std::uint32_t>(n));
+        }
+
+        offsets.push_back(static_cast<std::uint32_t>(text.size()));
+        chars.push_back(char_signature(name.data(), name.size()));
+        pairs.push_back(pair_signature(name.data(), name.size()));
+        ordinals.push_back(static_cast<std::uint32_t>(names[n].second / 2));
+        longs.push_back(static_cast<unsigned char>(names[n].second % 2));
+        text.insert(std::end(text), std::begin(name), std::end(name));
+    }
+    buckets.push_back(static_cast<std::uint32_t>(names.size()));
+}
+
+void
+name_suggester::suggest(const arg_view&     name,
+                        std::size_t         max,
+                        std::vector<match>& matches) const
+{
+    matches.clear();
+    if (name.size() < 2 || buckets.size() < 2 || 0 == max) {
+        return;
+    }
+
+    std::size_t  limit = std::min<std::size_t>(4, (name.size() + 2) / 3);
+    pattern_bits bits;
+    prepare(name, bits);
+    std::uint64_t char_sig = char_signature(name.data(), name.size());
+    std::uint64_t pair_sig = pair_signature(name.data(), name.size());
+
+    // Deepen the search one distance at a time, so the tight filters of small distances
+    // spare most of the work for the common case of a single typo. All names at the
+    // first distance with any are returned.
+    std::size_t longest = buckets.size() - 2;
+    for (std::size_t allowed = 1; allowed <= limit && matches.empty(); allowed++) {
+        std::size_t shortest = name.size() - allowed;
+        for (std::size_t length = shortest;
+             length <= name.size() + allowed && length <= longest;
+             length++) {
+            for (std::size_t n = buckets[length]; n < buckets[length + 1]; n++) {
+                if (count_bits(pair_sig ^ pairs[n]) > 4 * allowed
+                        || count_bits(char_sig ^ chars[n]) > 2 * allowed) {
+                    continue;
+                }
+
+                arg_view    other(&text[offsets[n]], length);
+                std::size_t d = distance(bits, name, other, allowed);
+                if (d > allowed) {
+                    continue;
+                }
+
+                // One match per option, the closest first, ties ordered like the options.
+                match       m    = {ordinals[n], 0 != longs[n], d};
+                std::size_t slot = 0;
+                while (slot < matches.size() && matches[slot].ordinal != m.ordinal) {
+                    slot++;
+                }
+                if (slot < matches.size()) {
+                    if (matches[slot].distance <= d) {
+                        continue;
+                    }
+                    matches.erase(std::begin(matches) + slot);
+                }
+
+                std::size_t pos = matches.size();
+                while (pos > 0 && (d < matches[pos - 1].distance
+                                   || (d == matches[pos - 1].distance
+                                       && m.ordinal < matches[pos - 1].ordinal))) {
+                    pos--;
+                }
+                if (pos < max) {
+                    matches.insert(std::begin(matches) + pos, m);
+                    if (matches.size() > max) {
+                        matches.pop_back();
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace detail
+} // namespace clp
+} // namespace loot
@@ -0,0 +1,15 @@
+# Options of the tests of loot-clp-gen, see test.cpp.
+
+namespace loot::clp::test
+class generated_options
+
+option p port     mandatory exact:1   integer    The port to listen on
+option r ratio    optional  up-to:2   real       Weights
+option v verbose  optional  none      text       Print more
+option - enabled  optional  exact:1   boolean    Switch it on or off
+option l level    optional  exact:1   enum:low=1,mid=5,high=10 How hard to try
+option - ids      optional  unlimited list:;     Identifiers separated by ";"
+option i input    optional  unlimited text       Input files
+option - inplace  optional  none      text       Overwrite the input
+option x -        optional  none      text       Short only
+option h help     help      none      text       Print the help
@@ -16,15 +16,40 @@
     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
 */
 
+#include <clp/arena.h>
+#include <clp/arg_view.h>
 #include <clp/args.h>
+#include <clp/classify.h>
+#include <clp/command.h>
+#include <clp/completer.h>
+#include <clp/convert.h>
 #include <clp/error.h>
+#include <clp/name_trie.h>
 #include <clp/option.h>
 #include <clp/parser.h>
+#include <clp/response_file.h>
+#include <clp/schema.h>
+#include <clp/schema_image.h>
+#include <clp/settings.h>
+#include <clp/snapshot.h>
+#include <clp/static_schema.h>
+#include <clp/stream_parser.h>
+#include <clp/suggest.h>
+
+#include "generated_options.h"
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <ostream>
 #include <sstream>
+#include <thread>
 
 using namespace loot::clp;
 
@@ -794,3 +819,1733 @@ TEST(ArgsTest, PrintArgsMix)
     EXPECT_EQ(str2.str(), comp2.str());
 }
 
+
+TEST(ArgsTest, RepeatedOptionFirstOccurrenceWins)
+{
+    char *argv[9] = {
+            (char*)"ignored",
+            (char*)"--unknown",
+            (char*)"UnclaimedValue",
+            (char*)"-f",
+            (char*)"file1.txt",
+            (char*)"-i",
+            (char*)"--files",
+            (char*)"file2.txt",
+            (char*)"file3.txt"};
+    parser p;
+	p.add_option(option(
+			"f",
+            "files",
+            option_type_e mandatory_option,
+            value_constraint_e unlimited_num_values,
+            0,
+            ""));
+	p.add_option(option(
+			"i",
+            "ip",
+            option_type_e optional_option,
+            value_constraint_e exact_num_values,
+            1,
+            ""));
+    result r = p.parse(9, argv);
+
+    EXPECT_EQ(r.good(), false);
+    EXPECT_EQ(r.errors.size(), 1);
+    EXPECT_EQ(r.errors.at(0).opt.short_name, "i");
+
+    std::vector<std::string> values = p.values_from_option("files");
+    EXPECT_EQ(values.size(), 1);
+    EXPECT_EQ(values.at(0), "file1.txt");
+    EXPECT_EQ(p.values_from_option("ip").empty(), true);
+}
+
+TEST(ArgsTest, ValuesViewIntoArgv)
+{
+    char *argv[6] = {
+            (char*)"ignored",
+            (char*)"-f",
+            (char*)"file1.txt",
+            (char*)"file2.txt",
+            (char*)"-n",
+            (char*)"NotAValue"};
+    parser p;
+	p.add_option(option(
+			"f",
+            "files",
+            option_type_e mandatory_option,
+            value_constraint_e unlimited_num_values,
+            0,
+            ""));
+	p.add_option(option(
+			"n",
+            "dry-run",
+            option_type_e optional_option,
+            value_constraint_e no_values,
+            0,
+            ""));
+    result r = p.parse(6, argv);
+
+    EXPECT_EQ(r.good(), true);
+
+    arg_span values = p.view_from_option("files");
+    EXPECT_EQ(values.size(), 2);
+    EXPECT_EQ(values.at(0), "file1.txt");
+    EXPECT_EQ(values.at(1), "file2.txt");
+    EXPECT_EQ(values.at(0).data(), argv[2]);
+    EXPECT_EQ(values.at(1).data(), argv[3]);
+
+    EXPECT_EQ(p.view_from_option("dry-run").empty(), true);
+    EXPECT_EQ(p.view_from_option("unknown").empty(), true);
+}
+
+TEST(SchemaTest, ReuseForSeveralCommandLines)
+{
+    parser p;
+	p.add_option(option(
+			"i",
+            "ip",
+            option_type_e mandatory_option,
+            value_constraint_e exact_num_values,
+            1,
+            ""));
+	p.add_option(option(
+			"v",
+            "verbose",
+            option_type_e optional_option,
+            value_constraint_e no_values,
+            0,
+            ""));
+    std::shared_ptr<const schema> s = p.freeze();
+    EXPECT_EQ(s->size(), 2);
+    EXPECT_EQ(s, p.freeze());
+
+    char *argv1[3] = {(char*)"ignored", (char*)"--ip", (char*)"10.0.0.1"};
+    char *argv2[2] = {(char*)"ignored", (char*)"-v"};
+
+    result r1 = s->parse(3, argv1);
+    result r2 = s->parse(2, argv2);
+
+    EXPECT_EQ(r1.good(), true);
+    EXPECT_EQ(r1.has_option("ip"), true);
+    EXPECT_EQ(r1.has_option("verbose"), false);
+    EXPECT_EQ(r1.values_from_option("i").at(0), "10.0.0.1");
+
+    EXPECT_EQ(r2.good(), false);
+    EXPECT_EQ(r2.errors.size(), 1);
+    EXPECT_EQ(r2.errors.at(0).reason, requirement_error_e option_not_found_error);
+    EXPECT_EQ(r2.has_option("ip"), false);
+    EXPECT_EQ(r2.has_option("v"), true);
+}
+
+TEST(SchemaTest, ConcurrentParses)
+{
+    parser p;
+	p.add_option(option(
+			"f",
+            "files",
+            option_type_e mandatory_option,
+            value_constraint_e unlimited_num_values,
+            0,
+            ""));
+    std::shared_ptr<const schema> s = p.freeze();
+
+    char *argv[4] = {
+            (char*)"ignored",
+            (char*)"--files",
+            (char*)"file1.txt",
+            (char*)"file2.txt"};
+
+    const int num_threads = 4;
+    int found[num_threads] = {0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.push_back(std::thread([&s, &argv, &found, t]() {
+            for (int c = 0; c < 1000; c++) {
+                result r = s->parse(4, argv);
+                if (r.good() && r.view_from_option("f").size() == 2) {
+                    found[t]++;
+                }
+            }
+        }));
+    }
+    for (auto iter = std::begin(threads); iter != std::end(threads); iter++) {
+        iter->join();
+    }
+
+    for (int t = 0; t < num_threads; t++) {
+        EXPECT_EQ(found[t], 1000);
+    }
+}
+
+TEST(SchemaTest, ParseBatchMatchesParse)
+{
+    parser p;
+	p.add_option(option(
+			"i",
+            "ip",
+            option_type_e mandatory_option,
+            value_constraint_e exact_num_values,
+            1,
+            ""));
+	p.add_option(option(
+			"f",
+            "files",
+            option_type_e optional_option,
+            value_constraint_e unlimited_num_values,
+            0,
+            ""));
+
+    char *good[5] = {
+            (char*)"ignored",
+            (char*)"-i",
+            (char*)"10.0.0.1",
+            (char*)"-f",
+            (char*)"file1.txt"};
+    char *bad[2] = {(char*)"ignored", (char*)"-f"};
+
+    std::vector<command_line> lines;
+    for (int c = 0; c < 1000; c++) {
+        command_line line = {0 == c % 3 ? 2 : 5, 0 == c % 3 ? bad : good};
+        lines.push_back(line);
+    }
+
+    std::vector<result> results = p.parse_batch(lines, 4);
+    ASSERT_EQ(results.size(), lines.size());
+
+    for (std::size_t c = 0; c < results.size(); c++) {
+        if (0 == c % 3) {
+            EXPECT_EQ(results[c].good(), false);
+            EXPECT_EQ(results[c].errors.size(), 2);
+            EXPECT_EQ(results[c].has_option("ip"), false);
+        }
+        else {
+            EXPECT_EQ(results[c].good(), true);
+            EXPECT_EQ(results[c].values_from_option("ip").at(0), "10.0.0.1");
+            EXPECT_EQ(results[c].view_from_option("files").at(0).data(), good[4]);
+        }
+    }
+}
+
+TEST(ArenaTest, ResetMergesBlocks)
+{
+    arena a(64);
+    EXPECT_EQ(a.capacity(), 0);
+
+    void* first = a.allocate(48, 8);
+    a.allocate(100, 8);
+    a.allocate(300, 16);
+    std::size_t capacity = a.capacity();
+    EXPECT_EQ(capacity > 64, true);
+
+    a.reset();
+    EXPECT_EQ(a.used(), 0);
+    EXPECT_EQ(a.capacity(), capacity);
+
+    // Everything of the last round fits into the merged block now.
+    a.allocate(48, 8);
+    a.allocate(100, 8);
+    a.allocate(300, 16);
+    EXPECT_EQ(a.capacity(), capacity);
+    EXPECT_EQ(first != 0, true);
+}
+
+TEST(SchemaTest, ParseIntoArena)
+{
+    parser p;
+	p.add_option(option(
+			"i",
+            "ip",
+            option_type_e mandatory_option,
+            value_constraint_e exact_num_values,
+            1,
+            ""));
+	p.add_option(option(
+			"p",
+            "port",
+            option_type_e mandatory_option,
+            value_constraint_e exact_num_values,
+            1,
+            ""));
+    std::shared_ptr<const schema> s = p.freeze();
+
+    char *argv[4] = {
+            (char*)"ignored",
+            (char*)"--ip",
+            (char*)"10.0.0.1",
+            (char*)"--port"};
+
+    arena a;
+    std::size_t capacity = 0;
+    for (int c = 0; c < 100; c++) {
+        a.reset();
+
+        result r = s->parse(4, argv, a);
+        EXPECT_EQ(r.good(), false);
+        EXPECT_EQ(r.errors.empty(), true);
+        ASSERT_EQ(r.error_count(), 1);
+        EXPECT_EQ(r.error_at(0).opt->long_name, "port");
+        EXPECT_EQ(r.error_at(0).reason, requirement_error_e not_enough_values_error);
+        EXPECT_EQ(r.view_from_option("ip").at(0), "10.0.0.1");
+        EXPECT_EQ(r.has_option("port"), true);
+
+        // After the first round the arena does not grow anymore.
+        if (0 == c) {
+            capacity = a.capacity();
+        }
+        EXPECT_EQ(a.capacity(), capacity);
+
+        // A copy takes the state into its own memory.
+        if (99 == c) {
+            result copy = r;
+            a.reset();
+            EXPECT_EQ(copy.error_count(), 1);
+            EXPECT_EQ(copy.values_from_option("ip").at(0), "10.0.0.1");
+        }
+    }
+}
+
+#if defined(HAS_CXX11_CONSTEXPR) && defined(HAS_CXX11_VARIADIC_TEMPLATES)
+LOOT_CLP_STATIC_OPTION(static_ip, "i", "ip", mandatory_option, exact_num_values, 1,
+                       "IP to connect to");
+LOOT_CLP_STATIC_OPTION(static_port, "p", "port", optional_option, up_to_num_values, 2,
+                       "Ports");
+LOOT_CLP_STATIC_OPTION(static_verbose, "", "verbose", optional_option, no_values, 0,
+                       "Print more");
+
+typedef static_schema<static_ip, static_port, static_verbose> static_cli;
+
+TEST(StaticSchemaTest, FindByName)
+{
+    EXPECT_EQ(static_cli::size(), 3);
+    EXPECT_EQ(static_cli::ordinal<static_port>(), 1);
+    EXPECT_EQ(static_cli::find("i"), 0);
+    EXPECT_EQ(static_cli::find("ip"), 0);
+    EXPECT_EQ(static_cli::find("port"), 1);
+    EXPECT_EQ(static_cli::find("verbose"), 2);
+    EXPECT_EQ(static_cli::find("v"), static_cli::npos);
+    EXPECT_EQ(static_cli::find("ports"), static_cli::npos);
+    EXPECT_EQ(static_cli::find(""), static_cli::npos);
+}
+
+TEST(StaticSchemaTest, ParseMatchesSchema)
+{
+    char* argv[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("--verbose"),
+        const_cast<char*>("-p"),
+        const_cast<char*>("80"),
+        const_cast<char*>("443"),
+        const_cast<char*>("--ip"),
+        const_cast<char*>("10.0.0.1")
+    };
+
+    static_cli::result r = static_cli::parse(7, argv);
+    EXPECT_EQ(r.good(), true);
+    EXPECT_EQ(r.has<static_verbose>(), true);
+    EXPECT_EQ(r.values<static_verbose>().empty(), true);
+    ASSERT_EQ(r.values<static_port>().size(), 2);
+    EXPECT_EQ(r.values<static_port>()[0], "80");
+    EXPECT_EQ(r.values<static_port>()[1], "443");
+    EXPECT_EQ(r.values<static_ip>().at(0), "10.0.0.1");
+    EXPECT_EQ(r.values<static_ip>()[0].data(), argv[6]);
+
+    // The same rules as for a schema built at runtime.
+    parser p;
+    p.add_option(option("i", "ip", option_type_e mandatory_option,
+                        value_constraint_e exact_num_values, 1, ""));
+    p.add_option(option("p", "port", option_type_e optional_option,
+                        value_constraint_e up_to_num_values, 2, ""));
+    p.add_option(option("", "verbose", option_type_e optional_option,
+                        value_constraint_e no_values, 0, ""));
+
+    char* argv_error[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("-p"),
+        const_cast<char*>("--verbose")
+    };
+
+    static_cli::result sr = static_cli::parse(3, argv_error);
+    result             dr = p.freeze()->parse(3, argv_error);
+    ASSERT_EQ(sr.error_count(), dr.error_count());
+    ASSERT_EQ(sr.error_count(), 2);
+    for (std::size_t e = 0; e < sr.error_count(); e++) {
+        EXPECT_EQ(static_cli::ordinal<static_port>() == sr.error_at(e).ordinal,
+                  "port" == dr.error_at(e).opt->long_name);
+        EXPECT_EQ(sr.error_at(e).reason, dr.error_at(e).reason);
+    }
+    EXPECT_THROW(sr.error_at(2), std::out_of_range);
+
+    // A value attached to an option without values is reported once.
+    char* argv_attached[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("--verbose=a"),
+        const_cast<char*>("--verbose=b"),
+        const_cast<char*>("--verbose=c"),
+        const_cast<char*>("--verbose=d")
+    };
+    sr = static_cli::parse(5, argv_attached);
+    ASSERT_EQ(sr.error_count(), 2);
+    EXPECT_EQ(sr.error_at(0).ordinal, static_cli::ordinal<static_verbose>());
+    EXPECT_EQ(sr.error_at(0).reason, requirement_error_e unexpected_value_error);
+    EXPECT_EQ(sr.error_at(1).ordinal, static_cli::ordinal<static_ip>());
+    EXPECT_EQ(sr.error_at(1).reason, requirement_error_e option_not_found_error);
+}
+#endif
+
+TEST(ResponseFileTest, SplitLinesAndNul)
+{
+    {
+        std::ofstream out("clp_test_lines.rsp", std::ios::binary);
+        out << "--ip\r\n10.0.0.1\n\n-p\n80";
+    }
+    {
+        std::ofstream out("clp_test_nul.rsp", std::ios::binary);
+        out.write("a b\0\0c\n\0", 8);
+    }
+
+    response_file lines("clp_test_lines.rsp");
+    ASSERT_EQ(lines.is_open(), true);
+    ASSERT_EQ(lines.arguments().size(), 4);
+    EXPECT_EQ(lines.arguments()[0], "--ip");
+    EXPECT_EQ(lines.arguments()[1], "10.0.0.1");
+    EXPECT_EQ(lines.arguments()[2], "-p");
+    EXPECT_EQ(lines.arguments()[3], "80");
+
+    response_file nul("clp_test_nul.rsp");
+    ASSERT_EQ(nul.arguments().size(), 3);
+    EXPECT_EQ(nul.arguments()[0], "a b");
+    EXPECT_EQ(nul.arguments()[1], "");
+    EXPECT_EQ(nul.arguments()[2], "c\n");
+
+    response_file missing("clp_test_missing.rsp");
+    EXPECT_EQ(missing.is_open(), false);
+    EXPECT_EQ(missing.arguments().empty(), true);
+
+    std::remove("clp_test_lines.rsp");
+    std::remove("clp_test_nul.rsp");
+}
+
+TEST(ResponseFileTest, ExpandedByParse)
+{
+    {
+        std::ofstream out("clp_test_args.rsp", std::ios::binary);
+        out << "10.0.0.1\n-p\n80\n443\n";
+    }
+
+    parser p;
+	p.add_option(option(
+			"i",
+            "ip",
+            option_type_e mandatory_option,
+            value_constraint_e exact_num_values,
+            1,
+            ""));
+	p.add_option(option(
+			"p",
+            "port",
+            option_type_e optional_option,
+            value_constraint_e unlimited_num_values,
+            0,
+            ""));
+
+    char* argv[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("--ip"),
+        const_cast<char*>("@clp_test_args.rsp"),
+        const_cast<char*>("@clp_test_missing.rsp")
+    };
+
+    // Off by default, @path is a value like any other.
+    result plain = p.parse(4, argv);
+    EXPECT_EQ(plain.good(), true);
+    EXPECT_EQ(plain.values_from_option("ip").at(0), "@clp_test_args.rsp");
+    EXPECT_EQ(plain.has_option("port"), false);
+
+    p.expand_response_files(true);
+    result r = p.parse(4, argv);
+    std::remove("clp_test_args.rsp");
+
+    EXPECT_EQ(r.good(), true);
+    EXPECT_EQ(r.values_from_option("ip").at(0), "10.0.0.1");
+
+    std::vector<std::string> ports = r.values_from_option("port");
+    ASSERT_EQ(ports.size(), 3);
+    EXPECT_EQ(ports[0], "80");
+    EXPECT_EQ(ports[1], "443");
+    EXPECT_EQ(ports[2], "@clp_test_missing.rsp");
+
+    // Copies keep the mapping alive.
+    result copy = r;
+    r = result();
+    EXPECT_EQ(copy.view_from_option("port").at(1), "443");
+}
+
+TEST(StreamParserTest, CallbacksAsValuesComplete)
+{
+    parser p;
+	p.add_option(option(
+			"i",
+            "ip",
+            option_type_e mandatory_option,
+            value_constraint_e exact_num_values,
+            1,
+            ""));
+	p.add_option(option(
+			"f",
+            "file",
+            option_type_e optional_option,
+            value_constraint_e unlimited_num_values,
+            0,
+            ""));
+	p.add_option(option(
+			"v",
+            "verbose",
+            option_type_e optional_option,
+            value_constraint_e no_values,
+            0,
+            ""));
+
+    stream_parser s(p.freeze(), 2);
+
+    std::vector<std::string> events;
+    s.on("ip", [&events](const option& opt, arg_span values) {
+        events.push_back(opt.long_name + "=" + values.at(0).str());
+    });
+    s.on("file", [&events](const option& opt, arg_span values) {
+        events.push_back(opt.long_name + ":" + std::to_string(values.size()));
+    });
+    s.on("v", [&events](const option& opt, arg_span) {
+        events.push_back(opt.long_name);
+    });
+    EXPECT_EQ(s.on("unknown", stream_parser::handler()), false);
+
+    s.feed("--file");
+    s.feed("a");
+    s.feed("b");
+    ASSERT_EQ(events.size(), 1);
+    EXPECT_EQ(events[0], "file:2");
+
+    s.feed(std::string("c"));
+    s.feed("-v");
+    ASSERT_EQ(events.size(), 3);
+    EXPECT_EQ(events[1], "file:1");
+    EXPECT_EQ(events[2], "verbose");
+
+    s.feed("--ip");
+    s.feed("10.0.0.1");
+    ASSERT_EQ(events.size(), 4);
+    EXPECT_EQ(events[3], "ip=10.0.0.1");
+    EXPECT_EQ(s.finish(), true);
+    EXPECT_EQ(s.has_option("f"), true);
+
+    // Values ending on a batch boundary aren't followed by an empty batch.
+    s.reset();
+    events.clear();
+    s.feed("--file");
+    s.feed("a");
+    s.feed("b");
+    s.feed("-v");
+    ASSERT_EQ(events.size(), 2);
+    EXPECT_EQ(events[0], "file:2");
+    EXPECT_EQ(events[1], "verbose");
+
+    // Clusters and attached values, like for a parse of the whole command line.
+    s.reset();
+    events.clear();
+    s.feed("-vfa");
+    s.feed("b");
+    s.feed("--ip=10.0.0.2");
+    ASSERT_EQ(events.size(), 3);
+    EXPECT_EQ(events[0], "verbose");
+    EXPECT_EQ(events[1], "file:2");
+    EXPECT_EQ(events[2], "ip=10.0.0.2");
+    EXPECT_EQ(s.finish(), true);
+
+    // Nothing behind "--" is parsed.
+    s.reset();
+    events.clear();
+    s.feed("--ip");
+    s.feed("10.0.0.3");
+    s.feed("-f");
+    s.feed("a");
+    s.feed("--");
+    s.feed("-v");
+    EXPECT_EQ(s.finish(), true);
+    ASSERT_EQ(events.size(), 2);
+    EXPECT_EQ(events[1], "file:1");
+    EXPECT_EQ(s.has_option("verbose"), false);
+
+    // Same errors as a parse of the whole command line, though in the order they were
+    // detected.
+    char* argv[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("--ip"),
+        const_cast<char*>("-v"),
+        const_cast<char*>("-f")
+    };
+    result r = p.parse(4, argv);
+
+    s.reset();
+    events.clear();
+    for (int c = 1; c < 4; c++) {
+        s.feed(argv[c]);
+    }
+    EXPECT_EQ(s.finish(), false);
+    EXPECT_EQ(events.size(), 1);
+    ASSERT_EQ(s.error_count(), 2);
+    ASSERT_EQ(r.error_count(), 2);
+    EXPECT_EQ(s.error_at(0).opt->long_name, "ip");
+    EXPECT_EQ(s.error_at(1).opt->long_name, "file");
+    for (std::size_t e = 0; e < 2; e++) {
+        EXPECT_EQ(s.error_at(e).opt, r.error_at(1 - e).opt);
+        EXPECT_EQ(s.error_at(e).reason, r.error_at(1 - e).reason);
+    }
+}
+
+TEST(ClassifyTest, MatchesCharacters)
+{
+    // Every alignment and length around the vector width, with and without an = in
+    // front of and behind the end of the argument.
+    char buffer[160];
+    for (std::size_t offset = 0; offset < 40; offset++) {
+        for (std::size_t length = 0; length < 80; length++) {
+            for (std::size_t eq = 0; eq <= length + 1; eq += 7) {
+                std::memset(buffer, 'x', sizeof(buffer));
+                char* arg = buffer + offset;
+                arg[length] = '\0';
+                arg[eq] = '\0' == arg[eq] ? '\0' : '=';
+                if (eq == length + 1) {
+                    arg[eq] = '=';
+                }
+                if (length > 0) {
+                    arg[0] = '-';
+                }
+
+                arg_view         token;
+                detail::arg_info info;
+                detail::classify(&arg, 1, &token, &info);
+
+                const char* expected = std::strchr(arg, '=');
+                ASSERT_EQ(token.size(), std::strlen(arg));
+                ASSERT_EQ(token.data(), arg);
+                ASSERT_EQ(info.equals, 0 == expected ? detail::no_equals
+                                                     : std::uint32_t(expected - arg));
+                ASSERT_EQ(info.dashes, detail::is_option(arg));
+
+                detail::arg_info view_info;
+                detail::classify(&token, 1, &view_info);
+                ASSERT_EQ(view_info.equals, info.equals);
+                ASSERT_EQ(view_info.dashes, info.dashes);
+            }
+        }
+    }
+
+    char* argv[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("--"),
+        const_cast<char*>("---"),
+        const_cast<char*>("-"),
+        const_cast<char*>("--name=value")
+    };
+    arg_view         tokens[5];
+    detail::arg_info infos[5];
+    detail::classify(argv, 5, tokens, infos);
+    EXPECT_EQ(infos[0].dashes, 0);
+    EXPECT_EQ(infos[1].terminator, true);
+    EXPECT_EQ(infos[1].dashes, 2);
+    EXPECT_EQ(infos[2].terminator, false);
+    EXPECT_EQ(infos[3].dashes, 1);
+    EXPECT_EQ(infos[4].equals, 6);
+    EXPECT_EQ(tokens[4].sub(infos[4].equals + 1), "value");
+}
+
+TEST(ArgsTest, ManyOptionsIndexedByName)
+{
+    parser p;
+    for (int c = 0; c < 2000; c++) {
+        std::string n = std::to_string(c);
+        EXPECT_EQ(p.add_option(option("s" + n, "long-" + n)).valid(), true);
+    }
+
+    // Duplicates are found no matter which name collides with which.
+    EXPECT_EQ(p.add_option(option("s1999", "")).valid(), false);
+    EXPECT_EQ(p.add_option(option("", "long-0")).valid(), false);
+    EXPECT_EQ(p.add_option(option("long-7", "other")).valid(), false);
+    EXPECT_EQ(p.add_option(option("other", "s7")).valid(), false);
+    EXPECT_EQ(p.add_option(option("", "")).valid(), true);
+    EXPECT_EQ(p.add_option(option("", "")).valid(), true);
+
+    std::shared_ptr<const schema> s = p.freeze();
+    EXPECT_EQ(s->size(), 2002);
+    for (int c = 0; c < 2000; c += 37) {
+        std::string n = std::to_string(c);
+        std::size_t ordinal = s->find("s" + n);
+        ASSERT_NE(ordinal, schema::npos);
+        EXPECT_EQ(s->find("long-" + n), ordinal);
+        EXPECT_EQ(s->at(ordinal).long_name, "long-" + n);
+    }
+    EXPECT_EQ(s->find("s2000"), schema::npos);
+    EXPECT_EQ(s->find("long-"), schema::npos);
+    EXPECT_EQ(s->find(""), schema::npos);
+}
+
+TEST(OptionTest, LessMatchesJoinedNames)
+{
+    const char* names[] = {"", "a", "ab", "abc", "b", "ba", "-", "\xff"};
+    for (const char* s1 : names) {
+        for (const char* l1 : names) {
+            for (const char* s2 : names) {
+                for (const char* l2 : names) {
+                    option lhs(s1, l1);
+                    option rhs(s2, l2);
+                    EXPECT_EQ(lhs < rhs, std::string(s1) + l1 < std::string(s2) + l2);
+                }
+            }
+        }
+    }
+}
+
+TEST(ArgsTest, QueryByHandle)
+{
+    parser p;
+    option_handle port = p.add_option(option(
+            "p",
+            "port",
+            option_type_e optional_option,
+            value_constraint_e up_to_num_values,
+            2,
+            ""));
+    option_handle ip = p.add_option(option(
+            "i",
+            "ip",
+            option_type_e mandatory_option,
+            value_constraint_e exact_num_values,
+            1,
+            ""));
+    option_handle dup = p.add_option(option("", "ip"));
+    EXPECT_EQ(port.valid(), true);
+    EXPECT_EQ(ip.valid(), true);
+    EXPECT_EQ(dup.valid(), false);
+
+    // Handles still test like the bool add_option used to return.
+    parser old;
+    if (!old.add_option(option("p", "port"))) {
+        ADD_FAILURE();
+    }
+    bool added(old.add_option(option("", "port")));
+    EXPECT_EQ(added, false);
+    EXPECT_EQ(static_cast<bool>(old.add_option(option("i", "ip"))), true);
+
+    char* argv[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("--ip"),
+        const_cast<char*>("10.0.0.1")
+    };
+
+    result r = p.parse(3, argv);
+    EXPECT_EQ(r.has(ip), true);
+    EXPECT_EQ(r.has(port), false);
+    EXPECT_EQ(r.has(dup), false);
+    EXPECT_EQ(r.values(port).empty(), true);
+    ASSERT_EQ(r.values(ip).size(), 1);
+    EXPECT_EQ(r.values(ip)[0], "10.0.0.1");
+    EXPECT_EQ(p.has(ip), true);
+    EXPECT_EQ(p.values(ip)[0].data(), argv[2]);
+
+    // Handles keep referring to the same option when more options are added, even though
+    // the schema orders them differently.
+    option_handle all = p.add_option(option("a", "all"));
+    EXPECT_EQ(r.has(all), false);
+    r = p.parse(3, argv);
+    EXPECT_EQ(r.has(ip), true);
+    EXPECT_EQ(r.values(ip)[0], "10.0.0.1");
+    EXPECT_EQ(p.freeze()->at(p.freeze()->ordinal(all)).long_name, "all");
+}
+
+TEST(ConvertTest, NumbersBooleansAndChoices)
+{
+    std::int64_t      i = 0;
+    double            d = 0;
+    bool              b = false;
+    requirement_error reason;
+
+    EXPECT_EQ(detail::convert_integer("-42", i, reason), true);
+    EXPECT_EQ(i, -42);
+    EXPECT_EQ(detail::convert_integer("9223372036854775807", i, reason), true);
+    EXPECT_EQ(i, INT64_MAX);
+    EXPECT_EQ(detail::convert_integer("-9223372036854775808", i, reason), true);
+    EXPECT_EQ(i, INT64_MIN);
+    EXPECT_EQ(detail::convert_integer("9223372036854775808", i, reason), false);
+    EXPECT_EQ(reason, requirement_error_e value_out_of_range_error);
+    EXPECT_EQ(detail::convert_integer("99999999999999999999x", i, reason), false);
+    EXPECT_EQ(reason, requirement_error_e value_not_convertible_error);
+    EXPECT_EQ(detail::convert_integer("-", i, reason), false);
+    EXPECT_EQ(detail::convert_integer("1.0", i, reason), false);
+
+    EXPECT_EQ(detail::convert_real("1.5", d, reason), true);
+    EXPECT_EQ(d, 1.5);
+    EXPECT_EQ(detail::convert_real("-.25e2", d, reason), true);
+    EXPECT_EQ(d, -25.0);
+    EXPECT_EQ(detail::convert_real("0.1", d, reason), true);
+    EXPECT_EQ(d, 0.1);
+    EXPECT_EQ(detail::convert_real("1e-400", d, reason), true);
+    EXPECT_EQ(d, 0.0);
+    EXPECT_EQ(detail::convert_real("INF", d, reason), true);
+    EXPECT_EQ(std::isinf(d), true);
+    EXPECT_EQ(detail::convert_real("1e400", d, reason), false);
+    EXPECT_EQ(reason, requirement_error_e value_out_of_range_error);
+    EXPECT_EQ(detail::convert_real("1e", d, reason), false);
+    EXPECT_EQ(reason, requirement_error_e value_not_convertible_error);
+    EXPECT_EQ(detail::convert_real(".", d, reason), false);
+    EXPECT_EQ(detail::convert_real("0x10", d, reason), false);
+
+    // Beyond the exact fast path the result has to match the C library.
+    const char* slow[] = {"123456789012345678901234.5", "2.2250738585072014e-308",
+                          "9007199254740993", "0.30000000000000004441"};
+    for (std::size_t s = 0; s < sizeof(slow) / sizeof(slow[0]); s++) {
+        EXPECT_EQ(detail::convert_real(slow[s], d, reason), true);
+        EXPECT_EQ(d, std::strtod(slow[s], 0));
+    }
+
+    EXPECT_EQ(detail::convert_boolean("Yes", b, reason), true);
+    EXPECT_EQ(b, true);
+    EXPECT_EQ(detail::convert_boolean("off", b, reason), true);
+    EXPECT_EQ(b, false);
+    EXPECT_EQ(detail::convert_boolean("maybe", b, reason), false);
+
+    std::vector<std::pair<std::string, std::int64_t>> levels;
+    levels.push_back(std::make_pair("low", 1));
+    levels.push_back(std::make_pair("high", 10));
+    EXPECT_EQ(detail::convert_choice("high", levels, i, reason), true);
+    EXPECT_EQ(i, 10);
+    EXPECT_EQ(detail::convert_choice("hi", levels, i, reason), false);
+    EXPECT_EQ(reason, requirement_error_e value_not_a_choice_error);
+}
+
+TEST(ArgsTest, TypedValues)
+{
+    std::vector<std::pair<std::string, std::int64_t>> levels;
+    levels.push_back(std::make_pair("low", 1));
+    levels.push_back(std::make_pair("high", 10));
+
+    parser p;
+    option_handle ports = p.add_option(typed_option<std::int64_t>(option(
+            "p",
+            "ports",
+            option_type_e optional_option,
+            value_constraint_e unlimited_num_values,
+            0,
+            "")));
+    option_handle ratio = p.add_option(typed_option<double>(option(
+            "r",
+            "ratio",
+            option_type_e optional_option,
+            value_constraint_e exact_num_values,
+            1,
+            "")));
+    option_handle verbose = p.add_option(typed_option<bool>(option(
+            "v",
+            "verbose",
+            option_type_e optional_option,
+            value_constraint_e exact_num_values,
+            1,
+            "")));
+    option_handle level = p.add_option(enum_option(option(
+            "l",
+            "level",
+            option_type_e optional_option,
+            value_constraint_e exact_num_values,
+            1,
+            ""), levels));
+
+    char* argv[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("--ports"),
+        const_cast<char*>("80"),
+        const_cast<char*>("443"),
+        const_cast<char*>("-r"),
+        const_cast<char*>("0.75"),
+        const_cast<char*>("-v"),
+        const_cast<char*>("on"),
+        const_cast<char*>("-l"),
+        const_cast<char*>("high")
+    };
+
+    result r = p.parse(10, argv);
+    ASSERT_EQ(r.good(), true);
+    ASSERT_EQ(r.values_as<std::int64_t>(ports).size(), 2);
+    EXPECT_EQ(r.values_as<std::int64_t>(ports)[0], 80);
+    EXPECT_EQ(r.values_as<std::int64_t>("p")[1], 443);
+    EXPECT_EQ(r.values_as<double>(ratio).at(0), 0.75);
+    EXPECT_EQ(r.values_as<bool>(verbose)[0], true);
+    EXPECT_EQ(r.values_as<std::int64_t>(level)[0], 10);
+    EXPECT_EQ(r.values(level)[0], "high");
+
+    // Values only convert into the type of their option.
+    EXPECT_EQ(r.values_as<double>(ports).empty(), true);
+    EXPECT_EQ(r.values_as<bool>(ratio).empty(), true);
+
+    // Copies carry their own converted values.
+    result copy = r;
+    r = result();
+    EXPECT_EQ(copy.values_as<std::int64_t>(ports)[1], 443);
+    EXPECT_EQ(copy.values_as<double>("ratio")[0], 0.75);
+
+    // Values that don't convert are errors of their options, in the order of the options.
+    argv[3] = const_cast<char*>("https");
+    argv[9] = const_cast<char*>("medium");
+    r = p.parse(10, argv);
+    ASSERT_EQ(r.errors.size(), 2);
+    EXPECT_EQ(r.errors[0].opt.long_name, "level");
+    EXPECT_EQ(r.errors[0].reason, requirement_error_e value_not_a_choice_error);
+    EXPECT_EQ(r.errors[1].opt.long_name, "ports");
+    EXPECT_EQ(r.errors[1].reason, requirement_error_e value_not_convertible_error);
+    EXPECT_EQ(r.values_as<std::int64_t>(ports).empty(), true);
+    EXPECT_EQ(r.values(ports).size(), 2);
+}
+
+TEST(ConvertTest, IntegerLists)
+{
+    requirement_error         reason;
+    std::vector<std::int64_t> values;
+
+    EXPECT_EQ(convert_integer_list("", ',', values, reason), true);
+    EXPECT_EQ(values.empty(), true);
+    EXPECT_EQ(convert_integer_list("7", ',', values, reason), true);
+    EXPECT_EQ(convert_integer_list("-9223372036854775808;+12;000000000000000000000042",
+                                   ';', values, reason), true);
+    ASSERT_EQ(values.size(), 4);
+    EXPECT_EQ(values[0], 7);
+    EXPECT_EQ(values[1], INT64_MIN);
+    EXPECT_EQ(values[2], 12);
+    EXPECT_EQ(values[3], 42);
+
+    const char* malformed[] = {",1", "1,", "1,,2", "1;2", "1,-", "1,x"};
+    for (std::size_t m = 0; m < sizeof(malformed) / sizeof(malformed[0]); m++) {
+        EXPECT_EQ(convert_integer_list(malformed[m], ',', values, reason), false);
+        EXPECT_EQ(reason, requirement_error_e value_not_convertible_error);
+        EXPECT_EQ(values.size(), 4);
+    }
+    EXPECT_EQ(convert_integer_list("1,9223372036854775808", ',', values, reason), false);
+    EXPECT_EQ(reason, requirement_error_e value_out_of_range_error);
+
+    // Numbers of every length at every offset, matching the conversion of single values.
+    std::string               list;
+    std::vector<std::int64_t> expected;
+    std::uint64_t             number = 1;
+    for (int n = 0; n < 400; n++) {
+        number = (number * 6364136223846793005ULL + 1442695040888963407ULL);
+        std::int64_t value = static_cast<std::int64_t>(number) >> (n % 63);
+        std::string  text  = std::to_string(static_cast<long long>(value));
+        list += (n ? "," : "") + text;
+
+        std::int64_t single;
+        ASSERT_EQ(detail::convert_integer(text.c_str(), single, reason), true);
+        expected.push_back(single);
+    }
+
+    EXPECT_EQ(count_list_values(list.c_str(), ','), expected.size());
+    std::vector<std::int64_t> buffer(expected.size());
+    std::size_t               count;
+    ASSERT_EQ(convert_integer_list(list.c_str(), ',', buffer.data(), buffer.size(), count,
+                                   reason), true);
+    EXPECT_EQ(count, expected.size());
+    EXPECT_EQ(buffer, expected);
+    EXPECT_THROW(convert_integer_list(list.c_str(), ',', buffer.data(), 10, count, reason),
+                 std::length_error);
+}
+
+TEST(ArgsTest, IntegerListValues)
+{
+    parser p;
+    option_handle ids = p.add_option(list_option(option(
+            "",
+            "ids",
+            option_type_e mandatory_option,
+            value_constraint_e unlimited_num_values,
+            0,
+            "")));
+
+    char* argv[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("--ids"),
+        const_cast<char*>("17,42,99"),
+        const_cast<char*>("-5")
+    };
+
+    // A negative number on its own is an option switch, so only the first list counts.
+    result r = p.parse(4, argv);
+    ASSERT_EQ(r.good(), true);
+    ASSERT_EQ(r.values_as<std::int64_t>(ids).size(), 3);
+    EXPECT_EQ(r.values_as<std::int64_t>("ids")[2], 99);
+
+    argv[3] = const_cast<char*>("1000,2000");
+    r = p.parse(4, argv);
+    value_span<std::int64_t> all = r.values_as<std::int64_t>(ids);
+    ASSERT_EQ(all.size(), 5);
+    EXPECT_EQ(all[3], 1000);
+    EXPECT_EQ(std::vector<std::int64_t>(std::begin(all), std::end(all)),
+              std::vector<std::int64_t>({17, 42, 99, 1000, 2000}));
+}
+
+TEST(SchemaImageTest, ParseMatchesSchema)
+{
+    parser p;
+    option_handle port = p.add_option(option(
+            "p",
+            "port",
+            option_type_e optional_option,
+            value_constraint_e up_to_num_values,
+            2,
+            "Ports to listen on"));
+    option_handle ip = p.add_option(option(
+            "i",
+            "ip",
+            option_type_e mandatory_option,
+            value_constraint_e exact_num_values,
+            1,
+            ""));
+    p.add_option(option(
+            "",
+            "user",
+            option_type_e mandatory_option,
+            value_constraint_e exact_num_values,
+            1,
+            ""));
+    p.add_option(option(
+            "v",
+            "verbose",
+            option_type_e optional_option,
+            value_constraint_e no_values,
+            0,
+            ""));
+
+    std::vector<char> image = p.freeze()->serialize();
+    {
+        std::ofstream out("clp_test_schema.img", std::ios::binary);
+        out.write(image.data(), image.size());
+    }
+
+    char* argv[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("--port"),
+        const_cast<char*>("80"),
+        const_cast<char*>("443"),
+        const_cast<char*>("-v"),
+        const_cast<char*>("--user")
+    };
+
+    result expected = p.parse(6, argv);
+    ASSERT_EQ(expected.error_count(), 2);
+
+    schema_image in_memory(image.data(), image.size());
+    schema_image in_file("clp_test_schema.img");
+    const schema_image* images[] = {&in_memory, &in_file};
+    for (std::size_t i = 0; i < 2; i++) {
+        const schema_image& img = *images[i];
+        ASSERT_EQ(img.size(), p.freeze()->size());
+        EXPECT_EQ(img.find("port"), img.ordinal(port));
+        EXPECT_EQ(img.find("i"), img.ordinal(ip));
+        EXPECT_EQ(img.find("missing"), schema_image::npos);
+        EXPECT_EQ(img.long_name(img.find("p")), "port");
+        EXPECT_EQ(img.description(img.ordinal(port)), "Ports to listen on");
+
+        arena storage;
+        schema_image::result r = img.parse(6, argv, storage);
+        ASSERT_EQ(r.error_count(), expected.error_count());
+        for (std::size_t e = 0; e < r.error_count(); e++) {
+            EXPECT_EQ(img.long_name(r.error_at(e).ordinal), expected.errors[e].opt.long_name);
+            EXPECT_EQ(r.error_at(e).reason, expected.errors[e].reason);
+        }
+        EXPECT_EQ(r.has(img.find("verbose")), true);
+        EXPECT_EQ(r.has(img.ordinal(ip)), false);
+        ASSERT_EQ(r.values(img.ordinal(port)).size(), 2);
+        EXPECT_EQ(r.values(img.ordinal(port))[1], "443");
+    }
+    std::remove("clp_test_schema.img");
+
+    // Images can't present attached values, so a cluster with one stays unknown instead
+    // of recording only its first options.
+    char* cluster[] = {const_cast<char*>("app"), const_cast<char*>("-vp80")};
+    arena storage;
+    schema_image::result r = in_memory.parse(2, cluster, storage);
+    EXPECT_EQ(r.has(in_memory.find("verbose")), false);
+    EXPECT_EQ(r.has(in_memory.ordinal(port)), false);
+    expected = p.parse(2, cluster);
+    EXPECT_EQ(expected.has(port), true);
+    EXPECT_EQ(expected.values(port).at(0), "80");
+
+    // Damaged images are refused instead of being read out of bounds.
+    image[sizeof(detail::image_header) + 4] = 0x7F;
+    EXPECT_THROW(schema_image(image.data(), image.size()), std::invalid_argument);
+    EXPECT_THROW(schema_image(image.data(), image.size() - 1), std::invalid_argument);
+    EXPECT_THROW(schema_image("clp_test_missing.img"), std::invalid_argument);
+
+    p.add_option(typed_option<double>(option("r", "ratio")));
+    EXPECT_THROW(p.freeze()->serialize(), std::invalid_argument);
+}
+
+TEST(GeneratedTest, ParseMatchesParser)
+{
+    typedef test::generated_options gen;
+
+    parser p;
+    std::vector<option> opts = gen::options();
+    for (std::size_t o = 0; o < opts.size(); o++) {
+        p.add_option(opts[o]);
+    }
+
+    EXPECT_EQ(gen::find("input"), gen::opt_input);
+    EXPECT_EQ(gen::find("inplace"), gen::opt_inplace);
+    EXPECT_EQ(gen::find("x"), gen::opt_x);
+    EXPECT_EQ(gen::find("inpu"), gen::npos);
+    EXPECT_EQ(gen::find("inputs"), gen::npos);
+
+    char* argv[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("--port"),
+        const_cast<char*>("8080"),
+        const_cast<char*>("-r"),
+        const_cast<char*>("0.5"),
+        const_cast<char*>("1.5e2"),
+        const_cast<char*>("--level"),
+        const_cast<char*>("high"),
+        const_cast<char*>("--ids"),
+        const_cast<char*>("3;1;4"),
+        const_cast<char*>("--enabled"),
+        const_cast<char*>("yes"),
+        const_cast<char*>("-x"),
+        const_cast<char*>("--input"),
+        const_cast<char*>("a.txt"),
+        const_cast<char*>("b.txt")
+    };
+
+    arena          storage;
+    gen::result    r        = gen::parse(16, argv, storage);
+    result         expected = p.parse(16, argv);
+    ASSERT_EQ(r.good(), true);
+    ASSERT_EQ(expected.good(), true);
+    EXPECT_EQ(r.port()[0], expected.values_as<std::int64_t>("port")[0]);
+    ASSERT_EQ(r.ratio().size(), 2);
+    EXPECT_EQ(r.ratio()[1], 150.0);
+    EXPECT_EQ(r.level()[0], 10);
+    EXPECT_EQ(std::vector<std::int64_t>(std::begin(r.ids()), std::end(r.ids())),
+              std::vector<std::int64_t>({3, 1, 4}));
+    EXPECT_EQ(r.enabled()[0], true);
+    EXPECT_EQ(r.has_x(), true);
+    EXPECT_EQ(r.has_verbose(), false);
+    ASSERT_EQ(r.input().size(), 2);
+    EXPECT_EQ(r.input()[1], "b.txt");
+
+    // Errors come in the same order as those of the parser.
+    argv[2] = const_cast<char*>("http");
+    argv[7] = const_cast<char*>("highest");
+    argv[13] = const_cast<char*>("--inplace");
+    r        = gen::parse(16, argv, storage);
+    expected = p.parse(16, argv);
+    ASSERT_EQ(r.error_count(), expected.error_count());
+    ASSERT_EQ(r.error_count(), 2);
+    EXPECT_EQ(r.has_inplace(), true);
+    EXPECT_EQ(r.has_input(), false);
+    for (std::size_t e = 0; e < r.error_count(); e++) {
+        EXPECT_EQ(opts[r.error_at(e).ordinal].long_name, expected.errors[e].opt.long_name);
+        EXPECT_EQ(r.error_at(e).reason, expected.errors[e].reason);
+    }
+}
+
+TEST(AbbreviationTest, UniquePrefixes)
+{
+    parser p;
+    option_handle verbose = p.add_option(option(
+            "v",
+            "verbose",
+            option_type_e optional_option,
+            value_constraint_e no_values,
+            0,
+            ""));
+    p.add_option(option(
+            "",
+            "version",
+            option_type_e optional_option,
+            value_constraint_e no_values,
+            0,
+            ""));
+    option_handle output = p.add_option(option(
+            "o",
+            "output",
+            option_type_e optional_option,
+            value_constraint_e exact_num_values,
+            1,
+            ""));
+
+    char* argv[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("--verb"),
+        const_cast<char*>("--out"),
+        const_cast<char*>("a.txt")
+    };
+
+    // Off by default, abbreviations are unknown options.
+    result r = p.parse(4, argv);
+    EXPECT_EQ(r.good(), true);
+    EXPECT_EQ(r.has(verbose), false);
+    EXPECT_EQ(r.has(output), false);
+
+    p.allow_abbreviations(true);
+    r = p.parse(4, argv);
+    ASSERT_EQ(r.good(), true);
+    EXPECT_EQ(r.has(verbose), true);
+    ASSERT_EQ(r.values(output).size(), 1);
+    EXPECT_EQ(r.values(output)[0], "a.txt");
+
+    // Single dashes and exact names aren't abbreviations.
+    argv[1] = const_cast<char*>("-verb");
+    argv[2] = const_cast<char*>("--o");
+    r = p.parse(4, argv);
+    EXPECT_EQ(r.has(verbose), false);
+    EXPECT_EQ(r.has(output), true);
+
+    argv[1] = const_cast<char*>("--ver");
+    r = p.parse(4, argv);
+    ASSERT_EQ(r.error_count(), 1);
+    EXPECT_EQ(r.errors[0].reason, requirement_error_e ambiguous_option_error);
+    EXPECT_EQ(r.errors[0].opt.long_name.compare(0, 3, "ver"), 0);
+    EXPECT_EQ(r.has(output), true);
+
+    // Every option can be reached from thousands of others by a prefix of its own.
+    detail::name_trie trie;
+    std::vector<std::string> short_names(3000);
+    std::vector<std::string> long_names(3000);
+    for (std::size_t o = 0; o < long_names.size(); o++) {
+        long_names[o] = "option-" + std::to_string(o) + "-long";
+    }
+    trie.build(short_names, long_names);
+
+    std::size_t ordinal = 0;
+    EXPECT_EQ(trie.find("option-2999-l", true, ordinal), detail::name_trie::prefix_match);
+    EXPECT_EQ(ordinal, 2999);
+    EXPECT_EQ(trie.find("option-2999-l", false, ordinal), detail::name_trie::no_match);
+    EXPECT_EQ(trie.find("option-42-long", false, ordinal), detail::name_trie::exact_match);
+    EXPECT_EQ(ordinal, 42);
+    EXPECT_EQ(trie.find("option-29", true, ordinal), detail::name_trie::ambiguous_match);
+    EXPECT_EQ(ordinal, 29);
+    EXPECT_EQ(trie.find("option-x", true, ordinal), detail::name_trie::no_match);
+}
+
+TEST(CompleterTest, NamesAndValues)
+{
+    parser p;
+    p.add_option(option(
+            "v",
+            "verbose",
+            option_type_e optional_option,
+            value_constraint_e no_values,
+            0,
+            "Print more"));
+    p.add_option(option(
+            "",
+            "version",
+            option_type_e optional_option,
+            value_constraint_e no_values,
+            0,
+            "Print the version"));
+    p.add_option(enum_option(option(
+            "l",
+            "level",
+            option_type_e optional_option,
+            value_constraint_e exact_num_values,
+            1,
+            ""), {{"low", 1}, {"lower", 2}, {"high", 3}}));
+
+    completer c(p.freeze());
+    std::vector<completer::candidate> candidates;
+
+    std::vector<arg_view> words = {"--ver"};
+    ASSERT_EQ(c.complete(arg_span(words.data(), words.size()), candidates), 2);
+    EXPECT_EQ(candidates[0].text, "--verbose");
+    EXPECT_EQ(candidates[0].description, "Print more");
+    EXPECT_EQ(candidates[1].text, "--version");
+
+    // Options given already are left out, values complete to choices.
+    words = {"-v", "file", "--level", "lo"};
+    ASSERT_EQ(c.complete(arg_span(words.data(), words.size()), candidates), 2);
+    EXPECT_EQ(candidates[0].text, "low");
+    EXPECT_EQ(candidates[1].text, "lower");
+
+    words = {"-v", "-"};
+    ASSERT_EQ(c.complete(arg_span(words.data(), words.size()), candidates), 3);
+    EXPECT_EQ(candidates[0].text, "--level");
+    EXPECT_EQ(candidates[2].text, "-l");
+
+    words = {"--level", "high", "x"};
+    EXPECT_EQ(c.complete(arg_span(words.data(), words.size()), candidates), 0);
+
+    // Clusters and attached values count like separate words.
+    words = {"-vl", "h"};
+    ASSERT_EQ(c.complete(arg_span(words.data(), words.size()), candidates), 1);
+    EXPECT_EQ(candidates[0].text, "high");
+
+    words = {"--level=lo"};
+    ASSERT_EQ(c.complete(arg_span(words.data(), words.size()), candidates), 2);
+    EXPECT_EQ(candidates[1].text, "lower");
+
+    words = {"-lhigh", "-"};
+    ASSERT_EQ(c.complete(arg_span(words.data(), words.size()), candidates), 3);
+    EXPECT_EQ(candidates[0].text, "--verbose");
+    EXPECT_EQ(candidates[2].text, "-v");
+
+    words = {"--", "-"};
+    EXPECT_EQ(c.complete(arg_span(words.data(), words.size()), candidates), 0);
+
+    char* argv[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("--complete"),
+        const_cast<char*>("--verb")
+    };
+    std::ostringstream out;
+    EXPECT_EQ(c.handle(2, argv + 1, out), false);
+    EXPECT_EQ(c.handle(3, argv, out), true);
+    EXPECT_EQ(out.str(), "--verbose\tPrint more\n");
+
+    std::istringstream in("--level\th\n-\n");
+    out.str("");
+    c.serve(in, out);
+    EXPECT_EQ(out.str(), "high\n\n--level\n--verbose\tPrint more\n"
+                         "--version\tPrint the version\n-l\n-v\tPrint more\n\n");
+}
+
+TEST(SuggestTest, UnknownOptions)
+{
+    EXPECT_EQ(detail::edit_distance("verbose", "verbsoe", 10), 2);
+    EXPECT_EQ(detail::edit_distance("kitten", "sitting", 10), 3);
+    EXPECT_EQ(detail::edit_distance("", "abc", 10), 3);
+    EXPECT_GT(detail::edit_distance("kitten", "sitting", 1), 1);
+
+    std::string long_a(70, 'a');
+    std::string long_b = long_a;
+    long_b[3]  = 'b';
+    long_b    += "cd";
+    EXPECT_EQ(detail::edit_distance(long_a, long_b, 10), 3);
+    EXPECT_EQ(detail::edit_distance("abcdefgh", long_b, 100),
+              detail::edit_distance(long_b, "abcdefgh", 100));
+
+    parser p;
+    p.add_option(option(
+            "v",
+            "verbose",
+            option_type_e optional_option,
+            value_constraint_e no_values,
+            0,
+            ""));
+    p.add_option(option(
+            "",
+            "version",
+            option_type_e optional_option,
+            value_constraint_e no_values,
+            0,
+            ""));
+    p.add_option(option(
+            "o",
+            "output",
+            option_type_e optional_option,
+            value_constraint_e exact_num_values,
+            1,
+            ""));
+
+    char* argv[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("--verbsoe"),
+        const_cast<char*>("--output"),
+        const_cast<char*>("a.txt"),
+        const_cast<char*>("--ouptut"),
+        const_cast<char*>("--xyz")
+    };
+
+    result r = p.parse(6, argv);
+    EXPECT_EQ(r.good(), true);
+    ASSERT_EQ(r.unknown_count(), 3);
+    EXPECT_EQ(r.unknown_at(0), "--verbsoe");
+    EXPECT_EQ(r.unknown_at(2), "--xyz");
+    EXPECT_THROW(r.unknown_at(3), std::out_of_range);
+
+    // Only the closest names, "--version" is one edit further away.
+    EXPECT_EQ(r.suggestions(0), std::vector<std::string>({"--verbose"}));
+    EXPECT_EQ(p.freeze()->suggest("verzion", 3), std::vector<std::string>({"--version"}));
+
+    // Ties come in the order of the schema.
+    std::shared_ptr<const schema> frozen = p.freeze();
+    std::vector<std::string>      tie    = frozen->suggest("versone", 3);
+    ASSERT_EQ(tie.size(), 2);
+    EXPECT_EQ(tie[0], frozen->find("verbose") < frozen->find("version") ? "--verbose"
+                                                                        : "--version");
+    EXPECT_EQ(frozen->suggest("versone", 1), std::vector<std::string>(1, tie[0]));
+    EXPECT_EQ(r.suggestions(1), std::vector<std::string>({"--output"}));
+    EXPECT_EQ(r.suggestions(2).empty(), true);
+
+    result copy = r;
+    ASSERT_EQ(copy.unknown_count(), 3);
+    EXPECT_EQ(copy.unknown_at(1), "--ouptut");
+}
+
+TEST(SnapshotTest, PublishWhileReading)
+{
+    parser p;
+    option_handle port = p.add_option(typed_option<std::int64_t>(option(
+            "p",
+            "port",
+            option_type_e mandatory_option,
+            value_constraint_e exact_num_values,
+            1,
+            "")));
+    std::shared_ptr<const schema> frozen = p.freeze();
+
+    // The snapshot owns its copy of the command line.
+    std::shared_ptr<const snapshot> first;
+    {
+        std::string arg = "8000";
+        char* argv[] = {const_cast<char*>("app"), const_cast<char*>("-p"), &arg[0]};
+        first = snapshot::create(frozen, 3, argv);
+        arg   = "9999";
+    }
+    ASSERT_EQ(first->parsed().good(), true);
+    EXPECT_EQ(first->parsed().values_from_option("port")[0], "8000");
+    EXPECT_EQ(first->arguments().size(), 3);
+
+    std::weak_ptr<const snapshot> watch = first;
+    snapshot_publisher            publisher(first);
+    first.reset();
+    EXPECT_EQ(publisher.generation(), 1);
+
+    // Readers always see a complete snapshot, one of those published.
+    std::atomic<bool>        stop(false);
+    std::atomic<std::size_t> bad(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; t++) {
+        readers.push_back(std::thread([&]() {
+            while (!stop.load()) {
+                snapshot_publisher::guard g = publisher.read();
+                value_span<std::int64_t> values = g->parsed().values_as<std::int64_t>(port);
+                if (1 != values.size() || values[0] < 8000 || values[0] > 8050) {
+                    bad++;
+                }
+            }
+        }));
+    }
+
+    std::shared_ptr<const snapshot> kept;
+    for (int n = 1; n <= 50; n++) {
+        publisher.publish(snapshot::create(
+                frozen, {"app", "--port", std::to_string(static_cast<long long>(8000 + n))}));
+        if (1 == n) {
+            EXPECT_EQ(watch.expired(), true); // Released once its readers are done.
+            kept = publisher.acquire();
+        }
+    }
+    stop = true;
+    for (std::size_t t = 0; t < readers.size(); t++) {
+        readers[t].join();
+    }
+
+    EXPECT_EQ(bad.load(), 0);
+    EXPECT_EQ(publisher.generation(), 51);
+    EXPECT_EQ(publisher.read()->parsed().values_as<std::int64_t>(port)[0], 8050);
+    EXPECT_EQ(kept->parsed().values_as<std::int64_t>("port")[0], 8001);
+}
+
+TEST(SettingsTest, CommandLineBeforeEnvironmentBeforeFile)
+{
+    {
+        std::ofstream out("clp_test.conf", std::ios::binary);
+        out << "# defaults\r\n"
+               "ip = 10.0.0.1\n"
+               "port=80 443\n"
+               "\n"
+               "  title = \"  spaced  \"\n"
+               "verbose\n"
+               "quiet = yes\n"
+               "prot = 1\n";
+    }
+
+    std::shared_ptr<const config_file> file(new config_file("clp_test.conf"));
+    ASSERT_EQ(file->is_open(), true);
+    ASSERT_EQ(file->entries().size(), 6);
+    EXPECT_EQ(file->entries()[2].key, "title");
+    EXPECT_EQ(file->entries()[2].value, "  spaced  ");
+    EXPECT_EQ(file->entries()[3].key, "verbose");
+    EXPECT_EQ(file->entries()[3].value, "");
+
+    char* env[] = {
+        const_cast<char*>("PATH=/bin"),
+        const_cast<char*>("TOOL_PORT=8080"),
+        const_cast<char*>("TOOL_QUIET=off"),
+        const_cast<char*>("TOOL_LOG_LEVEL=debug"),
+        const_cast<char*>("TOOL_T=short"),
+        0
+    };
+    std::shared_ptr<const environment> vars(new environment("TOOL_", env));
+    ASSERT_EQ(vars->entries().size(), 4);
+    EXPECT_EQ(vars->entries()[2].key, "log-level");
+    EXPECT_EQ(vars->entries()[2].value, "debug");
+
+    parser p;
+    option_handle ip = p.add_option(option("i", "ip", option_type_e mandatory_option,
+            value_constraint_e exact_num_values, 1, ""));
+    p.add_option(option("p", "port", option_type_e optional_option,
+            value_constraint_e unlimited_num_values, 0, ""));
+    p.add_option(option("t", "title", option_type_e optional_option,
+            value_constraint_e exact_num_values, 1, ""));
+    p.add_option(option("v", "verbose", option_type_e optional_option,
+            value_constraint_e no_values, 0, ""));
+    p.add_option(option("q", "quiet", option_type_e optional_option,
+            value_constraint_e no_values, 0, ""));
+    p.add_option(option("l", "log-level", option_type_e optional_option,
+            value_constraint_e exact_num_values, 1, ""));
+
+    char* argv[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("--ip"),
+        const_cast<char*>("192.168.0.1")
+    };
+    std::vector<std::shared_ptr<const settings>> layers;
+    layers.push_back(vars);
+    layers.push_back(file);
+    result r = p.parse(3, argv, layers);
+    std::remove("clp_test.conf");
+
+    EXPECT_EQ(r.good(), true);
+    EXPECT_EQ(r.values(ip).at(0), "192.168.0.1");
+    EXPECT_EQ(r.values_from_option("port"), std::vector<std::string>(1, "8080"));
+    EXPECT_EQ(r.values_from_option("title").at(0), "  spaced  ");
+    EXPECT_EQ(r.has_option("verbose"), true);
+    EXPECT_EQ(r.has_option("quiet"), false);
+    EXPECT_EQ(r.values_from_option("log-level").at(0), "debug");
+
+    // Keys are long names only.
+    ASSERT_EQ(r.unknown_count(), 2);
+    EXPECT_EQ(r.unknown_at(0), "t");
+    EXPECT_EQ(r.unknown_at(1), "prot");
+    EXPECT_EQ(r.suggestions(1).at(0), "--port");
+
+    // Without the environment the file decides, the mandatory option may come from it.
+    char* bare[] = {const_cast<char*>("app")};
+    layers.erase(layers.begin());
+    result from_file = p.freeze()->parse(1, bare, layers);
+    file.reset();
+    layers.clear();
+
+    EXPECT_EQ(from_file.good(), true);
+    EXPECT_EQ(from_file.values(ip).at(0), "10.0.0.1");
+    std::vector<std::string> ports = from_file.values_from_option("port");
+    ASSERT_EQ(ports.size(), 2);
+    EXPECT_EQ(ports[0], "80");
+    EXPECT_EQ(ports[1], "443");
+    EXPECT_EQ(from_file.has_option("quiet"), true);
+}
+
+TEST(CommandTest, OnlyNamedCommandsAreBuilt)
+{
+    std::vector<std::string> built;
+    auto options = [&built](const std::string& name, const std::string& long_name,
+                            value_constraint constraint, unsigned int count) {
+        return [&built, name, long_name, constraint, count]() {
+            built.push_back(name);
+            parser p;
+            p.add_option(option("", long_name, option_type_e optional_option,
+                                constraint, count, ""));
+            return p;
+        };
+    };
+
+    command app("", options("app", "level", value_constraint_e exact_num_values, 1));
+    command& remote = app.add("remote",
+            options("remote", "verbose", value_constraint_e no_values, 0), "Remotes");
+    remote.add("add", options("add", "tags", value_constraint_e unlimited_num_values, 0));
+    app.add("commit", options("commit", "message", value_constraint_e exact_num_values, 1));
+
+    char* argv[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("--level"),
+        const_cast<char*>("3"),
+        const_cast<char*>("remote"),
+        const_cast<char*>("--verbose"),
+        const_cast<char*>("add"),
+        const_cast<char*>("--tags"),
+        const_cast<char*>("a"),
+        const_cast<char*>("b"),
+        const_cast<char*>("origin")
+    };
+    std::vector<command_level> levels = app.dispatch(10, argv);
+
+    ASSERT_EQ(levels.size(), 3);
+    EXPECT_EQ(built, std::vector<std::string>({"app", "remote", "add"}));
+    EXPECT_EQ(levels[0].cmd, &app);
+    EXPECT_EQ(levels[0].parsed.values_from_option("level").at(0), "3");
+    EXPECT_EQ(levels[1].cmd->name(), "remote");
+    EXPECT_EQ(levels[1].parsed.has_option("verbose"), true);
+    EXPECT_EQ(levels[2].cmd->name(), "add");
+    EXPECT_EQ(levels[2].parsed.values_from_option("tags"),
+              std::vector<std::string>({"a", "b", "origin"}));
+    for (std::size_t l = 0; l < levels.size(); l++) {
+        EXPECT_EQ(levels[l].parsed.good(), true);
+    }
+
+    // The name of a sub-command that parse takes as a value is no sub-command, an attached
+    // value doesn't hide the name behind it.
+    char* plain[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("--level"),
+        const_cast<char*>("commit")
+    };
+    built.clear();
+    levels = app.dispatch(3, plain);
+    ASSERT_EQ(levels.size(), 1);
+    EXPECT_EQ(levels[0].parsed.good(), true);
+    EXPECT_EQ(levels[0].parsed.values_from_option("level").at(0), "commit");
+    EXPECT_EQ(built, std::vector<std::string>({"app"}));
+
+    char* attached[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("--level=2"),
+        const_cast<char*>("commit")
+    };
+    built.clear();
+    levels = app.dispatch(3, attached);
+    ASSERT_EQ(levels.size(), 2);
+    EXPECT_EQ(levels[0].parsed.values_from_option("level").at(0), "2");
+    EXPECT_EQ(levels[1].cmd->name(), "commit");
+    EXPECT_EQ(built, std::vector<std::string>({"app", "commit"}));
+
+    built.clear();
+    levels = app.dispatch(1, plain);
+    ASSERT_EQ(levels.size(), 1);
+    EXPECT_EQ(built, std::vector<std::string>({"app"}));
+
+    std::ostringstream help;
+    app.print_help(help, false);
+    EXPECT_NE(help.str().find("remote   Remotes"), std::string::npos);
+    EXPECT_EQ(built.size(), 2);
+}
+
+TEST(ClusterTest, ShortClustersAndAttachedValues)
+{
+    parser p;
+    option_handle extract = p.add_option(option("x", "extract",
+            option_type_e optional_option, value_constraint_e no_values, 0, ""));
+    option_handle verbose = p.add_option(option("v", "verbose",
+            option_type_e optional_option, value_constraint_e no_values, 0, ""));
+    option_handle file = p.add_option(option("f", "file",
+            option_type_e optional_option, value_constraint_e exact_num_values, 1, ""));
+    option_handle output = p.add_option(option("o", "output",
+            option_type_e optional_option, value_constraint_e exact_num_values, 1, ""));
+    option_handle level = p.add_option(typed_option<std::int64_t>(option("l", "level",
+            option_type_e optional_option, value_constraint_e exact_num_values, 1, "")));
+    option_handle tags = p.add_option(option("t", "tags",
+            option_type_e optional_option, value_constraint_e unlimited_num_values, 0, ""));
+
+    char* argv[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("-xvf"),
+        const_cast<char*>("archive.tar"),
+        const_cast<char*>("-oout.txt"),
+        const_cast<char*>("-l7"),
+        const_cast<char*>("--tags=a=1"),
+        const_cast<char*>("b"),
+        const_cast<char*>("-xq")
+    };
+    result r = p.parse(8, argv);
+    ASSERT_EQ(r.good(), true);
+    EXPECT_EQ(r.has(extract), true);
+    EXPECT_EQ(r.has(verbose), true);
+    EXPECT_EQ(r.values(file).at(0), "archive.tar");
+    EXPECT_EQ(r.values(output).at(0), "out.txt");
+    EXPECT_EQ(r.values_as<std::int64_t>(level).at(0), 7);
+    ASSERT_EQ(r.values(tags).size(), 2);
+    EXPECT_EQ(r.values(tags)[0], "a=1");
+    EXPECT_EQ(r.values(tags)[1], "b");
+
+    // Slices point into argv, a cluster with an unknown name stays unknown as a whole.
+    EXPECT_EQ(r.values(output)[0].data(), argv[3] + 2);
+    ASSERT_EQ(r.unknown_count(), 1);
+    EXPECT_EQ(r.unknown_at(0), "-xq");
+
+    char* flag[] = {
+        const_cast<char*>("app"),
+        const_cast<char*>("--verbose=yes"),
+        const_cast<char*>("--file=")
+    };
+    r = p.parse(3, flag);
+    ASSERT_EQ(r.error_count(), 1);
+    EXPECT_EQ(r.errors[0].opt.long_name, "verbose");
+    EXPECT_EQ(r.errors[0].reason, requirement_error_e unexpected_value_error);
+    EXPECT_EQ(r.values(file).at(0), "");
+}
+
+TEST(ForwardTest, TerminatorAndUnknownOptions)
+{
+    parser p;
+    option_handle files = p.add_option(option("f", "files",
+            option_type_e optional_option, value_constraint_e unlimited_num_values, 0, ""));
+    option_handle verbose = p.add_option(option("v", "verbose",
+            option_type_e optional_option, value_constraint_e no_values, 0, ""));
+
+    char* argv[] = {
+        const_cast<char*>("wrap"),
+        const_cast<char*>("--files"),
+        const_cast<char*>("a"),
+        const_cast<char*>("--"),
+        const_cast<char*>("cc"),
+        const_cast<char*>("-v"),
+        const_cast<char*>("--"),
+        0
+    };
+    result r = p.parse(7, argv);
+    ASSERT_EQ(r.good(), true);
+    ASSERT_EQ(r.values(files).size(), 1);
+    EXPECT_EQ(r.has(verbose), false);
+
+    // The span can go to execv as it is.
+    argv_span rest = r.forwarded();
+    ASSERT_EQ(rest.size(), 3);
+    EXPECT_EQ(rest.begin(), argv + 4);
+    EXPECT_EQ(rest.begin()[rest.size()], static_cast<char*>(0));
+    EXPECT_EQ(rest[2], "--");
+
+    // Unknown options are skipped unless they are passed through.
+    char* unknown[] = {
+        const_cast<char*>("wrap"),
+        const_cast<char*>("-v"),
+        const_cast<char*>("--jobs"),
+        const_cast<char*>("4"),
+        const_cast<char*>("-f"),
+        const_cast<char*>("x"),
+        0
+    };
+    r = p.parse(6, unknown);
+    EXPECT_EQ(r.unknown_count(), 1);
+    EXPECT_EQ(r.has(files), true);
+    EXPECT_EQ(r.forwarded().empty(), true);
+
+    p.pass_through_unknown(true);
+    r = p.parse(6, unknown);
+    EXPECT_EQ(r.unknown_count(), 0);
+    EXPECT_EQ(r.has(verbose), true);
+    EXPECT_EQ(r.has(files), false);
+    ASSERT_EQ(r.forwarded().size(), 4);
+    EXPECT_EQ(r.forwarded().begin(), unknown + 2);
+
+    // A terminator behind the unknown option is forwarded with it.
+    char* both[] = {
+        const_cast<char*>("wrap"),
+        const_cast<char*>("--unknown"),
+        const_cast<char*>("a"),
+        const_cast<char*>("--"),
+        const_cast<char*>("b"),
+        const_cast<char*>("c"),
+        0
+    };
+    r = p.parse(6, both);
+    rest = r.forwarded();
+    ASSERT_EQ(rest.size(), 5);
+    EXPECT_EQ(rest.begin(), both + 1);
+    EXPECT_EQ(rest.begin()[rest.size()], static_cast<char*>(0));
+}
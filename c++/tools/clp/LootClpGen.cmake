@@ -0,0 +1,54 @@
+#
+#   Copyright (c) 2013, Robert Lohr
+#   All rights reserved.
+#
+#   Redistribution and use in source and binary forms, with or without
+#   modification, are permitted provided that the following conditions are met:
+#
+#   1. Redistributions of source code must retain the above copyright notice, this
+#      list of conditions and the following disclaimer.
+#   2. Redistributions in binary form must reproduce the above copyright notice,
+#      this list of conditions and the following disclaimer in the documentation
+#      and/or other materials provided with the distribution.
+#
+#   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+#   ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+#   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+#   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+#   ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+#   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+#   LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+#   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+#   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+#   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+#   The views and conclusions contained in the software and documentation are those
+#   of the authors and should not be interpreted as representing official policies,
+#   either expressed or implied, of the FreeBSD Project.
+#
+
+# loot_clp_generate(<var> <spec>)
+#
+# Generates a parser for the options in <spec> with loot-clp-gen while building and
+# appends the generated header and source to <var>. Both are named after <spec> and placed
+# into the current binary directory, which is added to the include directories:
+#
+#   loot_clp_generate(MY_SOURCES options.spec)     # options.h, options.cpp
+#   add_executable(my-tool main.cpp ${MY_SOURCES})
+#   target_link_libraries(my-tool loot-clp)
+function(loot_clp_generate var spec)
+    get_filename_component(name ${spec} NAME_WE)
+    get_filename_component(path ${spec} ABSOLUTE)
+
+    set(header ${CMAKE_CURRENT_BINARY_DIR}/${name}.h)
+    set(source ${CMAKE_CURRENT_BINARY_DIR}/${name}.cpp)
+
+    add_custom_command(OUTPUT ${header} ${source}
+                       COMMAND loot-clp-gen --spec ${path} --header ${header} --source ${source}
+                       DEPENDS loot-clp-gen ${path}
+                       COMMENT "Generating ${name}.h and ${name}.cpp from ${spec}")
+
+    include_directories(${CMAKE_CURRENT_BINARY_DIR})
+
+    set(${var} ${${var}} ${header} ${source} PARENT_SCOPE)
+endfunction(loot_clp_generate)
@@ -0,0 +1,986 @@
+/*
+    Copyright (c) 2013, Robert Lohr
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+    ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those
+    of the authors and should not be interpreted as representing official policies,
+    either expressed or implied, of the FreeBSD Project.
+*/
+
+/*
+    loot-clp-gen reads a specification of options and generates C++ code that parses a
+    command line with them, in the spirit of gperf. The generated class matches names with
+    nested switch statements over the length and the characters that tell the names
+    apart, keeps its option descriptors in constant tables and offers a typed accessor per
+    option. Parsing uses the engine of loot::clp, so the results are those of
+    loot::clp::schema::parse, errors included, without any name lookup in a hash table
+    and without allocating memory outside of the arena passed in. Like a static_schema it
+    only takes values that are whole arguments: Attached values (-ofile, --out=file) are
+    unknown option switches, long names can't be abbreviated and the arguments behind
+    "--" aren't kept.
+
+    Usage: loot-clp-gen --spec file --header file.h --source file.cpp
+
+    A specification has one statement per line, empty lines and lines starting with "#"
+    are ignored:
+
+        namespace <name>[::<name>...]
+        class <name>
+        option <short> <long> <type> <values> <conversion> [description]
+
+    - <short>, <long>: the names without hyphens, "-" for none
+    - <type>: mandatory, optional or help
+    - <values>: none, unlimited, exact:<n> or up-to:<n>
+    - <conversion>: text, integer, real, boolean, list[:<delimiter>] or
+      enum:<name>=<number>[,<name>=<number>...]
+    - [description]: the rest of the line
+
+    The accessors are named after the long name, or the short name if there is none, with
+    characters that aren't allowed in identifiers replaced by "_".
+*/
+
+#include <clp/parser.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace loot::clp;
+
+namespace {
+
+/*!
+    One option of the specification.
+*/
+struct spec_option
+{
+    std::string  short_name;
+    std::string  long_name;
+    std::string  type;
+    std::string  constraint;
+    unsigned int num_expected_values;
+    std::string  conversion;
+    char         delimiter;
+    std::string  description;
+    std::string  identifier;
+
+    std::vector<std::pair<std::string, long long>> choices;
+};
+
+/*!
+    The whole specification.
+*/
+struct spec
+{
+    std::vector<std::string> namespaces;
+    std::string              class_name;
+    std::vector<spec_option> options;
+};
+
+/*!
+    Thrown for malformed specifications.
+*/
+class spec_error : public std::runtime_error
+{
+public:
+    spec_error(std::size_t line, const std::string& message)
+        : std::runtime_error(message), line(line)
+    {}
+
+    std::size_t line;
+};
+
+const char* const keywords[] = {
+    "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool",
+    "break", "case", "catch", "char", "char16_t", "char32_t", "class", "compl", "const",
+    "constexpr", "const_cast", "continue", "decltype", "default", "delete", "do",
+    "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false",
+    "float", "for", "friend", "goto", "if", "inline", "int", "long", "mutable",
+    "namespace", "new", "noexcept", "not", "not_eq", "nullptr", "operator", "or",
+    "or_eq", "private", "protected", "public", "register", "reinterpret_cast", "return",
+    "short", "signed", "sizeof", "static", "static_assert", "static_cast", "struct",
+    "switch", "template", "this", "thread_local", "throw", "true", "try", "typedef",
+    "typeid", "typename", "union", "unsigned", "using", "virtual", "void", "volatile",
+    "wchar_t", "while", "xor", "xor_eq",
+    // Members of the generated result.
+    "argv", "count", "converted", "error_at", "error_count", "errors", "first", "found",
+    "good", "num_converted", "num_errors", "result"
+};
+
+bool
+is_identifier(const std::string& name)
+{
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+        return false;
+    }
+    for (std::size_t c = 0; c < name.size(); c++) {
+        if (!std::isalnum(static_cast<unsigned char>(name[c])) && '_' != name[c]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+    Turns the name of an option into the name of its accessor.
+*/
+std::string
+to_identifier(const std::string& name)
+{
+    std::string id = name;
+    for (std::size_t c = 0; c < id.size(); c++) {
+        if (!std::isalnum(static_cast<unsigned char>(id[c]))) {
+            id[c] = '_';
+        }
+    }
+    if (std::isdigit(static_cast<unsigned char>(id[0]))) {
+        id = "_" + id;
+    }
+    for (std::size_t k = 0; k < sizeof(keywords) / sizeof(keywords[0]); k++) {
+        if (id == keywords[k]) {
+            return id + "_";
+        }
+    }
+    return id;
+}
+
+unsigned int
+parse_count(std::size_t line, const std::string& text)
+{
+    char* end = 0;
+    unsigned long count = std::strtoul(text.c_str(), &end, 10);
+    if (text.empty() || '\0' != *end || 0 == count) {
+        throw spec_error(line, "expected a positive number instead of \"" + text + "\"");
+    }
+    return static_cast<unsigned int>(count);
+}
+
+void
+parse_values(std::size_t line, const std::string& field, spec_option& opt)
+{
+    opt.num_expected_values = 0;
+    if ("none" == field) {
+        opt.constraint = "no_values";
+    }
+    else if ("unlimited" == field) {
+        opt.constraint = "unlimited_num_values";
+    }
+    else if (0 == field.compare(0, 6, "exact:")) {
+        opt.constraint          = "exact_num_values";
+        opt.num_expected_values = parse_count(line, field.substr(6));
+    }
+    else if (0 == field.compare(0, 6, "up-to:")) {
+        opt.constraint          = "up_to_num_values";
+        opt.num_expected_values = parse_count(line, field.substr(6));
+    }
+    else {
+        throw spec_error(line, "unknown values \"" + field + "\"");
+    }
+}
+
+void
+parse_conversion(std::size_t line, const std::string& field, spec_option& opt)
+{
+    opt.delimiter = ',';
+    if ("text" == field || "integer" == field || "real" == field || "boolean" == field) {
+        opt.conversion = field + "_value";
+    }
+    else if ("list" == field.substr(0, 4) && (4 == field.size() || ':' == field[4])) {
+        opt.conversion = "integer_list_value";
+        if (field.size() > 4) {
+            if (6 != field.size()) {
+                throw spec_error(line, "the delimiter of a list is one character");
+            }
+            opt.delimiter = field[5];
+        }
+    }
+    else if (0 == field.compare(0, 5, "enum:")) {
+        opt.conversion = "enum_value";
+
+        std::istringstream choices(field.substr(5));
+        std::string        choice;
+        while (std::getline(choices, choice, ',')) {
+            std::size_t equals = choice.find('=');
+            char*       end    = 0;
+            long long   number = std::strtoll(equals == std::string::npos
+                                              ? "" : choice.c_str() + equals + 1, &end, 10);
+            if (std::string::npos == equals || 0 == equals || equals + 1 == choice.size()
+                    || '\0' != *end) {
+                throw spec_error(line, "expected <name>=<number> instead of \"" + choice
+                                       + "\"");
+            }
+            opt.choices.push_back(std::make_pair(choice.substr(0, equals), number));
+        }
+        if (opt.choices.empty()) {
+            throw spec_error(line, "an enum needs at least one choice");
+        }
+    }
+    else {
+        throw spec_error(line, "unknown conversion \"" + field + "\"");
+    }
+}
+
+std::string
+parse_name(std::size_t line, const std::string& field)
+{
+    if ("-" == field) {
+        return "";
+    }
+    if ('-' == field[0] || std::string::npos != field.find('=')) {
+        throw spec_error(line, "invalid option name \"" + field + "\"");
+    }
+    return field;
+}
+
+spec
+read_spec(std::istream& in)
+{
+    spec        s;
+    std::string text;
+    std::size_t line = 0;
+    while (std::getline(in, text)) {
+        line++;
+
+        std::istringstream fields(text);
+        std::string        keyword;
+        if (!(fields >> keyword) || '#' == keyword[0]) {
+            continue;
+        }
+
+        if ("namespace" == keyword) {
+            std::string name;
+            fields >> name;
+            s.namespaces.clear();
+            for (std::size_t start = 0; start <= name.size(); ) {
+                std::size_t stop = name.find("::", start);
+                stop = std::string::npos == stop ? name.size() : stop;
+                if (!is_identifier(name.substr(start, stop - start))) {
+                    throw spec_error(line, "invalid namespace \"" + name + "\"");
+                }
+                s.namespaces.push_back(name.substr(start, stop - start));
+                start = stop + 2;
+            }
+        }
+        else if ("class" == keyword) {
+            fields >> s.class_name;
+            if (!is_identifier(s.class_name)) {
+                throw spec_error(line, "invalid class name \"" + s.class_name + "\"");
+            }
+        }
+        else if ("option" == keyword) {
+            std::string short_name, long_name, type, values, conversion;
+            if (!(fields >> short_name >> long_name >> type >> values >> conversion)) {
+                throw spec_error(line, "expected <short> <long> <type> <values> "
+                                       "<conversion> [description]");
+            }
+
+            spec_option opt;
+            opt.short_name = parse_name(line, short_name);
+            opt.long_name  = parse_name(line, long_name);
+            if (opt.short_name.empty() && opt.long_name.empty()) {
+                throw spec_error(line, "an option needs a name");
+            }
+
+            if ("mandatory" == type || "optional" == type || "help" == type) {
+                opt.type = type + "_option";
+            }
+            else {
+                throw spec_error(line, "unknown type \"" + type + "\"");
+            }
+
+            parse_values(line, values, opt);
+            parse_conversion(line, conversion, opt);
+
+            std::getline(fields, opt.description);
+            std::size_t start = opt.description.find_first_not_of(" \t");
+            opt.description = std::string::npos == start ? ""
+                                                         : opt.description.substr(start);
+            opt.identifier = to_identifier(opt.long_name.empty() ? opt.short_name
+                                                                 : opt.long_name);
+
+            if (!opt.short_name.empty() && opt.short_name == opt.long_name) {
+                throw spec_error(line, "duplicate name \"" + opt.short_name + "\"");
+            }
+            for (std::size_t o = 0; o < s.options.size(); o++) {
+                const spec_option& other = s.options[o];
+                const std::string* names[] = {&opt.short_name, &opt.long_name};
+                for (std::size_t n = 0; n < 2; n++) {
+                    if (!names[n]->empty() && (*names[n] == other.short_name
+                                               || *names[n] == other.long_name)) {
+                        throw spec_error(line, "duplicate name \"" + *names[n] + "\"");
+                    }
+                }
+                if (opt.identifier == other.identifier) {
+                    throw spec_error(line, "accessor \"" + opt.identifier
+                                           + "\" is already taken");
+                }
+            }
+            s.options.push_back(opt);
+        }
+        else {
+            throw spec_error(line, "unknown statement \"" + keyword + "\"");
+        }
+    }
+
+    if (s.class_name.empty()) {
+        throw spec_error(line, "missing class statement");
+    }
+    if (s.options.empty()) {
+        throw spec_error(line, "no options");
+    }
+
+    // Same order as loot::clp::schema, so errors are reported in the same order.
+    std::stable_sort(std::begin(s.options), std::end(s.options),
+                     [](const spec_option& lhs, const spec_option& rhs) {
+        return option(lhs.short_name, lhs.long_name, option_type_e optional_option,
+                      value_constraint_e no_values, 0, "")
+             < option(rhs.short_name, rhs.long_name, option_type_e optional_option,
+                      value_constraint_e no_values, 0, "");
+    });
+    return s;
+}
+
+/*!
+    Writes `text` as a C++ string literal.
+*/
+std::string
+literal(const std::string& text)
+{
+    std::ostringstream out;
+    out << '"';
+    for (std::size_t c = 0; c < text.size(); c++) {
+        unsigned char ch = static_cast<unsigned char>(text[c]);
+        if ('"' == ch || '\\' == ch) {
+            out << '\\' << text[c];
+        }
+        else if (ch < 0x20 || ch >= 0x7F) {
+            // Octal escapes end after three digits, unlike hexadecimal ones.
+            out << '\\' << static_cast<char>('0' + (ch >> 6))
+                << static_cast<char>('0' + ((ch >> 3) & 7))
+                << static_cast<char>('0' + (ch & 7));
+        }
+        else {
+            out << text[c];
+        }
+    }
+    out << '"';
+    return out.str();
+}
+
+std::string
+char_literal(char c)
+{
+    std::string text = literal(std::string(1, c));
+    if ("\"'\"" == text) {
+        return "'\\''";
+    }
+    if ("\"\\\"\"" == text) {
+        return "'\"'";
+    }
+    return "'" + text.substr(1, text.size() - 2) + "'";
+}
+
+/*!
+    A name to match and the option it belongs to.
+*/
+typedef std::pair<std::string, std::size_t> name_entry;
+
+/*!
+    Emits the statements that match `names`, which all have the same length. Switches
+    over the character that tells most of them apart, until one name is left that is
+    compared completely.
+*/
+void
+emit_matcher(std::ostream&                  out,
+             const std::vector<name_entry>& names,
+             const spec&                    s,
+             const std::string&             indent)
+{
+    if (1 == names.size()) {
+        out << indent << "return 0 == std::memcmp(n, " << literal(names[0].first) << ", "
+            << names[0].first.size() << ") ? static_cast<std::size_t>(opt_"
+            << s.options[names[0].second].identifier << ") : npos;\n";
+        return;
+    }
+
+    std::size_t best          = 0;
+    std::size_t best_distinct = 0;
+    for (std::size_t pos = 0; pos < names[0].first.size(); pos++) {
+        std::set<char> distinct;
+        for (std::size_t n = 0; n < names.size(); n++) {
+            distinct.insert(names[n].first[pos]);
+        }
+        if (distinct.size() > best_distinct) {
+            best          = pos;
+            best_distinct = distinct.size();
+        }
+    }
+
+    std::vector<name_entry> sorted(names);
+    std::stable_sort(std::begin(sorted), std::end(sorted),
+                     [best](const name_entry& lhs, const name_entry& rhs) {
+        return lhs.first[best] < rhs.first[best];
+    });
+
+    out << indent << "switch (n[" << best << "]) {\n";
+    for (std::size_t first = 0; first < sorted.size(); ) {
+        std::size_t last = first;
+        while (last < sorted.size() && sorted[last].first[best] == sorted[first].first[best]) {
+            last++;
+        }
+
+        out << indent << "case " << char_literal(sorted[first].first[best]) << ":\n";
+        emit_matcher(out,
+                     std::vector<name_entry>(sorted.begin() + first, sorted.begin() + last),
+                     s,
+                     indent + "    ");
+        first = last;
+    }
+    out << indent << "}\n" << indent << "return npos;\n";
+}
+
+std::string
+value_type_of(const spec_option& opt)
+{
+    if ("real_value" == opt.conversion) {
+        return "double";
+    }
+    if ("boolean_value" == opt.conversion) {
+        return "bool";
+    }
+    return "std::int64_t";
+}
+
+void
+open_namespaces(std::ostream& out, const spec& s)
+{
+    for (std::size_t n = 0; n < s.namespaces.size(); n++) {
+        out << "namespace " << s.namespaces[n] << " {\n";
+    }
+    out << "\n";
+}
+
+void
+close_namespaces(std::ostream& out, const spec& s)
+{
+    out << "\n";
+    for (std::size_t n = s.namespaces.size(); n > 0; n--) {
+        out << "} // namespace " << s.namespaces[n - 1] << "\n";
+    }
+}
+
+void
+write_header(std::ostream& out, const spec& s, const std::string& spec_path)
+{
+    std::string guard = "LOOT_CLP_GEN_";
+    for (std::size_t n = 0; n < s.namespaces.size(); n++) {
+        guard += s.namespaces[n] + "_";
+    }
+    guard += s.class_name + "_H";
+    std::transform(std::begin(guard), std::end(guard), std::begin(guard), ::toupper);
+
+    std::size_t num = s.options.size();
+    out << "// Generated by loot-clp-gen from " << spec_path << ", do not edit.\n\n"
+        << "#ifndef " << guard << "\n#define " << guard << "\n\n"
+        << "#include <clp/arena.h>\n"
+        << "#include <clp/arg_view.h>\n"
+        << "#include <clp/args.h>\n"
+        << "#include <clp/convert.h>\n"
+        << "#include <clp/option.h>\n\n"
+        << "#include <cstddef>\n"
+        << "#include <cstdint>\n"
+        << "#include <vector>\n\n";
+    open_namespaces(out, s);
+
+    out << "/*!\n"
+        << "    The options of " << spec_path << ". Parsing follows the rules of\n"
+        << "    `loot::clp::schema::parse` with `options()`, without looking names up in a\n"
+        << "    table and without allocating memory outside of the arena passed to `parse`.\n"
+        << "    Values are whole arguments though: Attached values like `-ofile` and\n"
+        << "    `--out=file` are unknown option switches, long names can't be abbreviated\n"
+        << "    and the arguments behind \"`--`\" aren't kept.\n"
+        << "*/\n"
+        << "class " << s.class_name << "\n{\npublic:\n"
+        << "    /*!\n        The options, in the order of `loot::clp::schema`.\n    */\n"
+        << "    enum id\n    {\n";
+    for (std::size_t o = 0; o < num; o++) {
+        out << "        opt_" << s.options[o].identifier << (o + 1 < num ? ",\n" : "\n");
+    }
+    out << "    };\n\n"
+        << "    static const std::size_t num_options = " << num << ";\n"
+        << "    static const std::size_t npos = static_cast<std::size_t>(-1);\n\n"
+        << "    /*!\n        A validation error found by `parse`.\n    */\n"
+        << "    struct error\n    {\n"
+        << "        std::size_t                   ordinal;\n"
+        << "        loot::clp::requirement_error reason;\n"
+        << "    };\n\n"
+        << "    /*!\n"
+        << "        The result of `parse`. Refers to the parsed command line and, for converted\n"
+        << "        values, to the arena passed to `parse`.\n"
+        << "    */\n"
+        << "    class result\n    {\n"
+        << "        friend class " << s.class_name << ";\n"
+        << "    public:\n"
+        << "        result();\n\n"
+        << "        bool good() const;\n"
+        << "        std::size_t error_count() const;\n"
+        << "        const error& error_at(std::size_t pos) const;\n"
+        << "        bool has(id o) const;\n"
+        << "        loot::clp::argv_span values(id o) const;\n\n";
+    for (std::size_t o = 0; o < num; o++) {
+        const spec_option& opt = s.options[o];
+        out << "        bool has_" << opt.identifier << "() const;\n";
+        if ("no_values" == opt.constraint) {
+            continue;
+        }
+        if ("text_value" == opt.conversion) {
+            out << "        loot::clp::argv_span " << opt.identifier << "() const;\n";
+        }
+        else {
+            out << "        loot::clp::value_span<" << value_type_of(opt) << "> "
+                << opt.identifier << "() const;\n";
+        }
+    }
+    out << "\n    private:\n"
+        << "        char* const* argv;\n"
+        << "        bool         found[" << num << "];\n"
+        << "        std::size_t  first[" << num << "];\n"
+        << "        std::size_t  count[" << num << "];\n"
+        << "        const void*  converted[" << num << "];\n"
+        << "        std::size_t  num_converted[" << num << "];\n"
+        << "        error        errors[" << 2 * num << "];\n"
+        << "        std::size_t  num_errors;\n"
+        << "    };\n\n"
+        << "    /*!\n"
+        << "        Finds an option by its short or long name, without the option switch.\n"
+        << "    */\n"
+        << "    static std::size_t find(const loot::clp::arg_view& name);\n\n"
+        << "    /*!\n"
+        << "        The options as `loot::clp::option`s, e.g. for a `loot::clp::parser` that\n"
+        << "        prints the help.\n"
+        << "    */\n"
+        << "    static std::vector<loot::clp::option> options();\n\n"
+        << "    /*!\n"
+        << "        Parses a command line. Converted values are placed into `storage`.\n"
+        << "    */\n"
+        << "    static result parse(int argc, char* argv[], loot::clp::arena& storage);\n\n"
+        << "private:\n"
+        << "    class table;\n"
+        << "    class target;\n"
+        << "};\n";
+
+    close_namespaces(out, s);
+    out << "\n#endif // " << guard << "\n";
+}
+
+void
+write_source(std::ostream&      out,
+             const spec&        s,
+             const std::string& spec_path,
+             const std::string& header_name)
+{
+    const std::string& cls = s.class_name;
+    std::size_t        num = s.options.size();
+
+    out << "// Generated by loot-clp-gen from " << spec_path << ", do not edit.\n\n"
+        << "#include \"" << header_name << "\"\n\n"
+        << "#include <clp/engine.h>\n\n"
+        << "#include <cstring>\n"
+        << "#include <stdexcept>\n"
+        << "#include <string>\n"
+        << "#include <utility>\n\n";
+    open_namespaces(out, s);
+
+    // Constant tables, nothing runs at startup.
+    out << "namespace {\n\n"
+        << "struct descriptor\n{\n"
+        << "    const char*                  short_name;\n"
+        << "    const char*                  long_name;\n"
+        << "    loot::clp::option_type       type;\n"
+        << "    loot::clp::value_constraint  constraint;\n"
+        << "    unsigned int                 num_expected_values;\n"
+        << "    loot::clp::value_type        conversion;\n"
+        << "    char                         delimiter;\n"
+        << "    const char*                  description;\n"
+        << "    const char* const*           choice_names;\n"
+        << "    const std::int64_t*          choice_values;\n"
+        << "    std::size_t                  num_choices;\n"
+        << "};\n\n";
+    for (std::size_t o = 0; o < num; o++) {
+        const spec_option& opt = s.options[o];
+        if (opt.choices.empty()) {
+            continue;
+        }
+        out << "const char* const " << opt.identifier << "_choice_names[] = {";
+        for (std::size_t c = 0; c < opt.choices.size(); c++) {
+            out << (c ? ", " : "") << literal(opt.choices[c].first);
+        }
+        out << "};\nconst std::int64_t " << opt.identifier << "_choice_values[] = {";
+        for (std::size_t c = 0; c < opt.choices.size(); c++) {
+            out << (c ? ", " : "") << "INT64_C(" << opt.choices[c].second << ")";
+        }
+        out << "};\n\n";
+    }
+
+    out << "const descriptor descriptors[] = {\n";
+    for (std::size_t o = 0; o < num; o++) {
+        const spec_option& opt = s.options[o];
+        out << "    {" << literal(opt.short_name) << ", " << literal(opt.long_name) << ",\n"
+            << "     loot::clp::option_type_e " << opt.type << ",\n"
+            << "     loot::clp::value_constraint_e " << opt.constraint << ", "
+            << opt.num_expected_values << ",\n"
+            << "     loot::clp::value_type_e " << opt.conversion << ", "
+            << char_literal(opt.delimiter) << ",\n"
+            << "     " << literal(opt.description) << ",\n";
+        if (opt.choices.empty()) {
+            out << "     0, 0, 0}";
+        }
+        else {
+            out << "     " << opt.identifier << "_choice_names, " << opt.identifier
+                << "_choice_values, " << opt.choices.size() << "}";
+        }
+        out << (o + 1 < num ? ",\n" : "\n");
+    }
+    out << "};\n\n"
+        << "bool\n"
+        << "choose(const descriptor& d, const loot::clp::arg_view& arg, std::int64_t& value,\n"
+        << "       loot::clp::requirement_error& reason)\n"
+        << "{\n"
+        << "    for (std::size_t c = 0; c < d.num_choices; c++) {\n"
+        << "        if (arg == d.choice_names[c]) {\n"
+        << "            value = d.choice_values[c];\n"
+        << "            return true;\n"
+        << "        }\n"
+        << "    }\n\n"
+        << "    reason = loot::clp::requirement_error_e value_not_a_choice_error;\n"
+        << "    return false;\n"
+        << "}\n\n"
+        << "} // namespace\n\n";
+
+    out << "const std::size_t " << cls << "::num_options;\n"
+        << "const std::size_t " << cls << "::npos;\n\n";
+
+    // The matcher: A switch over the length, then over distinguishing characters.
+    std::vector<std::vector<name_entry>> by_length;
+    for (std::size_t o = 0; o < num; o++) {
+        const std::string* names[] = {&s.options[o].short_name, &s.options[o].long_name};
+        for (std::size_t n = 0; n < 2; n++) {
+            if (names[n]->empty()) {
+                continue;
+            }
+            if (by_length.size() <= names[n]->size()) {
+                by_length.resize(names[n]->size() + 1);
+            }
+            by_length[names[n]->size()].push_back(name_entry(*names[n], o));
+        }
+    }
+
+    out << "std::size_t\n" << cls << "::find(const loot::clp::arg_view& name)\n{\n"
+        << "    const char* n = name.data();\n"
+        << "    switch (name.size()) {\n";
+    for (std::size_t length = 1; length < by_length.size(); length++) {
+        if (by_length[length].empty()) {
+            continue;
+        }
+        out << "    case " << length << ":\n";
+        emit_matcher(out, by_length[length], s, "        ");
+    }
+    out << "    }\n"
+        << "    return npos;\n"
+        << "}\n\n";
+
+    out << "std::vector<loot::clp::option>\n" << cls << "::options()\n{\n"
+        << "    std::vector<loot::clp::option> opts;\n"
+        << "    for (std::size_t o = 0; o < num_options; o++) {\n"
+        << "        const descriptor& d = descriptors[o];\n"
+        << "        loot::clp::option opt(d.short_name, d.long_name, d.type, d.constraint,\n"
+        << "                              d.num_expected_values, d.description);\n"
+        << "        opt.conversion = d.conversion;\n"
+        << "        opt.delimiter  = d.delimiter;\n"
+        << "        for (std::size_t c = 0; c < d.num_choices; c++) {\n"
+        << "            opt.choices.push_back(std::make_pair(std::string(d.choice_names[c]),\n"
+        << "                                                 d.choice_values[c]));\n"
+        << "        }\n"
+        << "        opts.push_back(opt);\n"
+        << "    }\n"
+        << "    return opts;\n"
+        << "}\n\n";
+
+    out << "class " << cls << "::table\n{\npublic:\n"
+        << "    std::size_t size() const { return num_options; }\n"
+        << "    std::size_t find(const loot::clp::arg_view& name) const { return "
+        << cls << "::find(name); }\n"
+        << "    bool has_names(std::size_t) const { return true; }\n"
+        << "    loot::clp::option_type type(std::size_t o) const { return descriptors[o].type; }\n\n"
+        << "    loot::clp::value_constraint constraint(std::size_t o) const\n    {\n"
+        << "        return descriptors[o].constraint;\n    }\n\n"
+        << "    std::size_t num_expected_values(std::size_t o) const\n    {\n"
+        << "        return descriptors[o].num_expected_values;\n    }\n"
+        << "};\n\n";
+
+    out << "class " << cls << "::target\n{\npublic:\n"
+        << "    target(result& r, loot::clp::arena& storage)\n"
+        << "        : r(r), storage(storage)\n    {}\n\n"
+        << "    bool found(std::size_t o) const { return r.found[o]; }\n"
+        << "    std::size_t count(std::size_t o) const { return r.count[o]; }\n\n"
+        << "    void occur(std::size_t o, std::size_t first, std::size_t count)\n    {\n"
+        << "        r.found[o] = true;\n"
+        << "        r.first[o] = first;\n"
+        << "        r.count[o] = count;\n    }\n\n"
+        << "    bool convert(std::size_t o, loot::clp::requirement_error& reason)\n    {\n"
+        << "        const descriptor& d = descriptors[o];\n"
+        << "        switch (d.conversion) {\n"
+        << "            case loot::clp::value_type_e integer_value:\n"
+        << "                return convert_all<std::int64_t>(o, reason,\n"
+        << "                                                 loot::clp::detail::convert_integer);\n\n"
+        << "            case loot::clp::value_type_e real_value:\n"
+        << "                return convert_all<double>(o, reason, loot::clp::detail::convert_real);\n\n"
+        << "            case loot::clp::value_type_e boolean_value:\n"
+        << "                return convert_all<bool>(o, reason, loot::clp::detail::convert_boolean);\n\n"
+        << "            case loot::clp::value_type_e enum_value:\n"
+        << "                return convert_all<std::int64_t>(o, reason,\n"
+        << "                        [&d](const loot::clp::arg_view& arg, std::int64_t& value,\n"
+        << "                             loot::clp::requirement_error& reason) {\n"
+        << "                    return choose(d, arg, value, reason);\n"
+        << "                });\n\n"
+        << "            case loot::clp::value_type_e integer_list_value:\n"
+        << "                return convert_lists(o, d.delimiter, reason);\n\n"
+        << "            default:\n"
+        << "                return true;\n"
+        << "        }\n    }\n\n"
+        << "    void fail(std::size_t o, loot::clp::requirement_error reason)\n    {\n"
+        << "        if (r.num_errors < 2 * num_options) {\n"
+        << "            r.errors[r.num_errors].ordinal = o;\n"
+        << "            r.errors[r.num_errors].reason  = reason;\n"
+        << "            r.num_errors++;\n"
+        << "        }\n    }\n\n"
+        << "private:\n"
+        << "    template<typename T, typename Convert>\n"
+        << "    bool convert_all(std::size_t o, loot::clp::requirement_error& reason,\n"
+        << "                     Convert convert)\n    {\n"
+        << "        if (0 == r.count[o]) {\n"
+        << "            return true;\n"
+        << "        }\n\n"
+        << "        T* values = storage.allocate_array<T>(r.count[o]);\n"
+        << "        for (std::size_t v = 0; v < r.count[o]; v++) {\n"
+        << "            if (!convert(loot::clp::arg_view(r.argv[r.first[o] + v]), values[v],\n"
+        << "                         reason)) {\n"
+        << "                return false;\n"
+        << "            }\n"
+        << "        }\n\n"
+        << "        r.converted[o]     = values;\n"
+        << "        r.num_converted[o] = r.count[o];\n"
+        << "        return true;\n    }\n\n"
+        << "    bool convert_lists(std::size_t o, char delimiter,\n"
+        << "                       loot::clp::requirement_error& reason)\n    {\n"
+        << "        std::size_t capacity = 0;\n"
+        << "        for (std::size_t v = 0; v < r.count[o]; v++) {\n"
+        << "            capacity += loot::clp::count_list_values(r.argv[r.first[o] + v],\n"
+        << "                                                     delimiter);\n"
+        << "        }\n"
+        << "        if (0 == capacity) {\n"
+        << "            return true;\n"
+        << "        }\n\n"
+        << "        std::int64_t* values = storage.allocate_array<std::int64_t>(capacity);\n"
+        << "        std::size_t   total  = 0;\n"
+        << "        for (std::size_t v = 0; v < r.count[o]; v++) {\n"
+        << "            std::size_t count;\n"
+        << "            if (!loot::clp::convert_integer_list(r.argv[r.first[o] + v], delimiter,\n"
+        << "                                                 values + total, capacity - total,\n"
+        << "                                                 count, reason)) {\n"
+        << "                return false;\n"
+        << "            }\n"
+        << "            total += count;\n"
+        << "        }\n\n"
+        << "        r.converted[o]     = values;\n"
+        << "        r.num_converted[o] = total;\n"
+        << "        return true;\n    }\n\n"
+        << "    result&            r;\n"
+        << "    loot::clp::arena& storage;\n"
+        << "};\n\n";
+
+    out << cls << "::result::result()\n"
+        << "    : argv(0), num_errors(0)\n{\n"
+        << "    for (std::size_t o = 0; o < num_options; o++) {\n"
+        << "        found[o]         = false;\n"
+        << "        first[o]         = 0;\n"
+        << "        count[o]         = 0;\n"
+        << "        converted[o]     = 0;\n"
+        << "        num_converted[o] = 0;\n"
+        << "    }\n}\n\n"
+        << "bool\n" << cls << "::result::good() const\n{\n    return 0 == num_errors;\n}\n\n"
+        << "std::size_t\n" << cls << "::result::error_count() const\n{\n"
+        << "    return num_errors;\n}\n\n"
+        << "const " << cls << "::error&\n" << cls << "::result::error_at(std::size_t pos) const\n{\n"
+        << "    if (pos >= num_errors) {\n"
+        << "        throw std::out_of_range(\"" << cls << "::result::error_at\");\n"
+        << "    }\n"
+        << "    return errors[pos];\n}\n\n"
+        << "bool\n" << cls << "::result::has(id o) const\n{\n    return found[o];\n}\n\n"
+        << "loot::clp::argv_span\n" << cls << "::result::values(id o) const\n{\n"
+        << "    return 0 == count[o] ? loot::clp::argv_span()\n"
+        << "                         : loot::clp::argv_span(argv + first[o], count[o]);\n"
+        << "}\n\n";
+
+    for (std::size_t o = 0; o < num; o++) {
+        const spec_option& opt = s.options[o];
+        out << "bool\n" << cls << "::result::has_" << opt.identifier << "() const\n{\n"
+            << "    return found[opt_" << opt.identifier << "];\n}\n\n";
+        if ("no_values" == opt.constraint) {
+            continue;
+        }
+        if ("text_value" == opt.conversion) {
+            out << "loot::clp::argv_span\n" << cls << "::result::" << opt.identifier
+                << "() const\n{\n"
+                << "    return values(opt_" << opt.identifier << ");\n}\n\n";
+        }
+        else {
+            std::string type = value_type_of(opt);
+            out << "loot::clp::value_span<" << type << ">\n" << cls << "::result::"
+                << opt.identifier << "() const\n{\n"
+                << "    return loot::clp::value_span<" << type << ">(\n"
+                << "            static_cast<const " << type << "*>(converted[opt_"
+                << opt.identifier << "]),\n"
+                << "            num_converted[opt_" << opt.identifier << "]);\n}\n\n";
+        }
+    }
+
+    out << cls << "::result\n" << cls
+        << "::parse(int argc, char* argv[], loot::clp::arena& storage)\n{\n"
+        << "    result r;\n"
+        << "    r.argv = argv;\n\n"
+        << "    table  t;\n"
+        << "    target s(r, storage);\n"
+        << "    loot::clp::detail::dispatch(loot::clp::argv_span(argv, argc), t, s);\n"
+        << "    loot::clp::detail::validate(t, s);\n"
+        << "    return r;\n"
+        << "}\n";
+
+    close_namespaces(out, s);
+}
+
+/*!
+    Writes `content` to `path` unless the file already has exactly that content, which
+    keeps its timestamp and spares rebuilding everything that depends on it.
+*/
+bool
+write_file(const std::string& path, const std::string& content)
+{
+    {
+        std::ifstream in(path.c_str(), std::ios::binary);
+        std::string   old((std::istreambuf_iterator<char>(in)),
+                          std::istreambuf_iterator<char>());
+        if (in.good() || in.eof()) {
+            if (old == content) {
+                return true;
+            }
+        }
+    }
+
+    std::ofstream out(path.c_str(), std::ios::binary);
+    out << content;
+    return static_cast<bool>(out);
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    parser args = {
+            option("s",
+                   "spec",
+                   option_type_e mandatory_option,
+                   value_constraint_e exact_num_values,
+                   1,
+                   "The specification of the options"),
+            option("",
+                   "header",
+                   option_type_e mandatory_option,
+                   value_constraint_e exact_num_values,
+                   1,
+                   "The header to generate"),
+            option("",
+                   "source",
+                   option_type_e mandatory_option,
+                   value_constraint_e exact_num_values,
+                   1,
+                   "The source file to generate"),
+            option("h",
+                   "help",
+                   option_type_e help_option,
+                   value_constraint_e no_values,
+                   0,
+                   "Print this help")};
+
+    result r = args.parse(argc, argv);
+    if (!r.good() || r.has_option("help")) {
+        std::cerr << "usage: loot-clp-gen --spec file --header file.h --source file.cpp"
+                  << std::endl;
+        args.print_help(std::cerr, false);
+        return r.good() ? 0 : 1;
+    }
+
+    std::string spec_path   = r.values_from_option("spec")[0];
+    std::string header_path = r.values_from_option("header")[0];
+    std::string source_path = r.values_from_option("source")[0];
+
+    std::ifstream in(spec_path.c_str());
+    if (!in) {
+        std::cerr << spec_path << ": can't read the specification" << std::endl;
+        return 1;
+    }
+
+    spec s;
+    try {
+        s = read_spec(in);
+    }
+    catch (const spec_error& e) {
+        std::cerr << spec_path << ":" << e.line << ": " << e.what() << std::endl;
+        return 1;
+    }
+
+    // The source includes the header by its name, both are expected side by side.
+    std::size_t slash       = header_path.find_last_of("/\\");
+    std::string header_name = std::string::npos == slash ? header_path
+                                                         : header_path.substr(slash + 1);
+
+    std::ostringstream header;
+    std::ostringstream source;
+    write_header(header, s, spec_path);
+    write_source(source, s, spec_path, header_name);
+    if (!write_file(header_path, header.str()) || !write_file(source_path, source.str())) {
+        std::cerr << "can't write " << header_path << " or " << source_path << std::endl;
+        return 1;
+    }
+
+    return 0;
+}